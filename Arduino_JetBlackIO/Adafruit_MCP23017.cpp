@@ -38,6 +38,19 @@ static inline uint8_t wirerecv(void) {
 #endif
 }
 
+// I2C transfers, counted for the performance statistics
+static inline uint8_t wireend(void) {
+  Adafruit_MCP23017::transactionCount++;
+  return Wire.endTransmission();
+}
+
+static inline uint8_t wirerequest(uint8_t addr, uint8_t count) {
+  Adafruit_MCP23017::transactionCount++;
+  return Wire.requestFrom(addr, count);
+}
+
+unsigned long Adafruit_MCP23017::transactionCount = 0;
+
 ////////////////////////////////////////////////////////////////////////////////
 
 void Adafruit_MCP23017::begin(uint8_t addr) {
@@ -53,12 +66,12 @@ void Adafruit_MCP23017::begin(uint8_t addr) {
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(MCP23017_IODIRA);
   wiresend(0xFF);  // all inputs on port A
-  Wire.endTransmission();
+  wireend();
 
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(MCP23017_IODIRB);
   wiresend(0xFF);  // all inputs on port B
-  Wire.endTransmission();
+  wireend();
 }
 
 
@@ -66,6 +79,10 @@ void Adafruit_MCP23017::begin(void) {
   begin(0);
 }
 
+void Adafruit_MCP23017::setAddress(uint8_t addr) {
+  i2caddr = addr & 0x7;
+}
+
 void Adafruit_MCP23017::pinMode(uint8_t p, uint8_t d) {
   uint8_t iodir;
   uint8_t iodiraddr;
@@ -84,9 +101,9 @@ void Adafruit_MCP23017::pinMode(uint8_t p, uint8_t d) {
   // read the current IODIR
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(iodiraddr);	
-  Wire.endTransmission();
+  wireend();
   
-  Wire.requestFrom(MCP23017_ADDRESS | i2caddr, 1);
+  wirerequest(MCP23017_ADDRESS | i2caddr, 1);
   iodir = wirerecv();
 
   // set the pin and direction
@@ -100,7 +117,7 @@ void Adafruit_MCP23017::pinMode(uint8_t p, uint8_t d) {
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(iodiraddr);
   wiresend(iodir);	
-  Wire.endTransmission();
+  wireend();
 }
 
 uint16_t Adafruit_MCP23017::readGPIOAB() {
@@ -110,9 +127,9 @@ uint16_t Adafruit_MCP23017::readGPIOAB() {
   // read the current GPIO output latches
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(MCP23017_GPIOA);	
-  Wire.endTransmission();
+  wireend();
   
-  Wire.requestFrom(MCP23017_ADDRESS | i2caddr, 2);
+  wirerequest(MCP23017_ADDRESS | i2caddr, 2);
   a = wirerecv();
   ba = wirerecv();
   ba <<= 8;
@@ -126,7 +143,28 @@ void Adafruit_MCP23017::writeGPIOAB(uint16_t ba) {
   wiresend(MCP23017_GPIOA);	
   wiresend(ba & 0xFF);
   wiresend(ba >> 8);
-  Wire.endTransmission();
+  wireend();
+}
+
+void Adafruit_MCP23017::pinModeOutputAB(uint16_t outputs) {
+  uint16_t iodir;
+
+  // read both IODIR registers (sequential addresses)
+  Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
+  wiresend(MCP23017_IODIRA);
+  wireend();
+
+  wirerequest(MCP23017_ADDRESS | i2caddr, 2);
+  iodir = wirerecv();
+  iodir |= (uint16_t) wirerecv() << 8;
+
+  iodir &= ~outputs;
+
+  Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
+  wiresend(MCP23017_IODIRA);
+  wiresend(iodir & 0xFF);
+  wiresend(iodir >> 8);
+  wireend();
 }
 
 void Adafruit_MCP23017::digitalWrite(uint8_t p, uint8_t d) {
@@ -149,9 +187,9 @@ void Adafruit_MCP23017::digitalWrite(uint8_t p, uint8_t d) {
   // read the current GPIO output latches
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(olataddr);	
-  Wire.endTransmission();
+  wireend();
   
-  Wire.requestFrom(MCP23017_ADDRESS | i2caddr, 1);
+  wirerequest(MCP23017_ADDRESS | i2caddr, 1);
    gpio = wirerecv();
 
   // set the pin and direction
@@ -165,7 +203,7 @@ void Adafruit_MCP23017::digitalWrite(uint8_t p, uint8_t d) {
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(gpioaddr);
   wiresend(gpio);	
-  Wire.endTransmission();
+  wireend();
 }
 
 void Adafruit_MCP23017::pullUp(uint8_t p, uint8_t d) {
@@ -187,9 +225,9 @@ void Adafruit_MCP23017::pullUp(uint8_t p, uint8_t d) {
   // read the current pullup resistor set
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(gppuaddr);	
-  Wire.endTransmission();
+  wireend();
   
-  Wire.requestFrom(MCP23017_ADDRESS | i2caddr, 1);
+  wirerequest(MCP23017_ADDRESS | i2caddr, 1);
   gppu = wirerecv();
 
   // set the pin and direction
@@ -203,7 +241,7 @@ void Adafruit_MCP23017::pullUp(uint8_t p, uint8_t d) {
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(gppuaddr);
   wiresend(gppu);	
-  Wire.endTransmission();
+  wireend();
 }
 
 uint8_t Adafruit_MCP23017::digitalRead(uint8_t p) {
@@ -223,8 +261,8 @@ uint8_t Adafruit_MCP23017::digitalRead(uint8_t p) {
   // read the current GPIO
   Wire.beginTransmission(MCP23017_ADDRESS | i2caddr);
   wiresend(gpioaddr);	
-  Wire.endTransmission();
+  wireend();
   
-  Wire.requestFrom(MCP23017_ADDRESS | i2caddr, 1);
+  wirerequest(MCP23017_ADDRESS | i2caddr, 1);
   return (wirerecv() >> p) & 0x1;
 }
@@ -19,6 +19,8 @@ class Adafruit_MCP23017 {
 public:
   void begin(uint8_t addr);
   void begin(void);
+  // use a chip that has already been set up (e.g., by the LCD shield), without resetting it
+  void setAddress(uint8_t addr);
 
   void pinMode(uint8_t p, uint8_t d);
   void digitalWrite(uint8_t p, uint8_t d);
@@ -27,6 +29,11 @@ public:
 
   void writeGPIOAB(uint16_t);
   uint16_t readGPIOAB();
+  // switches the pins of the mask to output, with one read and one write of both IODIR registers
+  void pinModeOutputAB(uint16_t);
+
+  // number of I2C transfers (writes and reads) of all expanders
+  static unsigned long transactionCount;
 
  private:
   uint8_t i2caddr;
@@ -48,6 +48,9 @@
 
 Adafruit_RGBLCDShield::Adafruit_RGBLCDShield() {
   _i2cAddr = 0;
+  _initialized = 0;
+  _initStep = LCD_INIT_STEPS;
+  _backlight = 0x7;
 
   _displayfunction = LCD_4BITMODE | LCD_1LINE | LCD_5x8DOTS;
   
@@ -71,6 +74,16 @@ Adafruit_RGBLCDShield::Adafruit_RGBLCDShield() {
 
 
 
+// select the MCP23017 of the shield (address 0-7, set by the address jumpers)
+// before begin() is called
+void Adafruit_RGBLCDShield::setAddress(uint8_t addr) {
+  _i2cAddr = addr & 0x7;
+}
+
+uint8_t Adafruit_RGBLCDShield::getAddress() {
+  return _i2cAddr;
+}
+
 void Adafruit_RGBLCDShield::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, uint8_t enable,
 			 uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
 			 uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7)
@@ -107,103 +120,147 @@ void Adafruit_RGBLCDShield::init(uint8_t fourbitmode, uint8_t rs, uint8_t rw, ui
 }
 
 void Adafruit_RGBLCDShield::begin(uint8_t cols, uint8_t lines, uint8_t dotsize) {
-  // check if i2c
-  if (_i2cAddr != 255) {
-    //_i2c.begin(_i2cAddr);
-    Wire.begin();
-    _i2c.begin();
-
-    _i2c.pinMode(8, OUTPUT);
-    _i2c.pinMode(6, OUTPUT);
-    _i2c.pinMode(7, OUTPUT);
-    setBacklight(0x7);
-
-    if (_rw_pin)
-      _i2c.pinMode(_rw_pin, OUTPUT);
-
-    _i2c.pinMode(_rs_pin, OUTPUT);
-    _i2c.pinMode(_enable_pin, OUTPUT);
-    for (uint8_t i=0; i<4; i++) 
-      _i2c.pinMode(_data_pins[i], OUTPUT);
-
-    for (uint8_t i=0; i<5; i++) {
-      _i2c.pinMode(_button_pins[i], INPUT);
-      _i2c.pullUp(_button_pins[i], 1);
-    }
+  startInit(cols, lines, dotsize);
+  for (uint16_t wait = initStep(); wait != LCD_INIT_DONE; wait = initStep()) {
+    delay(wait / 1000);
+    delayMicroseconds(wait % 1000);
   }
+}
 
+// prepares the initialisation, the LCD is only accessed by initStep()
+void Adafruit_RGBLCDShield::startInit(uint8_t cols, uint8_t lines, uint8_t dotsize) {
   if (lines > 1) {
     _displayfunction |= LCD_2LINE;
+  } else {
+    _displayfunction &= ~LCD_2LINE;
   }
   _numlines = lines;
+  _numcols = cols;
   _currline = 0;
 
   // for some 1 line displays you can select a 10 pixel high font
   if ((dotsize != 0) && (lines == 1)) {
     _displayfunction |= LCD_5x10DOTS;
   }
+  _initStep = 0;
+}
 
-  // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
-  // according to datasheet, we need at least 40ms after power rises above 2.7V
-  // before sending commands. Arduino can turn on way befer 4.5V so we'll wait 50
-  delayMicroseconds(50000); 
-  // Now we pull both RS and R/W low to begin commands
-  _digitalWrite(_rs_pin, LOW);
-  _digitalWrite(_enable_pin, LOW);
-  if (_rw_pin != 255) { 
-    _digitalWrite(_rw_pin, LOW);
-  }
-  
-  //put the LCD into 4 bit or 8 bit mode
-  if (! (_displayfunction & LCD_8BITMODE)) {
-    // this is according to the hitachi HD44780 datasheet
-    // figure 24, pg 46
-
-    // we start in 8bit mode, try to set 4 bit mode
-    write4bits(0x03);
-    delayMicroseconds(4500); // wait min 4.1ms
-
-    // second try
-    write4bits(0x03);
-    delayMicroseconds(4500); // wait min 4.1ms
-    
-    // third go!
-    write4bits(0x03); 
-    delayMicroseconds(150);
-
-    // finally, set to 8-bit interface
-    write4bits(0x02); 
-  } else {
-    // this is according to the hitachi HD44780 datasheet
-    // page 45 figure 23
-
-    // Send function set command sequence
-    command(LCD_FUNCTIONSET | _displayfunction);
-    delayMicroseconds(4500);  // wait more than 4.1ms
-
-    // second try
-    command(LCD_FUNCTIONSET | _displayfunction);
-    delayMicroseconds(150);
-
-    // third go
-    command(LCD_FUNCTIONSET | _displayfunction);
+// executes the next step of the initialisation
+// returns the time in us to wait before the next step or LCD_INIT_DONE
+uint16_t Adafruit_RGBLCDShield::initStep() {
+  switch (_initStep++) {
+    case 0:
+      // check if i2c
+      if (_i2cAddr != 255) {
+        Wire.begin();
+        _i2c.begin(_i2cAddr);
+
+        _i2c.pinMode(8, OUTPUT);
+        _i2c.pinMode(6, OUTPUT);
+        _i2c.pinMode(7, OUTPUT);
+        _initialized = 1; // backlight can be written from now on
+        setBacklight(_backlight);
+      }
+      return 1;
+
+    case 1:
+      // the pin setup takes many I2C transfers: split it up
+      if (_i2cAddr != 255) {
+        if (_rw_pin)
+          _i2c.pinMode(_rw_pin, OUTPUT);
+
+        _i2c.pinMode(_rs_pin, OUTPUT);
+        _i2c.pinMode(_enable_pin, OUTPUT);
+        for (uint8_t i=0; i<4; i++) 
+          _i2c.pinMode(_data_pins[i], OUTPUT);
+      }
+      return 1;
+
+    case 2:
+      if (_i2cAddr != 255) {
+        for (uint8_t i=0; i<5; i++) {
+          _i2c.pinMode(_button_pins[i], INPUT);
+          _i2c.pullUp(_button_pins[i], 1);
+        }
+      }
+      // SEE PAGE 45/46 FOR INITIALIZATION SPECIFICATION!
+      // according to datasheet, we need at least 40ms after power rises above 2.7V
+      // before sending commands. Arduino can turn on way befer 4.5V so we'll wait 50
+      return 50000;
+
+    case 3:
+      // Now we pull both RS and R/W low to begin commands
+      _digitalWrite(_rs_pin, LOW);
+      _digitalWrite(_enable_pin, LOW);
+      if (_rw_pin != 255) { 
+        _digitalWrite(_rw_pin, LOW);
+      }
+      //put the LCD into 4 bit or 8 bit mode
+      if (! (_displayfunction & LCD_8BITMODE)) {
+        // this is according to the hitachi HD44780 datasheet
+        // figure 24, pg 46
+
+        // we start in 8bit mode, try to set 4 bit mode
+        write4bits(0x03);
+      } else {
+        // this is according to the hitachi HD44780 datasheet
+        // page 45 figure 23
+
+        // Send function set command sequence
+        command(LCD_FUNCTIONSET | _displayfunction);
+      }
+      return 4500; // wait min 4.1ms
+
+    case 4:
+      // second try
+      if (! (_displayfunction & LCD_8BITMODE)) {
+        write4bits(0x03);
+        return 4500; // wait min 4.1ms
+      }
+      command(LCD_FUNCTIONSET | _displayfunction);
+      return 150;
+
+    case 5:
+      // third go!
+      if (! (_displayfunction & LCD_8BITMODE)) {
+        write4bits(0x03); 
+        return 150;
+      }
+      command(LCD_FUNCTIONSET | _displayfunction);
+      return 1;
+
+    case 6:
+      // finally, set to 8-bit interface
+      if (! (_displayfunction & LCD_8BITMODE)) {
+        write4bits(0x02); 
+      }
+
+      // finally, set # lines, font size, etc.
+      command(LCD_FUNCTIONSET | _displayfunction);  
+
+      // turn the display on with no cursor or blinking default
+      _displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;  
+      display();
+
+      // clear it off (takes a long time)
+      command(LCD_CLEARDISPLAY);
+      return 2000;
+
+    case 7:
+      // Initialize to default text direction (for romance languages)
+      _displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
+      // set the entry mode
+      command(LCD_ENTRYMODESET | _displaymode);
+      return LCD_INIT_DONE;
+
+    default:
+      _initStep = LCD_INIT_STEPS;
+      return LCD_INIT_DONE;
   }
+}
 
-  // finally, set # lines, font size, etc.
-  command(LCD_FUNCTIONSET | _displayfunction);  
-
-  // turn the display on with no cursor or blinking default
-  _displaycontrol = LCD_DISPLAYON | LCD_CURSOROFF | LCD_BLINKOFF;  
-  display();
-
-  // clear it off
-  clear();
-
-  // Initialize to default text direction (for romance languages)
-  _displaymode = LCD_ENTRYLEFT | LCD_ENTRYSHIFTDECREMENT;
-  // set the entry mode
-  command(LCD_ENTRYMODESET | _displaymode);
-
+bool Adafruit_RGBLCDShield::isReady() {
+  return _initStep >= LCD_INIT_STEPS;
 }
 
 /********** high level commands, for the user! */
@@ -221,12 +278,16 @@ void Adafruit_RGBLCDShield::home()
 
 void Adafruit_RGBLCDShield::setCursor(uint8_t col, uint8_t row)
 {
-  int row_offsets[] = { 0x00, 0x40, 0x14, 0x54 };
-  if ( row > _numlines ) {
+  if ( row >= _numlines ) {
     row = _numlines-1;    // we count rows starting w/0
   }
+  // odd rows start at 0x40, rows 2 and 3 of 4 line displays continue rows 0 and 1 in the DDRAM
+  // (e.g. 0x14/0x54 for 20 columns, 0x10/0x50 for 16 columns).
+  // Calculated instead of building a table on the stack for every call
+  uint8_t offset = (row & 1) ? 0x40 : 0x00;
+  if ( row >= 2 ) offset += _numcols;
   
-  command(LCD_SETDDRAMADDR | (col + row_offsets[row]));
+  command(LCD_SETDDRAMADDR | (col + offset));
 }
 
 // Turn the display on/off (quickly)
@@ -302,6 +363,13 @@ void Adafruit_RGBLCDShield::createChar(uint8_t location, uint8_t charmap[]) {
   command(LCD_SETDDRAMADDR);  // unfortunately resets the location to 0,0
 }
 
+// moves the address counter to a row of a custom character,
+// so that the character can be defined by writing one row at a time
+void Adafruit_RGBLCDShield::setCharRow(uint8_t location, uint8_t row) {
+  location &= 0x7; // we only have 8 locations 0-7
+  command(LCD_SETCGRAMADDR | (location << 3) | (row & 0x7));
+}
+
 /*********** mid level commands, for sending data/cmds */
 
 inline void Adafruit_RGBLCDShield::command(uint8_t value) {
@@ -334,6 +402,9 @@ void  Adafruit_RGBLCDShield::_digitalWrite(uint8_t p, uint8_t d) {
 
 // Allows to set the backlight, if the LCD backpack is used
 void Adafruit_RGBLCDShield::setBacklight(uint8_t status) {
+  // remember the colour until the I/O expander has been set up
+  _backlight = status;
+  if (!_initialized) return;
   // check if i2c or SPI
   _i2c.digitalWrite(8, ~(status >> 2) & 0x1);
   _i2c.digitalWrite(7, ~(status >> 1) & 0x1);
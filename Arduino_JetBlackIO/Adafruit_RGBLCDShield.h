@@ -58,6 +58,11 @@
 #define LCD_5x10DOTS 0x04
 #define LCD_5x8DOTS 0x00
 
+// result of initStep() when the initialisation is complete
+#define LCD_INIT_DONE 0
+// number of steps of the initialisation
+#define LCD_INIT_STEPS 8
+
 #define BUTTON_UP 0x08
 #define BUTTON_DOWN 0x04
 #define BUTTON_LEFT 0x10
@@ -73,8 +78,16 @@ public:
 	    uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
 	    uint8_t d4, uint8_t d5, uint8_t d6, uint8_t d7);
     
+  void setAddress(uint8_t addr);
+  uint8_t getAddress();
   void begin(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS);
 
+  // initialisation without blocking: call initStep() after the returned time
+  // until it returns LCD_INIT_DONE
+  void startInit(uint8_t cols, uint8_t rows, uint8_t charsize = LCD_5x8DOTS);
+  uint16_t initStep();
+  bool isReady();
+
   void clear();
   void home();
 
@@ -95,6 +108,7 @@ public:
   void setBacklight(uint8_t status); 
 
   void createChar(uint8_t, uint8_t[]);
+  void setCharRow(uint8_t location, uint8_t row);
   void setCursor(uint8_t, uint8_t); 
 #if ARDUINO >= 100
   virtual size_t write(uint8_t);
@@ -122,11 +136,13 @@ private:
   uint8_t _displaymode;
 
   uint8_t _initialized;
+  uint8_t _initStep;  // next step of the initialisation
+  uint8_t _backlight; // backlight colour, written when the I/O expander has been set up
 
-  uint8_t _numlines,_currline;
+  uint8_t _numlines,_currline,_numcols;
 
   uint8_t _i2cAddr;
   Adafruit_MCP23017 _i2c;
 };
 
-#endif
+#endif
@@ -3,13 +3,38 @@
  *
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.14: Created
+ * @version 1.1 - 2026.10.18: State moved to the analog LED table
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #include "AnalogLED.h"
 
-AnalogLED::AnalogLED(byte pinNo) : LED()
+// state of all analog LEDs
+DEFINE_LED_TABLE(analogTable, ANALOG_LED_CAPACITY);
+static byte analogPinNo[ANALOG_LED_CAPACITY];
+
+
+/**
+ * Sets the actual output pin state of an analog LED.
+ *
+ * @param idx the index of the LED in the table
+ */
+static inline void writeAnalogOutput(byte idx)
+{
+  if ( analogTable.state[idx] ) 
+  {
+    analogWrite(analogPinNo[idx], (int) analogTable.brightness[idx] * 255 / 99);
+  }
+  else
+  {
+    analogWrite(analogPinNo[idx], 0);
+  } 
+}
+
+
+AnalogLED::AnalogLED(byte pinNo) : LED(analogTable)
 {
-  this->pinNo = pinNo;
+  analogPinNo[idx] = pinNo;
 
   // prepare pin to output signal
   pinMode(pinNo, OUTPUT); 
@@ -18,14 +43,25 @@ AnalogLED::AnalogLED(byte pinNo) : LED()
 }
 
 
-void AnalogLED::updateLedState()
+void AnalogLED::updateAll(unsigned long time)
 {
-  if ( state ) 
+  for ( byte i = 0 ; i < analogTable.count ; i++ )
   {
-    analogWrite(pinNo, (int) brightness * 255 / 99);
+    if ( analogTable.updateBlink(i, time) )
+    {
+      writeAnalogOutput(i);
+    }
   }
-  else
-  {
-    analogWrite(pinNo, 0);
-  } 
-}
+}
+
+
+char AnalogLED::getType()
+{
+  return LED_TYPE_ANALOG;
+}
+
+
+void AnalogLED::updateLedState()
+{
+  writeAnalogOutput(idx);
+}
@@ -3,6 +3,8 @@
  * 
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.22: Created
+ * @version 1.1 - 2026.10.18: State moved to the analog LED table
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #ifndef ANALOG_LED_H_INCLUDED
@@ -10,6 +12,9 @@
 
 #include "LED.h"
 
+// maximum number of analog LEDs
+#define ANALOG_LED_CAPACITY 6
+
 class AnalogLED : public LED
 {
   public:
@@ -21,16 +26,24 @@ class AnalogLED : public LED
      */
     AnalogLED(byte pinNo);
 
-  private:
-  
-    virtual void updateLedState();
+    /**
+     * Updates all analog LEDs.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
+
+  // overridden methods
+
+    virtual char getType();
 
   private:
   
-    byte pinNo;
+    virtual void updateLedState();
 
 };
 
 
 #endif // ANALOG_LED_H_INCLUDED
-
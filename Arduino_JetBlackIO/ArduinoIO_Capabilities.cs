@@ -0,0 +1,346 @@
+using System;
+using System.Collections.Generic;
+
+/// <summary>
+/// Description of an Arduino I/O module: version, supported commands, serial speed,
+/// LCD geometries and the inputs and outputs.
+/// The module returns the description as the answer to the I command, sections separated by semicolons:
+/// <code>
+/// JetBlack IO-Box v1.26;P1;CBEIblLMCTPGAFVNUWKDXRSHQY;B1000000;D16x2;Laaamaaamab---a;K3;F8;A2;U6
+/// </code>
+/// The first section is the answer to the E command, each further section starts with a key character.
+/// Sections with unknown keys are ignored, missing sections keep the values of modules without the I command.
+/// </summary>
+///
+public class ArduinoIO_Capabilities
+{
+	// LED types
+	public const char LED_DIGITAL     = 'd'; // on/off only
+	public const char LED_ANALOG      = 'a'; // dimmable
+	public const char LED_MULTICOLOUR = 'm'; // composed of three dimmable LEDs
+	public const char LED_BACKLIGHT   = 'b'; // LCD backlight, colours are dithered (before v1.24: colours and brightness are on/off only)
+	public const char LED_NONE        = '-'; // no LED with this number
+
+
+	/// <summary>
+	/// Creates the description of a module that only answers the E command.
+	/// The module is assumed to have the inputs and outputs of the first I/O box with one 16x2 LCD,
+	/// without number fields, scrolling text and screen pages.
+	/// </summary>
+	/// <returns>
+	/// the description of the module
+	/// </returns>
+	/// <param name='version'>
+	/// the answer of the E command
+	/// </param>
+	///
+	public static ArduinoIO_Capabilities FromVersion(String version)
+	{
+		ArduinoIO_Capabilities caps = new ArduinoIO_Capabilities();
+		caps.version  = version;
+		caps.protocol = 0;
+		caps.commands = null; // unknown: any command is tried
+		caps.maxSpeed = int.MaxValue;
+		caps.displays = new List<int[]>();
+		caps.displays.Add(new int[] { DEFAULT_LCD_COLUMNS, DEFAULT_LCD_ROWS });
+		caps.ledTypes = DEFAULT_LED_TYPES;
+		caps.buttons  = DEFAULT_BUTTONS;
+		caps.fields   = DEFAULT_FIELDS;
+		caps.marquees = DEFAULT_MARQUEES;
+		caps.pages    = DEFAULT_PAGES;
+		return caps;
+	}
+
+
+	/// <summary>
+	/// Creates the description of a module from the answer to the I or E command.
+	/// </summary>
+	/// <returns>
+	/// the description of the module
+	/// </returns>
+	/// <param name='answer'>
+	/// the answer of the module
+	/// </param>
+	///
+	public static ArduinoIO_Capabilities Parse(String answer)
+	{
+		String[] sections = answer.Split(';');
+		ArduinoIO_Capabilities caps = FromVersion(sections[0]);
+		for ( int i = 1 ; i < sections.Length ; i++ )
+		{
+			String section = sections[i];
+			if ( section.Length == 0 ) continue;
+			String value = section.Substring(1);
+			switch ( section[0] )
+			{
+				case 'P': caps.protocol = ParseNumber(value, caps.protocol); break;
+				case 'C': caps.commands = value; break;
+				case 'B': caps.maxSpeed = ParseNumber(value, caps.maxSpeed); break;
+				case 'D': caps.displays = ParseDisplays(value); break;
+				case 'L': caps.ledTypes = value; break;
+				case 'K': caps.buttons  = ParseNumber(value, caps.buttons); break;
+				case 'F': caps.fields   = ParseNumber(value, caps.fields); break;
+				case 'A': caps.marquees = ParseNumber(value, caps.marquees); break;
+				case 'U': caps.pages    = ParseNumber(value, caps.pages); break;
+				default : break; // newer module: ignore
+			}
+		}
+		return caps;
+	}
+
+
+	/// <summary>
+	/// Gets the name and version of the module.
+	/// </summary>
+	/// <returns>
+	/// the answer of the E command
+	/// </returns>
+	///
+	public String GetVersion()
+	{
+		return version;
+	}
+
+
+	/// <summary>
+	/// Gets the version of the command syntax.
+	/// </summary>
+	/// <returns>
+	/// the protocol version (0: module without the I command)
+	/// </returns>
+	///
+	public int GetProtocolVersion()
+	{
+		return protocol;
+	}
+
+
+	/// <summary>
+	/// Checks if the module supports a command.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the command is supported or the module did not list its commands,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='command'>
+	/// the command character
+	/// </param>
+	///
+	public bool SupportsCommand(char command)
+	{
+		return (commands == null) || (commands.IndexOf(command) >= 0);
+	}
+
+
+	/// <summary>
+	/// Gets the fastest serial speed of the module.
+	/// </summary>
+	/// <returns>
+	/// the speed in baud (int.MaxValue: unknown)
+	/// </returns>
+	///
+	public int GetMaxSpeed()
+	{
+		return maxSpeed;
+	}
+
+
+	/// <summary>
+	/// Gets the number of connected LCDs.
+	/// </summary>
+	/// <returns>
+	/// the number of LCDs
+	/// </returns>
+	///
+	public int GetDisplayCount()
+	{
+		return displays.Count;
+	}
+
+
+	/// <summary>
+	/// Gets the number of columns of a LCD.
+	/// </summary>
+	/// <returns>
+	/// the number of columns (0: no such LCD)
+	/// </returns>
+	/// <param name='display'>
+	/// the number of the LCD
+	/// </param>
+	///
+	public int GetDisplayColumns(int display)
+	{
+		return ((display >= 0) && (display < displays.Count)) ? displays[display][0] : 0;
+	}
+
+
+	/// <summary>
+	/// Gets the number of rows of a LCD.
+	/// </summary>
+	/// <returns>
+	/// the number of rows (0: no such LCD)
+	/// </returns>
+	/// <param name='display'>
+	/// the number of the LCD
+	/// </param>
+	///
+	public int GetDisplayRows(int display)
+	{
+		return ((display >= 0) && (display < displays.Count)) ? displays[display][1] : 0;
+	}
+
+
+	/// <summary>
+	/// Gets the number of LEDs, including numbers without a LED.
+	/// </summary>
+	/// <returns>
+	/// the number of LEDs
+	/// </returns>
+	///
+	public int GetLedCount()
+	{
+		return ledTypes.Length;
+	}
+
+
+	/// <summary>
+	/// Gets the type of a LED.
+	/// </summary>
+	/// <returns>
+	/// the type of the LED (see LED_...)
+	/// </returns>
+	/// <param name='led'>
+	/// the number of the LED
+	/// </param>
+	///
+	public char GetLedType(int led)
+	{
+		return ((led >= 0) && (led < ledTypes.Length)) ? ledTypes[led] : LED_NONE;
+	}
+
+
+	/// <summary>
+	/// Looks for a LED of a specific type.
+	/// </summary>
+	/// <returns>
+	/// the number of the LED or -1 if the module has no such LED
+	/// </returns>
+	/// <param name='type'>
+	/// the type of the LED (see LED_...)
+	/// </param>
+	/// <param name='index'>
+	/// 0 for the first LED of that type, 1 for the second, ...
+	/// </param>
+	///
+	public int FindLed(char type, int index)
+	{
+		for ( int led = 0 ; led < ledTypes.Length ; led++ )
+		{
+			if ( ledTypes[led] == type )
+			{
+				if ( index == 0 ) return led;
+				index--;
+			}
+		}
+		return -1;
+	}
+
+
+	/// <summary>
+	/// Gets the number of buttons.
+	/// </summary>
+	/// <returns>
+	/// the number of buttons
+	/// </returns>
+	///
+	public int GetButtonCount()
+	{
+		return buttons;
+	}
+
+
+	/// <summary>
+	/// Gets the number of number fields (see the F and V commands).
+	/// </summary>
+	/// <returns>
+	/// the number of fields
+	/// </returns>
+	///
+	public int GetFieldCount()
+	{
+		return fields;
+	}
+
+
+	/// <summary>
+	/// Gets the number of scrolling text regions (see the A command).
+	/// </summary>
+	/// <returns>
+	/// the number of regions
+	/// </returns>
+	///
+	public int GetMarqueeCount()
+	{
+		return marquees;
+	}
+
+
+	/// <summary>
+	/// Gets the number of screen pages (see the U, W, K and D commands).
+	/// </summary>
+	/// <returns>
+	/// the number of pages
+	/// </returns>
+	///
+	public int GetPageCount()
+	{
+		return pages;
+	}
+
+
+	private ArduinoIO_Capabilities()
+	{
+	}
+
+
+	private static int ParseNumber(String value, int defaultValue)
+	{
+		int number;
+		return int.TryParse(value, out number) ? number : defaultValue;
+	}
+
+
+	private static List<int[]> ParseDisplays(String value)
+	{
+		List<int[]> list = new List<int[]>();
+		if ( value.Length == 0 ) return list; // no LCD connected
+		foreach ( String geometry in value.Split(',') )
+		{
+			String[] size = geometry.Split('x');
+			if ( size.Length != 2 ) continue;
+			list.Add(new int[] { ParseNumber(size[0], 0), ParseNumber(size[1], 0) });
+		}
+		return list;
+	}
+
+
+	// description of the first I/O box
+	private const int    DEFAULT_LCD_ROWS    = 2;
+	private const int    DEFAULT_LCD_COLUMNS = 16;
+	private const String DEFAULT_LED_TYPES   = "aaamaaamdb";
+	private const int    DEFAULT_BUTTONS     = 3;
+	private const int    DEFAULT_FIELDS      = 0;
+	private const int    DEFAULT_MARQUEES    = 0;
+	private const int    DEFAULT_PAGES       = 0;
+
+	private String      version;
+	private int         protocol;
+	private String      commands; // null: unknown
+	private int         maxSpeed;
+	private List<int[]> displays; // columns and rows of each LCD
+	private String      ledTypes; // one character per LED
+	private int         buttons;
+	private int         fields;
+	private int         marquees;
+	private int         pages;
+}
@@ -0,0 +1,184 @@
+using System;
+using System.Diagnostics;
+
+/// <summary>
+/// Estimate of the clock of an Arduino I/O module (micros()) in relation to the Stopwatch of the host.
+/// The host sends the Y command several times in a row (a burst) and notes the send and receive time,
+/// the module answers with its micros() value. The sample with the shortest round trip
+/// has the least delay in the serial drivers and gives the offset between the clocks.
+/// The crystal of the module is not as exact as the host clock (up to 0.1%),
+/// so the rate of the module clock is estimated from bursts that are at least 30 seconds apart.
+/// The module clock wraps around after about 71 minutes, times of the module are passed as uint.
+/// The samples are added by the I/O thread, the conversion can be used by any thread.
+/// </summary>
+///
+public class ArduinoIO_Clock
+{
+	/// <summary>
+	/// Creates an unsynchronised clock.
+	/// </summary>
+	///
+	public ArduinoIO_Clock()
+	{
+		Reset();
+	}
+
+
+	/// <summary>
+	/// Forgets all samples, e.g., after the module has been reset.
+	/// </summary>
+	///
+	public void Reset()
+	{
+		lock ( estimateLock )
+		{
+			synchronised  = false;
+			bestRoundTrip = long.MaxValue;
+			rate          = 1.0;
+			uncertainty   = 0;
+		}
+	}
+
+
+	/// <summary>
+	/// Adds a sample to the current burst.
+	/// </summary>
+	/// <param name='sendTicks'>
+	/// the Stopwatch timestamp before the command was sent
+	/// </param>
+	/// <param name='receiveTicks'>
+	/// the Stopwatch timestamp after the answer was received
+	/// </param>
+	/// <param name='deviceMicros'>
+	/// the answer of the module
+	/// </param>
+	/// <param name='transferTicks'>
+	/// the difference between the transfer time of the answer and the transfer time of the command
+	/// in Stopwatch ticks (the module reads its clock after the command and before the answer)
+	/// </param>
+	///
+	public void AddSample(long sendTicks, long receiveTicks, uint deviceMicros, long transferTicks)
+	{
+		long roundTrip = receiveTicks - sendTicks;
+		if ( roundTrip < bestRoundTrip )
+		{
+			bestRoundTrip = roundTrip;
+			bestTicks     = sendTicks + (roundTrip - transferTicks) / 2;
+			bestMicros    = deviceMicros;
+		}
+	}
+
+
+	/// <summary>
+	/// Finishes the current burst and updates the estimate with its best sample.
+	/// </summary>
+	///
+	public void EndBurst()
+	{
+		if ( bestRoundTrip == long.MaxValue ) return; // no answers
+
+		lock ( estimateLock )
+		{
+			if ( !synchronised )
+			{
+				firstTicks  = bestTicks;
+				firstMicros = bestMicros;
+				lastMicros  = bestMicros;
+				synchronised = true;
+			}
+			else
+			{
+				// continue the module time across its wraparound (bursts are less than 71 minutes apart)
+				lastMicros += (uint) (bestMicros - (uint) lastMicros);
+				double span = TicksToMicros(bestTicks - firstTicks);
+				if ( span >= MIN_RATE_SPAN ) rate = (lastMicros - firstMicros) / span;
+			}
+			lastTicks   = bestTicks;
+			uncertainty = TicksToMicros(bestRoundTrip) / 2;
+		}
+		bestRoundTrip = long.MaxValue;
+	}
+
+
+	/// <summary>
+	/// Checks if at least one burst has been answered.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the module time can be calculated,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool IsSynchronised()
+	{
+		return synchronised;
+	}
+
+
+	/// <summary>
+	/// Converts a time of the host into the time of the module.
+	/// </summary>
+	/// <returns>
+	/// the micros() value of the module at that time
+	/// </returns>
+	/// <param name='ticks'>
+	/// a Stopwatch timestamp, e.g., Stopwatch.GetTimestamp() plus a delay
+	/// </param>
+	///
+	public uint ToDeviceTime(long ticks)
+	{
+		lock ( estimateLock )
+		{
+			return (uint) (lastMicros + (long) Math.Round(TicksToMicros(ticks - lastTicks) * rate));
+		}
+	}
+
+
+	/// <summary>
+	/// Gets the uncertainty of the last synchronisation.
+	/// </summary>
+	/// <returns>
+	/// half of the shortest round trip of the last burst in microseconds
+	/// </returns>
+	///
+	public double GetUncertainty()
+	{
+		return uncertainty;
+	}
+
+
+	/// <summary>
+	/// Gets the deviation of the module clock from the host clock.
+	/// </summary>
+	/// <returns>
+	/// the deviation in ppm (positive: the module clock is fast)
+	/// </returns>
+	///
+	public double GetDrift()
+	{
+		return (rate - 1.0) * 1e6;
+	}
+
+
+	private static double TicksToMicros(long ticks)
+	{
+		return ticks * 1e6 / Stopwatch.Frequency;
+	}
+
+
+	private const double MIN_RATE_SPAN = 30e6; // time in us between bursts before the rate is estimated
+
+	// best sample of the current burst (I/O thread only)
+	private long bestRoundTrip;
+	private long bestTicks;
+	private uint bestMicros;
+
+	// estimate
+	private readonly object estimateLock = new object();
+	private volatile bool synchronised;
+	private long   firstTicks;  // first synchronisation, for the rate
+	private long   firstMicros;
+	private long   lastTicks;   // latest synchronisation, for the offset
+	private long   lastMicros;  // module time without wraparound
+	private double rate;        // module microseconds per host microsecond
+	private double uncertainty; // in us
+}
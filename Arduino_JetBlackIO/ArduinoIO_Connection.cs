@@ -0,0 +1,1055 @@
+
+using UnityEngine;
+using System;
+using System.IO;
+using System.IO.Ports;
+using System.Threading;
+using System.Collections.Generic;
+
+/// <summary>
+/// Serial connection to the Arduino I/O module.
+/// All serial I/O is done by a background thread.
+/// Commands are handed to that thread through a lock-free queue,
+/// the answers are handed back through a second queue
+/// and are processed on the game thread by calling ProcessAnswers().
+/// LCD text and LED states are not queued as commands but kept in a mirror of the module
+/// (see ArduinoIO_DeviceState), so the I/O thread sends only the latest changes.
+/// When the connection is opened, the module describes itself (see ArduinoIO_Capabilities),
+/// the mirror and the serial speed are configured accordingly.
+/// The clock of the module is synchronised regularly (see ArduinoIO_Clock),
+/// so commands can be sent ahead of time with the time when the module shall execute them.
+/// None of the methods wait for serial I/O, except Close().
+/// </summary>
+///
+public class ArduinoIO_Connection
+{
+	/// <summary>
+	/// Delegate for receiving the answer to a request on the game thread.
+	/// </summary>
+	/// <param name='command'>
+	/// the command that was sent
+	/// </param>
+	/// <param name='answer'>
+	/// the answer of the module or "" if a timeout occured
+	/// </param>
+	///
+	public delegate void AnswerHandler(String command, String answer);
+
+
+	/// <summary>
+	/// Creates a connection object. The connection is not opened yet.
+	/// </summary>
+	/// <param name='portName'>
+	/// the name of the serial port
+	/// </param>
+	/// <param name='speed'>
+	/// the bitrate of the serial port
+	/// </param>
+	/// <param name='fastSpeed'>
+	/// the bitrate to negotiate with the module after connecting (0: stay at <c>speed</c>)
+	/// </param>
+	///
+	public ArduinoIO_Connection(String portName, int speed, int fastSpeed)
+	{
+		this.portName  = portName;
+		this.speed     = speed;
+		this.fastSpeed = fastSpeed;
+
+		commandQueue  = new LockFreeQueue<Request>(QUEUE_SIZE);
+		answerQueue   = new LockFreeQueue<Request>(QUEUE_SIZE);
+		commandSignal = new AutoResetEvent(false);
+		capabilities  = ArduinoIO_Capabilities.FromVersion("");
+		deviceState   = CreateDeviceState(capabilities, false);
+		stateCommands = new List<String>();
+		clock         = new ArduinoIO_Clock();
+
+		state         = State.CLOSED;
+		version       = "";
+	}
+
+
+	/// <summary>
+	/// Starts the I/O thread which opens the serial port and checks for the module.
+	/// </summary>
+	///
+	public void Open()
+	{
+		if ( state != State.CLOSED ) return;
+
+		state         = State.CONNECTING;
+		stopRequested = false;
+		ioThread      = new Thread(new ThreadStart(RunIO));
+		ioThread.Name         = "ArduinoIO " + portName;
+		ioThread.IsBackground = true;
+		ioThread.Start();
+	}
+
+
+	/// <summary>
+	/// Asks the I/O thread to send all commands that are still queued and to close the connection,
+	/// without waiting. Close() waits for the I/O thread to finish,
+	/// so several connections can be closed at the same time.
+	/// </summary>
+	///
+	public void RequestClose()
+	{
+		stopRequested = true;
+		commandSignal.Set();
+	}
+
+
+	/// <summary>
+	/// Sends all commands that are still queued, switches the module back to the original speed
+	/// and closes the connection.
+	/// This method blocks until the I/O thread has finished (or a timeout occured).
+	/// </summary>
+	///
+	public void Close()
+	{
+		if ( ioThread != null )
+		{
+			RequestClose();
+			ioThread.Join(CLOSE_TIMEOUT);
+			ioThread = null;
+		}
+		state = State.CLOSED;
+	}
+
+
+	/// <summary>
+	/// Records all commands and answers into a trace (see ArduinoIO_Trace).
+	/// Needs to be called before the connection is opened.
+	/// </summary>
+	/// <param name='trace'>
+	/// the trace to record into (null: no recording)
+	/// </param>
+	///
+	public void SetTrace(ArduinoIO_Trace trace)
+	{
+		this.trace = trace;
+	}
+
+
+	/// <summary>
+	/// Gives the first LCD a back buffer when connecting, if the module supports it (X command),
+	/// so that the text changes of one update appear at once. This clears the LCD when connecting.
+	/// With the back buffer, LCD commands sent with SendCommand() (e.g., C, T, N or V) are only shown
+	/// with the next change of the mirror or after an X command.
+	/// Needs to be called before the connection is opened.
+	/// </summary>
+	/// <param name='enable'>
+	/// <code>true</code> to use the back buffer,
+	/// <code>false</code> to show all text straight away (default)
+	/// </param>
+	///
+	public void SetBackBuffer(bool enable)
+	{
+		this.useBackBuffer = enable;
+	}
+
+
+	/// <summary>
+	/// Checks if the module is connected.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the module is connected,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool IsConnected()
+	{
+		return state == State.CONNECTED;
+	}
+
+
+	/// <summary>
+	/// Checks if the connection is still being established.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the connection is being established,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool IsConnecting()
+	{
+		return state == State.CONNECTING;
+	}
+
+
+	/// <summary>
+	/// Checks if the connection could not be established.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the port could not be opened or the module did not answer,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool HasFailed()
+	{
+		return state == State.FAILED;
+	}
+
+
+	/// <summary>
+	/// Gets the name of the serial port.
+	/// </summary>
+	/// <returns>
+	/// the name of the serial port
+	/// </returns>
+	///
+	public String GetPortName()
+	{
+		return portName;
+	}
+
+
+	/// <summary>
+	/// Gets the number of commands that have been sent to the module, including the mirror changes.
+	/// </summary>
+	/// <returns>
+	/// the number of commands
+	/// </returns>
+	///
+	public int GetCommandCount()
+	{
+		return commandCount;
+	}
+
+
+	/// <summary>
+	/// Gets the number of commands that the module has not answered in time.
+	/// </summary>
+	/// <returns>
+	/// the number of timeouts
+	/// </returns>
+	///
+	public int GetTimeoutCount()
+	{
+		return timeoutCount;
+	}
+
+
+	/// <summary>
+	/// Gets the average time from sending a command until its answer arrived.
+	/// </summary>
+	/// <returns>
+	/// the average round trip time in ms (0: no commands sent)
+	/// </returns>
+	///
+	public double GetAverageRoundTrip()
+	{
+		int count = commandCount;
+		return (count > 0) ? (Interlocked.Read(ref roundTripTicks) * 1000.0 / System.Diagnostics.Stopwatch.Frequency / count) : 0;
+	}
+
+
+	/// <summary>
+	/// Gets the version string the module returned when the connection was opened.
+	/// </summary>
+	/// <returns>
+	/// the version string
+	/// </returns>
+	///
+	public String GetVersion()
+	{
+		return version;
+	}
+
+
+	/// <summary>
+	/// Gets the description the module returned when the connection was opened.
+	/// Modules without the I command are described by their version only (see ArduinoIO_Capabilities.FromVersion()).
+	/// </summary>
+	/// <returns>
+	/// the description of the module
+	/// </returns>
+	///
+	public ArduinoIO_Capabilities GetCapabilities()
+	{
+		return capabilities;
+	}
+
+
+	/// <summary>
+	/// Gets the estimate of the module clock.
+	/// </summary>
+	/// <returns>
+	/// the clock of the module (not synchronised if the module has no Y command)
+	/// </returns>
+	///
+	public ArduinoIO_Clock GetClock()
+	{
+		return clock;
+	}
+
+
+	/// <summary>
+	/// Queues a command that the module executes at a specific time, independent of the serial latency.
+	/// Only L, M and N commands can be scheduled, and they are not part of the mirror:
+	/// LEDs that are controlled by scheduled commands should not be set with SetLed() as well.
+	/// The module keeps only a few scheduled commands (see the Q command), a full schedule is reported as an error.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the command was queued,
+	/// <code>false</code> if the module is not connected, the clock is not synchronised or the queue is full
+	/// </returns>
+	/// <param name='command'>
+	/// the command to send
+	/// </param>
+	/// <param name='timestamp'>
+	/// the Stopwatch timestamp when the command shall be executed (less than 35 minutes ahead),
+	/// e.g., <c>Stopwatch.GetTimestamp() + Stopwatch.Frequency / 2</c> for half a second from now
+	/// </param>
+	///
+	public bool SendCommandAt(String command, long timestamp)
+	{
+		if ( !clock.IsSynchronised() ) return false;
+		return Enqueue(CMD_AT + clock.ToDeviceTime(timestamp) + command, false, null, 0);
+	}
+
+
+	/// <summary>
+	/// Queues a command that is acknowledged by the module with "+".
+	/// Any errors are reported when ProcessAnswers() is called.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the command was queued,
+	/// <code>false</code> if the module is not connected or the queue is full
+	/// </returns>
+	/// <param name='command'>
+	/// the command to send
+	/// </param>
+	///
+	public bool SendCommand(String command)
+	{
+		return Enqueue(command, false, null, 0);
+	}
+
+
+	/// <summary>
+	/// Queues a request that is answered by the module with a value.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the request was queued,
+	/// <code>false</code> if the module is not connected or the queue is full
+	/// </returns>
+	/// <param name='command'>
+	/// the command to send
+	/// </param>
+	/// <param name='handler'>
+	/// the handler to call with the answer from within ProcessAnswers() (can be null)
+	/// </param>
+	///
+	public bool SendRequest(String command, AnswerHandler handler)
+	{
+		return Enqueue(command, true, handler, 0);
+	}
+
+
+	/// <summary>
+	/// Sets text on the LCD. Only the characters that differ from the module are sent.
+	/// </summary>
+	/// <param name='row'>
+	/// the row where the text starts
+	/// </param>
+	/// <param name='column'>
+	/// the column where the text starts
+	/// </param>
+	/// <param name='text'>
+	/// the text to write
+	/// </param>
+	///
+	public void SetText(int row, int column, String text)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.SetText(row, column, text) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Clears the text on the LCD.
+	/// </summary>
+	///
+	public void ClearText()
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.ClearText() ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Sets the brightness of a LED, if it differs from the module.
+	/// </summary>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	///
+	public void SetLed(int led, int brightness)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.SetLed(led, brightness) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Sets the brightness and blink parameters of a LED, if they differ from the module.
+	/// </summary>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	///
+	public void SetLed(int led, int brightness, int interval, int ratio)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.SetLed(led, brightness, interval, ratio) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Sets the colour of a multicolour LED, if it differs from the module.
+	/// </summary>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='red'>
+	/// the red component (0-99)
+	/// </param>
+	/// <param name='green'>
+	/// the green component (0-99)
+	/// </param>
+	/// <param name='blue'>
+	/// the blue component (0-99)
+	/// </param>
+	///
+	public void SetLedColour(int led, int red, int green, int blue)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.SetLedColour(led, red, green, blue) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Defines a number field that the module formats itself.
+	/// </summary>
+	/// <param name='field'>
+	/// the number of the field (0-7)
+	/// </param>
+	/// <param name='row'>
+	/// the row of the field
+	/// </param>
+	/// <param name='column'>
+	/// the first column of the field
+	/// </param>
+	/// <param name='width'>
+	/// the number of characters of the field
+	/// </param>
+	/// <param name='decimals'>
+	/// the number of decimal places
+	/// </param>
+	/// <param name='zeros'>
+	/// <code>true</code> to fill the field with leading zeros
+	/// </param>
+	/// <param name='leftAligned'>
+	/// <code>true</code> to align the number to the left
+	/// </param>
+	///
+	public void DefineField(int field, int row, int column, int width, int decimals, bool zeros, bool leftAligned)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.DefineField(field, row, column, width, decimals, zeros, leftAligned) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Sets the number of a field, if it differs from the module.
+	/// </summary>
+	/// <param name='field'>
+	/// the number of the field (0-7)
+	/// </param>
+	/// <param name='value'>
+	/// the number including the decimal places, e.g., 125 for 1.25 with 2 decimal places
+	/// </param>
+	///
+	public void SetField(int field, int value)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.SetField(field, value) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Uploads the text of a screen page to the module.
+	/// The module stores the page in its EEPROM for the current size of the LCD,
+	/// the page has no LED states until DefinePageLed() is called.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the page commands were queued,
+	/// <code>false</code> if the module is not connected or the queue is full
+	/// </returns>
+	/// <param name='page'>
+	/// the number of the page (0-5)
+	/// </param>
+	/// <param name='text'>
+	/// the text of the rows of the page
+	/// </param>
+	///
+	public bool DefinePage(int page, String[] text)
+	{
+		bool success = Enqueue("U" + page, false, null, PAGE_TIMEOUT);
+		for ( int row = 0 ; (row < text.Length) && success ; row++ )
+		{
+			success = Enqueue("W" + page + "," + row + ",\"" + text[row] + "\"", false, null, PAGE_TIMEOUT);
+		}
+		if ( success )
+		{
+			lock ( mirrorLock )
+			{
+				deviceState.DefinePage(page, text);
+			}
+		}
+		return success;
+	}
+
+
+	/// <summary>
+	/// Uploads the state of a LED on a screen page to the module.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the command was queued,
+	/// <code>false</code> if the module is not connected or the queue is full
+	/// </returns>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	/// <param name='led'>
+	/// the number of the LED (up to 4 LEDs per page)
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds (0: no blinking)
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	///
+	public bool DefinePageLed(int page, int led, int brightness, int interval, int ratio)
+	{
+		if ( !Enqueue("K" + page + "," + led + "," + brightness + "," + interval + "," + ratio,
+		              false, null, PAGE_TIMEOUT) ) return false;
+		lock ( mirrorLock )
+		{
+			deviceState.DefinePageLed(page, led, brightness, interval, ratio, false, 0, 0, 0);
+		}
+		return true;
+	}
+
+
+	/// <summary>
+	/// Uploads the state and colour of a multicolour LED on a screen page to the module.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the command was queued,
+	/// <code>false</code> if the module is not connected or the queue is full
+	/// </returns>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	/// <param name='led'>
+	/// the number of the LED (up to 4 LEDs per page)
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds (0: no blinking)
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	/// <param name='red'>
+	/// the red component (0-99)
+	/// </param>
+	/// <param name='green'>
+	/// the green component (0-99)
+	/// </param>
+	/// <param name='blue'>
+	/// the blue component (0-99)
+	/// </param>
+	///
+	public bool DefinePageLed(int page, int led, int brightness, int interval, int ratio, int red, int green, int blue)
+	{
+		if ( !Enqueue("K" + page + "," + led + "," + brightness + "," + interval + "," + ratio + "," +
+		              red + "," + green + "," + blue, false, null, PAGE_TIMEOUT) ) return false;
+		lock ( mirrorLock )
+		{
+			deviceState.DefinePageLed(page, led, brightness, interval, ratio, true, red, green, blue);
+		}
+		return true;
+	}
+
+
+	/// <summary>
+	/// Shows a screen page that has been uploaded with DefinePage().
+	/// Only the page number is sent, followed by the changes that were made after the page was shown.
+	/// Number fields need to be set again.
+	/// </summary>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	///
+	public void ShowPage(int page)
+	{
+		lock ( mirrorLock )
+		{
+			if ( deviceState.ShowPage(page) ) commandSignal.Set();
+		}
+	}
+
+
+	/// <summary>
+	/// Processes all answers that the I/O thread has received so far.
+	/// This method needs to be called regularly from the game thread.
+	/// </summary>
+	///
+	public void ProcessAnswers()
+	{
+		Request req;
+		while ( answerQueue.TryDequeue(out req) )
+		{
+			if ( req.timeout )
+			{
+				Debug.LogError("Arduino IO box timeout for " + (req.isRequest ? "request " : "command ") + req.command);
+			}
+			else if ( req.isRequest ? (req.answer == "!") : (req.answer != "+") )
+			{
+				Debug.LogError("Arduino IO box error for " + (req.isRequest ? "request " : "command ") + req.command + ": " + req.answer);
+			}
+
+			if ( req.handler != null )
+			{
+				req.handler(req.command, req.answer);
+			}
+		}
+
+		// report connection changes only once
+		if ( state != reportedState )
+		{
+			if ( state == State.CONNECTED )
+			{
+				Debug.Log("Opened serial port " + portName + " to Arduino IO (Version: " + version + ", " + negotiatedSpeed + " baud)");
+			}
+			else if ( state == State.FAILED )
+			{
+				Debug.LogError("Could not open serial port " + portName + " to the Arduino IO module.");
+			}
+			reportedState = state;
+		}
+	}
+
+
+	/// <summary>
+	/// Puts a command into the queue for the I/O thread.
+	/// A read timeout of 0 uses the default timeout of the serial port.
+	/// </summary>
+	///
+	private bool Enqueue(String command, bool isRequest, AnswerHandler handler, int readTimeout)
+	{
+		if ( state != State.CONNECTED ) return false;
+
+		Request req     = new Request();
+		req.command     = command;
+		req.isRequest   = isRequest;
+		req.handler     = handler;
+		req.readTimeout = readTimeout;
+		if ( !commandQueue.Enqueue(req) )
+		{
+			Debug.LogError("Arduino IO box command queue full, dropped command " + command);
+			return false;
+		}
+		commandSignal.Set();
+		return true;
+	}
+
+
+	/// <summary>
+	/// Main method of the I/O thread.
+	/// </summary>
+	///
+	private void RunIO()
+	{
+		if ( !Connect() )
+		{
+			state = State.FAILED;
+			return;
+		}
+		if ( (fastSpeed > speed) && capabilities.SupportsCommand(CMD_SPEED[0]) && !stopRequested )
+		{
+			NegotiateSpeed(Math.Min(fastSpeed, capabilities.GetMaxSpeed()));
+		}
+		SynchroniseClock();
+		bool backBuffer = useBackBuffer && EnableBackBuffer();
+
+		// mirror for the actual module, with the changes that were made in the default mirror while connecting.
+		// The game thread changes the mirror only while holding the lock, so no change can go into the old mirror.
+		ArduinoIO_DeviceState moduleState = CreateDeviceState(capabilities, backBuffer);
+		lock ( mirrorLock )
+		{
+			moduleState.TakeOver(deviceState);
+			deviceState = moduleState;
+		}
+		state = State.CONNECTED;
+
+		while ( true )
+		{
+			Request req;
+			if ( commandQueue.TryDequeue(out req) )
+			{
+				Execute(req);
+			}
+			else if ( deviceState.HasChanges() )
+			{
+				// queue is empty: send the latest LCD and LED changes
+				stateCommands.Clear();
+				deviceState.CollectChanges(stateCommands);
+				foreach ( String command in stateCommands )
+				{
+					req = new Request();
+					req.command = command;
+					Execute(req);
+				}
+			}
+			else if ( stopRequested )
+			{
+				break;
+			}
+			else if ( System.Diagnostics.Stopwatch.GetTimestamp() - lastSyncTicks > SYNC_INTERVAL * System.Diagnostics.Stopwatch.Frequency / 1000 )
+			{
+				// nothing to send: time to correct the drift of the module clock
+				SynchroniseClock();
+			}
+			else
+			{
+				commandSignal.WaitOne(IDLE_WAIT);
+			}
+		}
+
+		// the module keeps a fast speed until it is reset: the next connection expects the original speed
+		ArduinoIO_SerialSpeed.Restore(serialPort, speed, version, trace);
+		serialPort.Close();
+		serialPort = null;
+	}
+
+
+	/// <summary>
+	/// Creates the mirror for the LCD, the LEDs, the number fields and the screen pages of a module.
+	/// The mirror covers the first LCD.
+	/// </summary>
+	///
+	private static ArduinoIO_DeviceState CreateDeviceState(ArduinoIO_Capabilities caps, bool backBuffer)
+	{
+		return new ArduinoIO_DeviceState(caps.GetDisplayRows(0), caps.GetDisplayColumns(0),
+		                                 caps.GetLedCount(), caps.GetFieldCount(), caps.GetPageCount(),
+		                                 backBuffer);
+	}
+
+
+	/// <summary>
+	/// Gives the first LCD of the module a back buffer, so that the text changes of one update
+	/// appear at once and each changed character is written to the LCD only once (runs on the I/O thread).
+	/// This clears the LCD.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the text changes need to be shown with the X command,
+	/// <code>false</code> if the module shows them straight away
+	/// </returns>
+	///
+	private bool EnableBackBuffer()
+	{
+		if ( !capabilities.SupportsCommand(CMD_COMMIT[0]) || (capabilities.GetDisplayCount() == 0) ) return false;
+
+		return ReadAnswer(CMD_GEOMETRY + capabilities.GetDisplayColumns(0) + "," + capabilities.GetDisplayRows(0) + ",0,1") == "+";
+	}
+
+
+	/// <summary>
+	/// Opens the serial port and checks if the module answers (runs on the I/O thread).
+	/// The module is asked for its description, modules without the I command for their version.
+	/// If the module does not answer at the original speed, it might still be at a fast speed
+	/// from a connection that was not closed properly, so the fast speeds are tried as well.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the module answered,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	private bool Connect()
+	{
+		serialPort = new SerialPort(portName, speed, Parity.None, 8, StopBits.One);
+		serialPort.Handshake   = Handshake.None;
+		serialPort.RtsEnable   = false;
+		serialPort.DtrEnable   = false;  // Disable DTR so NOT to reset Arduino board when connecting
+		serialPort.ReadTimeout = 250;    // longer read timeout (module might have had a reset nevertheless)
+
+		bool success = false;
+		try
+		{
+			serialPort.Open();
+		}
+		catch (IOException)
+		{
+			serialPort = null;
+		}
+
+		if ( (serialPort != null) && serialPort.IsOpen )
+		{
+			int   repeats     = 8; // try several times to connect
+			int[] probeSpeeds = ArduinoIO_SerialSpeed.GetProbeSpeeds(speed, fastSpeed);
+			int   probeIdx    = 0;
+			while ( !success && !stopRequested )
+			{
+				if ( repeats-- <= 0 )
+				{
+					// no answer at this speed: try the next one, twice each
+					if ( probeIdx >= probeSpeeds.Length ) break;
+					serialPort.BaudRate = probeSpeeds[probeIdx++];
+					repeats = 1;
+				}
+				// ask for the description, one answer configures the whole connection
+				serialPort.WriteLine(CMD_INFO);
+				try
+				{
+					String serialNo = serialPort.ReadLine();
+					if ( serialNo == "?" )
+					{
+						// older module: only the version
+						serialPort.WriteLine(CMD_ECHO);
+						serialNo = serialPort.ReadLine();
+					}
+					ArduinoIO_Capabilities caps = ArduinoIO_Capabilities.Parse(serialNo);
+					// at a fast speed, a garbled answer is possible: the echo needs to confirm the version
+					if ( (serialNo.Length > 1) &&
+					     ((serialPort.BaudRate == speed) || (ReadAnswer(CMD_ECHO) == caps.GetVersion())) )
+					{
+						capabilities = caps;
+						version  = capabilities.GetVersion();
+						success  = true;
+						negotiatedSpeed = serialPort.BaudRate;
+						serialPort.ReadTimeout = 50; // from now on, shorter response times, please
+					}
+				}
+				catch (TimeoutException)
+				{
+					// ignore
+				}
+			}
+		}
+
+		if ( !success && (serialPort != null) )
+		{
+			serialPort.Close();
+			serialPort = null;
+		}
+		return success;
+	}
+
+
+	/// <summary>
+	/// Switches the module and the serial port to the fast speed (runs on the I/O thread).
+	/// If the module does not answer at the new speed, both sides fall back to the original speed.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the fast speed is used,
+	/// <code>false</code> if the original speed is used
+	/// </returns>
+	/// <param name='newSpeed'>
+	/// the speed to switch to
+	/// </param>
+	///
+	private bool NegotiateSpeed(int newSpeed)
+	{
+		if ( negotiatedSpeed == newSpeed ) return true; // module was still at that speed
+
+		bool success = ArduinoIO_SerialSpeed.Negotiate(serialPort, speed, newSpeed, version, trace);
+		negotiatedSpeed = serialPort.BaudRate;
+		return success;
+	}
+
+
+	/// <summary>
+	/// Asks the module for its time several times and updates the clock estimate (runs on the I/O thread).
+	/// </summary>
+	///
+	private void SynchroniseClock()
+	{
+		lastSyncTicks = System.Diagnostics.Stopwatch.GetTimestamp();
+		if ( !capabilities.SupportsCommand(CMD_TIME[0]) ) return;
+
+		for ( int i = 0 ; (i < SYNC_SAMPLES) && !stopRequested ; i++ )
+		{
+			long   sendTicks    = System.Diagnostics.Stopwatch.GetTimestamp();
+			String answer       = ReadAnswer(CMD_TIME);
+			long   receiveTicks = System.Diagnostics.Stopwatch.GetTimestamp();
+			uint   deviceMicros;
+			if ( !uint.TryParse(answer, out deviceMicros) ) continue;
+
+			// the answer (with CR LF) takes longer to transfer than the command (with LF), 10 bits per byte
+			long transferTicks = (answer.Length + 1) * 10 * System.Diagnostics.Stopwatch.Frequency / negotiatedSpeed;
+			clock.AddSample(sendTicks, receiveTicks, deviceMicros, transferTicks);
+		}
+		clock.EndBurst();
+		lastSyncTicks = System.Diagnostics.Stopwatch.GetTimestamp();
+	}
+
+
+	/// <summary>
+	/// Sends a command and reads the answer line (runs on the I/O thread).
+	/// </summary>
+	/// <returns>
+	/// the answer or "" in case of a timeout
+	/// </returns>
+	/// <param name='command'>
+	/// the command to send
+	/// </param>
+	///
+	private String ReadAnswer(String command)
+	{
+		return ArduinoIO_SerialSpeed.ReadAnswer(serialPort, command, trace);
+	}
+
+
+	/// <summary>
+	/// Sends a command and waits for the answer (runs on the I/O thread).
+	/// </summary>
+	///
+	private void Execute(Request req)
+	{
+		req.answer  = "";
+		req.timeout = false;
+		int  defaultTimeout = serialPort.ReadTimeout;
+		long startTicks     = System.Diagnostics.Stopwatch.GetTimestamp();
+		try
+		{
+			serialPort.DiscardInBuffer();
+			if ( trace != null ) trace.Record(true, req.command);
+			serialPort.WriteLine(req.command);
+			if ( req.readTimeout > 0 ) serialPort.ReadTimeout = req.readTimeout;
+			req.answer = serialPort.ReadLine();
+		}
+		catch (TimeoutException)
+		{
+			req.timeout = true;
+		}
+		catch (IOException)
+		{
+			req.timeout = true;
+		}
+		serialPort.ReadTimeout = defaultTimeout;
+		if ( trace != null ) trace.Record(false, req.answer);
+		Interlocked.Add(ref roundTripTicks, System.Diagnostics.Stopwatch.GetTimestamp() - startTicks);
+		if ( req.timeout ) timeoutCount++;
+		commandCount++;
+
+		// only hand back answers that the game thread needs to look at
+		if ( req.timeout || (req.handler != null) ||
+		     (req.isRequest ? (req.answer == "!") : (req.answer != "+")) )
+		{
+			while ( !answerQueue.Enqueue(req) && !stopRequested )
+			{
+				// game thread is not processing the answers: wait
+				Thread.Sleep(IDLE_WAIT);
+			}
+		}
+	}
+
+
+	private enum State {
+		CLOSED,
+		CONNECTING,
+		CONNECTED,
+		FAILED
+	};
+
+
+	/// <summary>
+	/// A command on its way to the module and back.
+	/// </summary>
+	///
+	private class Request
+	{
+		public String        command;
+		public bool          isRequest;
+		public AnswerHandler handler;
+		public String        answer;
+		public bool          timeout;
+		public int           readTimeout; // in ms, 0: default timeout
+	}
+
+
+	private const String CMD_ECHO          = "E";
+	private const String CMD_INFO          = "I";
+	private const String CMD_SPEED         = "B";
+	private const String CMD_TIME          = "Y";
+	private const String CMD_AT            = "@";  // prefix for commands with an execution time
+	private const String CMD_GEOMETRY      = "G";
+	private const String CMD_COMMIT        = "X";
+	private const int    QUEUE_SIZE        = 256;  // maximum number of queued commands/answers
+	private const int    IDLE_WAIT         = 100;  // time in ms the I/O thread waits for new commands
+	private const int    CLOSE_TIMEOUT     = 2000; // time in ms to wait for the queue to be sent when closing
+	private const int    PAGE_TIMEOUT      = 250;  // time in ms to wait for page commands (writing a changed EEPROM byte takes 3.3ms)
+	private const int    SYNC_SAMPLES      = 8;    // number of time requests for one clock synchronisation
+	private const int    SYNC_INTERVAL     = 10000; // time in ms between clock synchronisations
+
+	private readonly String         portName;
+	private readonly int            speed;
+	private readonly int            fastSpeed;
+	private volatile int            negotiatedSpeed;
+	private SerialPort              serialPort = null;
+	private Thread                  ioThread   = null;
+	private volatile bool           stopRequested;
+	private volatile State          state;
+	private State                   reportedState = State.CLOSED;
+	private volatile String         version;
+	private volatile ArduinoIO_Capabilities capabilities; // set by the I/O thread when connecting
+	private ArduinoIO_Trace         trace = null; // recording of the serial traffic (I/O thread only)
+	private bool                    useBackBuffer = false; // true: LCD 0 gets a back buffer when connecting
+	private volatile int            commandCount;   // statistics, written by the I/O thread only
+	private volatile int            timeoutCount;
+	private long                    roundTripTicks; // sum of the round trip times (Stopwatch ticks)
+
+	private LockFreeQueue<Request>  commandQueue; // game thread -> I/O thread
+	private LockFreeQueue<Request>  answerQueue;  // I/O thread -> game thread
+	private AutoResetEvent          commandSignal;
+	private volatile ArduinoIO_DeviceState deviceState; // LCD/LED mirror, set by the game thread
+	private readonly object         mirrorLock = new object(); // held by the game thread while it changes the mirror
+	private List<String>            stateCommands; // commands for the mirror changes (I/O thread only)
+	private ArduinoIO_Clock         clock;         // estimate of the module clock, updated by the I/O thread
+	private long                    lastSyncTicks; // time of the last clock synchronisation (I/O thread only)
+}
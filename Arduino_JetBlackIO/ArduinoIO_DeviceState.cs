@@ -0,0 +1,839 @@
+
+using System;
+using System.Text;
+using System.Collections.Generic;
+using System.Threading;
+
+/// <summary>
+/// Mirror of the LCD text, the number fields and the LED states of the Arduino I/O module.
+/// The game thread sets the desired state,
+/// the I/O thread sends only the differences between the desired state
+/// and the state that was last sent to the module.
+/// If the same LCD row or LED changes several times before it is sent,
+/// only the latest state goes out.
+/// Number fields are formatted by the module, so a field update only sends the number.
+/// The mirror formats the numbers as well, to know the text that the module shows.
+/// Screen pages are stored on the module, showing a page only sends the page number.
+/// The mirror keeps a copy of the pages, to know the text and LED states after a page change.
+/// If the LCD of the module has a back buffer, the text changes of one update end with the X command,
+/// so they appear on the LCD at once.
+/// </summary>
+///
+public class ArduinoIO_DeviceState
+{
+	/// <summary>
+	/// Creates the mirror. The state of the module is unknown at first,
+	/// so everything that is set will be sent at least once.
+	/// </summary>
+	/// <param name='lcdRows'>
+	/// the number of rows of the LCD
+	/// </param>
+	/// <param name='lcdColumns'>
+	/// the number of columns of the LCD
+	/// </param>
+	/// <param name='numLeds'>
+	/// the number of LEDs of the module
+	/// </param>
+	/// <param name='numFields'>
+	/// the number of number fields of the module
+	/// </param>
+	/// <param name='numPages'>
+	/// the number of screen pages of the module
+	/// </param>
+	/// <param name='backBuffer'>
+	/// <code>true</code> if the text is written into a back buffer that is shown with the X command
+	/// </param>
+	///
+	public ArduinoIO_DeviceState(int lcdRows, int lcdColumns, int numLeds, int numFields, int numPages, bool backBuffer)
+	{
+		this.lcdColumns = lcdColumns;
+		this.backBuffer = backBuffer;
+		rows = new RowSlot[lcdRows];
+		for ( int i = 0 ; i < lcdRows ; i++ )
+		{
+			rows[i] = new RowSlot(); // target stays null until text is set
+		}
+		leds = new LedSlot[numLeds];
+		for ( int i = 0 ; i < numLeds ; i++ )
+		{
+			leds[i] = new LedSlot();
+		}
+		fields = new FieldSlot[numFields];
+		for ( int i = 0 ; i < numFields ; i++ )
+		{
+			fields[i] = new FieldSlot();
+		}
+		pages = new PageState[numPages]; // null: page not defined
+	}
+
+
+	/// <summary>
+	/// Sets text on the LCD (game thread).
+	/// Text that is longer than the row continues on the next row, like on the module.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LCD content has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='row'>
+	/// the row where the text starts
+	/// </param>
+	/// <param name='column'>
+	/// the column where the text starts
+	/// </param>
+	/// <param name='text'>
+	/// the text to write
+	/// </param>
+	///
+	public bool SetText(int row, int column, String text)
+	{
+		if ( (row < 0) || (row >= rows.Length) || (column < 0) || (column >= lcdColumns) ) return false;
+
+		bool changed = false;
+		int  idx     = 0;
+		while ( idx < text.Length )
+		{
+			int           count   = Math.Min(text.Length - idx, lcdColumns - column);
+			String        current = rows[row].target;
+			StringBuilder line    = new StringBuilder((current != null) ? current : new String(' ', lcdColumns));
+			for ( int i = 0 ; i < count ; i++ )
+			{
+				line[column + i] = text[idx + i];
+			}
+			String newLine = line.ToString();
+			if ( newLine != current )
+			{
+				rows[row].target = newLine; // publish the complete row at once
+				changed = true;
+			}
+			idx   += count;
+			column = 0;
+			row    = (row + 1) % rows.Length;
+		}
+		return changed;
+	}
+
+
+	/// <summary>
+	/// Clears the text on the LCD (game thread).
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LCD content has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool ClearText()
+	{
+		bool   changed = false;
+		String empty   = new String(' ', lcdColumns);
+		for ( int i = 0 ; i < rows.Length ; i++ )
+		{
+			if ( rows[i].target != empty )
+			{
+				rows[i].target = empty;
+				changed = true;
+			}
+		}
+		// the numbers are gone as well and need to be shown again
+		for ( int i = 0 ; i < fields.Length ; i++ )
+		{
+			FieldState state = fields[i].target;
+			if ( (state != null) && state.hasValue )
+			{
+				fields[i].target = state.WithoutValue();
+			}
+		}
+		return changed;
+	}
+
+
+	/// <summary>
+	/// Sets the brightness of a LED (game thread). The blink parameters stay unchanged.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LED state has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	///
+	public bool SetLed(int led, int brightness)
+	{
+		if ( (led < 0) || (led >= leds.Length) ) return false;
+		LedState state = LedState.CopyOf(leds[led].target);
+		state.brightness = brightness;
+		return Publish(led, state);
+	}
+
+
+	/// <summary>
+	/// Sets the brightness and blink parameters of a LED (game thread).
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LED state has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	///
+	public bool SetLed(int led, int brightness, int interval, int ratio)
+	{
+		if ( (led < 0) || (led >= leds.Length) ) return false;
+		LedState state = LedState.CopyOf(leds[led].target);
+		state.brightness = brightness;
+		state.interval   = interval;
+		state.ratio      = ratio;
+		state.blinkSet   = true;
+		return Publish(led, state);
+	}
+
+
+	/// <summary>
+	/// Sets the colour of a multicolour LED (game thread).
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LED state has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='led'>
+	/// the number of the LED to set
+	/// </param>
+	/// <param name='red'>
+	/// the red component (0-99)
+	/// </param>
+	/// <param name='green'>
+	/// the green component (0-99)
+	/// </param>
+	/// <param name='blue'>
+	/// the blue component (0-99)
+	/// </param>
+	///
+	public bool SetLedColour(int led, int red, int green, int blue)
+	{
+		if ( (led < 0) || (led >= leds.Length) ) return false;
+		LedState state = LedState.CopyOf(leds[led].target);
+		state.red       = red;
+		state.green     = green;
+		state.blue      = blue;
+		state.colourSet = true;
+		return Publish(led, state);
+	}
+
+
+	/// <summary>
+	/// Defines the position and format of a number field (game thread).
+	/// The field is shown on the LCD with the next call of SetField().
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the field definition has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='field'>
+	/// the number of the field
+	/// </param>
+	/// <param name='row'>
+	/// the row of the field
+	/// </param>
+	/// <param name='column'>
+	/// the first column of the field
+	/// </param>
+	/// <param name='width'>
+	/// the number of characters of the field
+	/// </param>
+	/// <param name='decimals'>
+	/// the number of decimal places
+	/// </param>
+	/// <param name='zeros'>
+	/// <code>true</code>: fill with leading zeros, <code>false</code>: fill with spaces
+	/// </param>
+	/// <param name='leftAligned'>
+	/// <code>true</code>: left aligned, <code>false</code>: right aligned
+	/// </param>
+	///
+	public bool DefineField(int field, int row, int column, int width, int decimals, bool zeros, bool leftAligned)
+	{
+		if ( (field < 0) || (field >= fields.Length) ) return false;
+		FieldState state = new FieldState();
+		state.row         = row;
+		state.column      = column;
+		state.width       = width;
+		state.decimals    = decimals;
+		state.zeros       = zeros;
+		state.leftAligned = leftAligned;
+		if ( state.SameDefinition(fields[field].target) ) return false;
+		fields[field].target = state; // publish the complete state at once
+		return true;
+	}
+
+
+	/// <summary>
+	/// Sets the number of a field (game thread).
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the field has changed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='field'>
+	/// the number of the field
+	/// </param>
+	/// <param name='value'>
+	/// the number including the decimal places, e.g., 125 for 1.25 with 2 decimal places
+	/// </param>
+	///
+	public bool SetField(int field, int value)
+	{
+		if ( (field < 0) || (field >= fields.Length) || (fields[field].target == null) ) return false;
+		FieldState current = fields[field].target;
+		value = Math.Max(0, value);
+		if ( current.hasValue && (current.value == value) ) return false;
+
+		FieldState state = current.Copy();
+		state.value    = value;
+		state.hasValue = true;
+		// the text the module will show, so that the text spans don't overwrite it
+		SetText(state.row, state.column, state.Format());
+		fields[field].target = state;
+		return true;
+	}
+
+
+	/// <summary>
+	/// Records the text of a screen page that has been uploaded to the module (game thread).
+	/// The page has no LED states yet.
+	/// </summary>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	/// <param name='text'>
+	/// the text of the rows of the page
+	/// </param>
+	///
+	public void DefinePage(int page, String[] text)
+	{
+		if ( (page < 0) || (page >= pages.Length) ) return;
+		PageState state = new PageState();
+		state.number = page;
+		state.rows   = new String[rows.Length];
+		for ( int i = 0 ; i < rows.Length ; i++ )
+		{
+			String line = (i < text.Length) ? text[i] : "";
+			state.rows[i] = (line.Length > lcdColumns) ? line.Substring(0, lcdColumns) : line.PadRight(lcdColumns);
+		}
+		state.leds  = new LedState[leds.Length];
+		pages[page] = state;
+	}
+
+
+	/// <summary>
+	/// Records the state of a LED on a screen page that has been uploaded to the module (game thread).
+	/// </summary>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	/// <param name='led'>
+	/// the number of the LED
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	/// <param name='colour'>
+	/// <code>true</code> if the page sets the colour of the LED
+	/// </param>
+	/// <param name='red'>
+	/// the red component (0-99)
+	/// </param>
+	/// <param name='green'>
+	/// the green component (0-99)
+	/// </param>
+	/// <param name='blue'>
+	/// the blue component (0-99)
+	/// </param>
+	///
+	public void DefinePageLed(int page, int led, int brightness, int interval, int ratio,
+	                          bool colour, int red, int green, int blue)
+	{
+		if ( (page < 0) || (page >= pages.Length) || (pages[page] == null) ) return;
+		if ( (led < 0) || (led >= leds.Length) ) return;
+		LedState entry = new LedState();
+		entry.brightness = brightness;
+		entry.interval   = interval;
+		entry.ratio      = ratio;
+		entry.blinkSet   = true;
+		entry.colourSet  = colour;
+		entry.red        = red;
+		entry.green      = green;
+		entry.blue       = blue;
+		PageState state = pages[page].Copy();
+		state.leds[led] = entry;
+		pages[page] = state;
+	}
+
+
+	/// <summary>
+	/// Shows a screen page (game thread).
+	/// The text and the LEDs are set to the page, number fields need to be set again.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the page is defined,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='page'>
+	/// the number of the page
+	/// </param>
+	///
+	public bool ShowPage(int page)
+	{
+		if ( (page < 0) || (page >= pages.Length) || (pages[page] == null) ) return false;
+		PageState state = pages[page];
+		for ( int i = 0 ; i < rows.Length ; i++ )
+		{
+			rows[i].target = state.rows[i];
+		}
+		for ( int led = 0 ; led < leds.Length ; led++ )
+		{
+			if ( state.leds[led] != null )
+			{
+				leds[led].target = state.ApplyTo(led, leds[led].target);
+			}
+		}
+		// the page covers the numbers
+		for ( int i = 0 ; i < fields.Length ; i++ )
+		{
+			FieldState field = fields[i].target;
+			if ( (field != null) && field.hasValue )
+			{
+				fields[i].target = field.WithoutValue();
+			}
+		}
+		// publish the page change after the new targets
+		Interlocked.Exchange(ref pendingPage, state);
+		return true;
+	}
+
+
+	/// <summary>
+	/// Takes over the text, LED states and number fields that were set in another mirror
+	/// of the same module, e.g., in the default mirror that is used until the module has described itself
+	/// (I/O thread). Only rows, LEDs and fields that have not been set in this mirror yet are taken over.
+	/// Rows are cut or filled up to the width of this LCD.
+	/// </summary>
+	/// <param name='other'>
+	/// the mirror to take the state from
+	/// </param>
+	///
+	public void TakeOver(ArduinoIO_DeviceState other)
+	{
+		for ( int i = 0 ; (i < rows.Length) && (i < other.rows.Length) ; i++ )
+		{
+			String text = other.rows[i].target;
+			if ( (rows[i].target == null) && (text != null) )
+			{
+				rows[i].target = (text.Length > lcdColumns) ? text.Substring(0, lcdColumns) : text.PadRight(lcdColumns);
+			}
+		}
+		for ( int i = 0 ; (i < leds.Length) && (i < other.leds.Length) ; i++ )
+		{
+			if ( leds[i].target == null ) leds[i].target = other.leds[i].target;
+		}
+		for ( int i = 0 ; (i < fields.Length) && (i < other.fields.Length) ; i++ )
+		{
+			if ( fields[i].target == null ) fields[i].target = other.fields[i].target;
+		}
+	}
+
+
+	/// <summary>
+	/// Checks if there are changes that have not been sent yet (I/O thread).
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if there are changes to send,
+	/// <code>false</code> if not
+	/// </returns>
+	///
+	public bool HasChanges()
+	{
+		if ( pendingPage != null ) return true;
+		foreach ( RowSlot slot in rows )
+		{
+			if ( !Object.ReferenceEquals(slot.target, slot.sent) ) return true;
+		}
+		foreach ( LedSlot slot in leds )
+		{
+			if ( slot.target != slot.sent ) return true;
+		}
+		foreach ( FieldSlot slot in fields )
+		{
+			if ( slot.target != slot.sent ) return true;
+		}
+		return false;
+	}
+
+
+	/// <summary>
+	/// Creates the commands for all changes that have not been sent yet
+	/// and marks the changes as sent (I/O thread).
+	/// </summary>
+	/// <param name='commands'>
+	/// the list to append the commands to
+	/// </param>
+	///
+	public void CollectChanges(List<String> commands)
+	{
+		bool textChanged = false;
+
+		// page change first: the other changes only need to cover the differences to the page
+		PageState page = Interlocked.Exchange(ref pendingPage, null);
+		if ( page != null )
+		{
+			commands.Add("D" + page.number);
+			for ( int i = 0 ; i < rows.Length ; i++ )
+			{
+				rows[i].sent = page.rows[i];
+			}
+			for ( int led = 0 ; led < leds.Length ; led++ )
+			{
+				if ( page.leds[led] != null )
+				{
+					leds[led].sent = page.ApplyTo(led, leds[led].sent);
+				}
+			}
+			for ( int i = 0 ; i < fields.Length ; i++ )
+			{
+				FieldState field = fields[i].sent;
+				if ( (field != null) && field.hasValue )
+				{
+					fields[i].sent = field.WithoutValue();
+				}
+			}
+		}
+
+		// LEDs first: they are the most visible
+		for ( int led = 0 ; led < leds.Length ; led++ )
+		{
+			LedState target = leds[led].target;
+			LedState sent   = leds[led].sent;
+			if ( target == sent ) continue;
+
+			if ( target.colourSet &&
+			     ((sent == null) || !sent.colourSet ||
+			      (target.red != sent.red) || (target.green != sent.green) || (target.blue != sent.blue)) )
+			{
+				commands.Add("M" + led + "," + target.red + "," + target.green + "," + target.blue);
+			}
+
+			bool blinkChanged = target.blinkSet &&
+			                    ((sent == null) || !sent.blinkSet ||
+			                     (target.interval != sent.interval) || (target.ratio != sent.ratio));
+			if ( blinkChanged )
+			{
+				commands.Add("L" + led + "," + target.brightness + "," + target.interval + "," + target.ratio);
+			}
+			else if ( (sent == null) || (target.brightness != sent.brightness) )
+			{
+				commands.Add("L" + led + "," + target.brightness);
+			}
+			leds[led].sent = target;
+		}
+
+		// number fields: definitions, then the numbers of consecutive fields in one command
+		for ( int field = 0 ; field < fields.Length ; field++ )
+		{
+			FieldState target = fields[field].target;
+			FieldState sent   = fields[field].sent;
+			if ( (target != sent) && !target.SameDefinition(sent) )
+			{
+				commands.Add("F" + field + "," + target.row + "," + target.column + "," + target.width + "," +
+				             target.decimals + "," + (target.zeros ? 1 : 0) + "," + (target.leftAligned ? 1 : 0));
+				textChanged = true;
+				fields[field].sent = target.hasValue ? target.WithoutValue() : target;
+			}
+		}
+		StringBuilder values     = null;
+		int           valueCount = 0;
+		for ( int field = 0 ; field <= fields.Length ; field++ )
+		{
+			FieldState target = (field < fields.Length) ? fields[field].target : null;
+			bool       send   = (target != null) && target.hasValue &&
+			                    (!fields[field].sent.hasValue || (target.value != fields[field].sent.value));
+			if ( send && (values != null) && (valueCount < MAX_FIELD_VALUES) )
+			{
+				values.Append("," + target.value);
+				valueCount++;
+			}
+			else
+			{
+				if ( values != null ) commands.Add(values.ToString());
+				values     = send ? new StringBuilder("V" + field + "," + target.value) : null;
+				valueCount = 1;
+			}
+			if ( send )
+			{
+				MarkTextSent(target.row, target.column, target.Format());
+				textChanged = true;
+			}
+			if ( target != null )
+			{
+				fields[field].sent = target; // also when there is nothing to send, e.g., no number yet
+			}
+		}
+
+		// text: only the changed spans of each row
+		for ( int row = 0 ; row < rows.Length ; row++ )
+		{
+			String target = rows[row].target;
+			String sent   = rows[row].sent;
+			if ( Object.ReferenceEquals(target, sent) ) continue;
+
+			int col = 0;
+			while ( col < lcdColumns )
+			{
+				if ( (sent != null) && (target[col] == sent[col]) )
+				{
+					col++;
+					continue;
+				}
+				// found the start of a changed span: find its end,
+				// including short unchanged gaps (cheaper than a new cursor command)
+				int start = col;
+				int end   = col + 1;
+				for ( int i = end ; i < lcdColumns ; i++ )
+				{
+					if ( (sent == null) || (target[i] != sent[i]) )
+					{
+						if ( i - end < SPAN_MERGE_GAP ) end = i + 1;
+						else break;
+					}
+				}
+				commands.Add("P" + row + "," + start);
+				commands.Add("T\"" + target.Substring(start, end - start) + "\"");
+				textChanged = true;
+				col = end;
+			}
+			rows[row].sent = target;
+		}
+
+		// show all text changes at once (a page change has already been shown by the D command)
+		if ( backBuffer && textChanged )
+		{
+			commands.Add(CMD_COMMIT);
+		}
+	}
+
+
+	/// <summary>
+	/// Records that the module shows a text because of a number field (I/O thread).
+	/// </summary>
+	///
+	private void MarkTextSent(int row, int column, String text)
+	{
+		if ( (row < 0) || (row >= rows.Length) ) return;
+		String        sent = rows[row].sent;
+		StringBuilder line = new StringBuilder((sent != null) ? sent : new String('\0', lcdColumns));
+		for ( int i = 0 ; (i < text.Length) && (column + i < lcdColumns) ; i++ )
+		{
+			line[column + i] = text[i];
+		}
+		rows[row].sent = line.ToString();
+	}
+
+
+	/// <summary>
+	/// Stores a new LED state if it differs from the current one.
+	/// </summary>
+	///
+	private bool Publish(int led, LedState state)
+	{
+		if ( state.Equals(leds[led].target) ) return false;
+		leds[led].target = state; // publish the complete state at once
+		return true;
+	}
+
+
+	/// <summary>
+	/// State of a LED. Objects are not modified once they are published.
+	/// </summary>
+	///
+	private class LedState
+	{
+		public int  brightness, interval, ratio;
+		public int  red, green, blue;
+		public bool blinkSet, colourSet;
+
+		public static LedState CopyOf(LedState s)
+		{
+			return (s == null) ? new LedState() : (LedState) s.MemberwiseClone();
+		}
+
+		public override bool Equals(object o)
+		{
+			LedState s = o as LedState;
+			return (s != null) &&
+			       (brightness == s.brightness) && (interval == s.interval) && (ratio == s.ratio) &&
+			       (red == s.red) && (green == s.green) && (blue == s.blue) &&
+			       (blinkSet == s.blinkSet) && (colourSet == s.colourSet);
+		}
+
+		public override int GetHashCode()
+		{
+			return brightness ^ (interval << 8) ^ (red << 16) ^ (green << 20) ^ (blue << 24);
+		}
+	}
+
+
+	/// <summary>
+	/// Definition and number of a field. Objects are not modified once they are published.
+	/// </summary>
+	///
+	private class FieldState
+	{
+		public int  row, column, width, decimals;
+		public bool zeros, leftAligned;
+		public int  value;
+		public bool hasValue;
+
+		public bool SameDefinition(FieldState s)
+		{
+			return (s != null) &&
+			       (row == s.row) && (column == s.column) && (width == s.width) && (decimals == s.decimals) &&
+			       (zeros == s.zeros) && (leftAligned == s.leftAligned);
+		}
+
+		public FieldState Copy()
+		{
+			return (FieldState) MemberwiseClone();
+		}
+
+		public FieldState WithoutValue()
+		{
+			FieldState s = Copy();
+			s.hasValue = false;
+			return s;
+		}
+
+		/// <summary>
+		/// Formats the number like the module does.
+		/// </summary>
+		///
+		public String Format()
+		{
+			String digits = value.ToString().PadLeft(decimals + 1, '0');
+			if ( decimals > 0 )
+			{
+				digits = digits.Insert(digits.Length - decimals, ".");
+			}
+			if ( digits.Length > width ) return new String('#', width);
+			if ( leftAligned )           return digits.PadRight(width);
+			return digits.PadLeft(width, zeros ? '0' : ' ');
+		}
+	}
+
+
+	/// <summary>
+	/// Text and LED states of a screen page. Objects are not modified once they are published.
+	/// </summary>
+	///
+	private class PageState
+	{
+		public int        number;
+		public String[]   rows;
+		public LedState[] leds; // null: LED is not on the page
+
+		public PageState Copy()
+		{
+			PageState s = (PageState) MemberwiseClone();
+			s.leds = (LedState[]) leds.Clone();
+			return s;
+		}
+
+		/// <summary>
+		/// Gets the state of a LED after the page has been shown, like the module does.
+		/// </summary>
+		///
+		public LedState ApplyTo(int led, LedState s)
+		{
+			LedState entry  = leds[led];
+			LedState result = LedState.CopyOf(s);
+			result.brightness = entry.brightness;
+			result.interval   = entry.interval;
+			result.ratio      = entry.ratio;
+			result.blinkSet   = true;
+			if ( entry.colourSet )
+			{
+				result.red       = entry.red;
+				result.green     = entry.green;
+				result.blue      = entry.blue;
+				result.colourSet = true;
+			}
+			return result;
+		}
+	}
+
+
+	/// <summary>
+	/// Desired and sent text of a LCD row. Strings are immutable,
+	/// so a changed row is detected by comparing the references.
+	/// The target is null as long as the row has not been set.
+	/// </summary>
+	///
+	private class RowSlot
+	{
+		public volatile String target; // written by the game thread
+		public String          sent;   // only used by the I/O thread
+	}
+
+
+	/// <summary>
+	/// Desired and sent state of a LED.
+	/// </summary>
+	///
+	private class LedSlot
+	{
+		public volatile LedState target; // written by the game thread
+		public LedState          sent;   // only used by the I/O thread
+	}
+
+
+	/// <summary>
+	/// Desired and sent state of a number field.
+	/// The target is null as long as the field has not been defined.
+	/// </summary>
+	///
+	private class FieldSlot
+	{
+		public volatile FieldState target; // written by the game thread
+		public FieldState          sent;   // only used by the I/O thread
+	}
+
+
+	private const int    SPAN_MERGE_GAP   = 4;   // unchanged characters that are cheaper to resend than a new cursor command
+	private const int    MAX_FIELD_VALUES = 6;   // maximum number of values in one V command
+	private const String CMD_COMMIT       = "X"; // shows the back buffer of the LCD
+
+	private readonly int         lcdColumns;
+	private readonly bool        backBuffer;  // true: text changes end with CMD_COMMIT
+	private readonly RowSlot[]   rows;
+	private readonly LedSlot[]   leds;
+	private readonly FieldSlot[] fields;
+	private readonly PageState[] pages;       // written by the game thread, replaced as a whole
+	private PageState            pendingPage; // page to show (null: no page change)
+}
@@ -0,0 +1,225 @@
+using System;
+using System.IO.Ports;
+using System.Text;
+using System.Collections.Generic;
+
+/// <summary>
+/// Driver for several Arduino I/O modules, e.g., one in the cockpit and one at the instructor station.
+/// Each module gets its own ArduinoIO_Connection with its own I/O thread, command queue and mirror,
+/// so a slow or missing module does not hold up the others.
+/// All serial ports are probed at the same time by the I/O threads,
+/// ports without a module are dropped when ProcessAnswers() notices that their connection has failed.
+/// None of the methods wait for serial I/O, except Close().
+/// The ports can be pseudo-terminals of module emulators, e.g., for load tests with many modules.
+/// </summary>
+///
+public class ArduinoIO_Driver
+{
+	/// <summary>
+	/// Creates the driver. No ports are opened yet.
+	/// </summary>
+	/// <param name='speed'>
+	/// the bitrate of the serial ports
+	/// </param>
+	/// <param name='fastSpeed'>
+	/// the bitrate to negotiate with each module after connecting (0: stay at <c>speed</c>)
+	/// </param>
+	///
+	public ArduinoIO_Driver(int speed, int fastSpeed)
+	{
+		this.speed     = speed;
+		this.fastSpeed = fastSpeed;
+		connections    = new List<ArduinoIO_Connection>();
+		boxes          = new List<ArduinoIO_Connection>();
+	}
+
+
+	/// <summary>
+	/// Gives the first LCD of each module a back buffer (see ArduinoIO_Connection.SetBackBuffer()).
+	/// Applies to the ports opened afterwards.
+	/// </summary>
+	/// <param name='enable'>
+	/// <code>true</code> to use the back buffer,
+	/// <code>false</code> to show all text straight away (default)
+	/// </param>
+	///
+	public void SetBackBuffer(bool enable)
+	{
+		useBackBuffer = enable;
+	}
+
+
+	/// <summary>
+	/// Starts looking for modules on serial ports.
+	/// Ports that are already in use by the driver are skipped.
+	/// </summary>
+	/// <param name='portNames'>
+	/// the names of the serial ports (null: all serial ports of the computer)
+	/// </param>
+	///
+	public void Open(String[] portNames)
+	{
+		if ( portNames == null ) portNames = SerialPort.GetPortNames();
+		foreach ( String portName in portNames )
+		{
+			if ( FindConnection(connections, portName) != null ) continue;
+
+			ArduinoIO_Connection connection = new ArduinoIO_Connection(portName, speed, fastSpeed);
+			connection.SetBackBuffer(useBackBuffer);
+			connections.Add(connection);
+			connection.Open();
+		}
+	}
+
+
+	/// <summary>
+	/// Processes the answers of all modules and updates the list of connected modules.
+	/// This method needs to be called regularly from the game thread.
+	/// </summary>
+	///
+	public void ProcessAnswers()
+	{
+		for ( int i = connections.Count - 1 ; i >= 0 ; i-- )
+		{
+			ArduinoIO_Connection connection = connections[i];
+			connection.ProcessAnswers();
+			if ( connection.HasFailed() )
+			{
+				// no module on this port
+				connections.RemoveAt(i);
+			}
+			else if ( connection.IsConnected() && !boxes.Contains(connection) )
+			{
+				boxes.Add(connection);
+			}
+		}
+	}
+
+
+	/// <summary>
+	/// Checks if ports are still being probed.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if at least one port has not answered yet,
+	/// <code>false</code> if all modules have been found
+	/// </returns>
+	///
+	public bool IsDiscovering()
+	{
+		foreach ( ArduinoIO_Connection connection in connections )
+		{
+			if ( connection.IsConnecting() ) return true;
+		}
+		return false;
+	}
+
+
+	/// <summary>
+	/// Gets the number of connected modules.
+	/// </summary>
+	/// <returns>
+	/// the number of modules found by ProcessAnswers() so far
+	/// </returns>
+	///
+	public int GetBoxCount()
+	{
+		return boxes.Count;
+	}
+
+
+	/// <summary>
+	/// Gets a connected module, in the order in which they answered.
+	/// </summary>
+	/// <returns>
+	/// the connection to the module
+	/// </returns>
+	/// <param name='index'>
+	/// the number of the module (0 - GetBoxCount()-1)
+	/// </param>
+	///
+	public ArduinoIO_Connection GetBox(int index)
+	{
+		return boxes[index];
+	}
+
+
+	/// <summary>
+	/// Gets the connected module on a specific serial port.
+	/// </summary>
+	/// <returns>
+	/// the connection to the module or null if there is no module on the port (yet)
+	/// </returns>
+	/// <param name='portName'>
+	/// the name of the serial port
+	/// </param>
+	///
+	public ArduinoIO_Connection GetBox(String portName)
+	{
+		return FindConnection(boxes, portName);
+	}
+
+
+	/// <summary>
+	/// Gets a report with one line per connected module:
+	/// port, version, commands sent, timeouts, average round trip time
+	/// and the uncertainty and drift of the module clock.
+	/// </summary>
+	/// <returns>
+	/// the report
+	/// </returns>
+	///
+	public String GetReport()
+	{
+		StringBuilder report = new StringBuilder();
+		foreach ( ArduinoIO_Connection box in boxes )
+		{
+			ArduinoIO_Clock clock = box.GetClock();
+			report.AppendLine(box.GetPortName() + " : " + box.GetVersion() +
+			                  ", commands " + box.GetCommandCount() +
+			                  ", timeouts " + box.GetTimeoutCount() +
+			                  ", round trip " + box.GetAverageRoundTrip().ToString("F2") + " ms" +
+			                  (clock.IsSynchronised() ?
+			                   ", clock +/-" + clock.GetUncertainty().ToString("F0") + " us, drift " + clock.GetDrift().ToString("F0") + " ppm" :
+			                   ", clock not synchronised"));
+		}
+		return report.ToString();
+	}
+
+
+	/// <summary>
+	/// Sends the commands that are still queued and closes all connections.
+	/// The connections are closed at the same time,
+	/// this method blocks until all I/O threads have finished (or timeouts occured).
+	/// </summary>
+	///
+	public void Close()
+	{
+		foreach ( ArduinoIO_Connection connection in connections )
+		{
+			connection.RequestClose();
+		}
+		foreach ( ArduinoIO_Connection connection in connections )
+		{
+			connection.Close();
+		}
+		connections.Clear();
+		boxes.Clear();
+	}
+
+
+	private static ArduinoIO_Connection FindConnection(List<ArduinoIO_Connection> list, String portName)
+	{
+		foreach ( ArduinoIO_Connection connection in list )
+		{
+			if ( connection.GetPortName() == portName ) return connection;
+		}
+		return null;
+	}
+
+
+	private readonly int               speed;
+	private readonly int               fastSpeed;
+	private bool                       useBackBuffer = false; // true: LCD 0 of new connections gets a back buffer
+	private List<ArduinoIO_Connection> connections; // all ports, including the ones still being probed
+	private List<ArduinoIO_Connection> boxes;       // ports with a module, in the order they answered
+}
@@ -1,9 +1,8 @@
 
 using UnityEngine;
 using System;
-using System.IO;
-using System.IO.Ports;
 using System.Collections;
+using System.Threading;
 
 /// <summary>
 /// Class for communicating with the Arduino I/O module.
@@ -11,27 +10,35 @@ using System.Collections;
 /// 
 public class ArduinoIO_Module : MonoBehaviour
 {
-	public String modulePort  = "COM3";
-	public int    moduleSpeed = 115200;
+	public String modulePort      = "COM3";
+	public int    moduleSpeed     = 115200;
+	public int    moduleFastSpeed = 500000; // speed to negotiate after connecting (0: stay at moduleSpeed)
+	public bool   moduleBackBuffer = false; // true: text changes of one update appear at once (LCD commands need X)
 	
 	public int    hudUpdateInterval  = 500; // interval in ms for updating the HUD
 
-	public int    ledLeft     = 7;
-	public int    ledRight    = 3;
-	public int    ledLCD      = 9;
+	public String traceFile       = "";    // file for recording the serial traffic ("": no recording)
+	public String replayTraceFile = "";    // trace to replay as a benchmark instead of running the HUD ("": no benchmark)
+	public bool   replayKeepTiming = true; // true: replay with the recorded timing, false: as fast as possible
+	public int    benchmarkDisplay = -1;   // LCD to measure the settle time for several geometries instead of running the HUD (-1: no benchmark)
+
+	// LEDs and buttons, -1: taken from the description of the module (see configureFromModule())
+	public int    ledLeft     = -1;
+	public int    ledRight    = -1;
+	public int    ledLCD      = -1;
 	
 	public int    buttonPollInterval = 100; // interval in ms for polling the buttons
-	public int    buttonLeft         = 0;
-	public int    buttonRight        = 1;
+	public int    buttonLeft         = -1;
+	public int    buttonRight        = -1;
 	
 	public VehicleDataCollector    scriptVehicleData;
 	public SimulationConfiguration scriptConfiguration;
 	
-	private const String CMD_ECHO = "E";
-	
 	
 	/// <summary>
 	/// Initialisation of the Arduino IO-Box script. 
+	/// The serial port is opened by the I/O thread of the connection,
+	/// the diagnose routine starts as soon as the module has answered.
 	/// </summary>
 	/// 
 	public void Start() 
@@ -41,56 +48,66 @@ public class ArduinoIO_Module : MonoBehaviour
 		vehicleData = null;
 		speedOfSound = scriptConfiguration.GetSpeedOfSound();
 		
-		serialPort = new SerialPort(modulePort, moduleSpeed, Parity.None, 8, StopBits.One);
-		serialPort.Handshake   = Handshake.None;
-		serialPort.RtsEnable   = false;
-		serialPort.DtrEnable   = false;  // Disable DTR so NOT to reset Arduino board when connecting
-		serialPort.ReadTimeout = 250;    // longer read timeout (module might have had a reset nevertheless)
-		
-		bool success = false;
-		try
+		if ( replayTraceFile != "" )
 		{
-			serialPort.Open();
+			StartReplay();
+			return;
 		}
-		catch (IOException)
+		if ( benchmarkDisplay >= 0 )
 		{
-			serialPort = null;
+			StartDisplayBenchmark();
+			return;
 		}
 		
-		if ( (serialPort != null) && serialPort.IsOpen )
+		connection = new ArduinoIO_Connection(modulePort, moduleSpeed, moduleFastSpeed);
+		connection.SetBackBuffer(moduleBackBuffer);
+		if ( traceFile != "" )
 		{
-			int repeats = 8; // try several times to connect
-			while ( (repeats-- > 0) && !success )
-			{
-				// send the ECHO command
-				serialPort.WriteLine(CMD_ECHO);
-				try
-				{
-					String serialNo = serialPort.ReadLine();
-					if ( serialNo.Length > 1 )
-					{
-						Debug.Log ("Opened serial port " + modulePort + " to Arduino IO (Version: " + serialNo + ")");
-						success  = true;
-						serialPort.ReadTimeout = 50; // from now on, shorter response times, please
-					    StartCoroutine(RunDiagnose());
-					}
-				}
-				catch (TimeoutException)
-				{
-					// ignore
-				}
-			}
+			trace = new ArduinoIO_Trace();
+			connection.SetTrace(trace);
 		}
-		
-		if ( !success )
-		{
-			Debug.LogError("Could not open serial port " + modulePort + " to the Arduino IO module.");
-			if ( serialPort != null )
+		connection.Open();
+	}
+	
+	
+	/// <summary>
+	/// Starts the replay benchmark on a separate thread.
+	/// The report is logged when the benchmark has finished.
+	/// </summary>
+	/// 
+	private void StartReplay()
+	{
+		ArduinoIO_Trace       replayTrace = ArduinoIO_Trace.Load(replayTraceFile);
+		ArduinoIO_TraceReplay replay      = new ArduinoIO_TraceReplay(modulePort, moduleSpeed, moduleFastSpeed);
+		bool                  keepTiming  = replayKeepTiming;
+		Debug.Log("Replaying trace " + replayTraceFile + " (" + replayTrace.GetEntries().Count + " entries)");
+		replayThread = new Thread(new ThreadStart(
+			delegate()
 			{
-				serialPort.Close();
-				serialPort = null;
-			}
-		}
+				replayReport = replay.Run(replayTrace, keepTiming);
+			}));
+		replayThread.IsBackground = true;
+		replayThread.Start();
+	}
+
+	
+	/// <summary>
+	/// Starts the LCD settle time benchmark on a separate thread.
+	/// The report is logged when the benchmark has finished.
+	/// </summary>
+	/// 
+	private void StartDisplayBenchmark()
+	{
+		ArduinoIO_TraceReplay benchmark = new ArduinoIO_TraceReplay(modulePort, moduleSpeed, moduleFastSpeed);
+		int                   display   = benchmarkDisplay;
+		Debug.Log("Measuring the LCD settle time of display " + display);
+		replayThread = new Thread(new ThreadStart(
+			delegate()
+			{
+				replayReport = benchmark.RunDisplayBenchmark(display);
+			}));
+		replayThread.IsBackground = true;
+		replayThread.Start();
 	}
 
 	
@@ -110,8 +127,8 @@ public class ArduinoIO_Module : MonoBehaviour
 		setText(1, "                ");	
 		yield return new WaitForSeconds(stepWait);
 		
-		getButtonPresses(buttonLeft); // clear button presses
-		getButtonPresses(buttonRight);
+		requestButtonPresses(buttonLeft); // clear button presses
+		requestButtonPresses(buttonRight);
 		
 		setLed(ledLeft, 100, 0, 0);       setLed(ledRight, 100, 0, 0);
 		setLedColour(ledLeft, Color.red); setLedColour(ledRight, Color.red);
@@ -146,6 +163,8 @@ public class ArduinoIO_Module : MonoBehaviour
 		yield return new WaitForSeconds(stepWait);
 		setLed(ledLeft, 0); setLed(ledRight, 0);
 		
+		buttonPressesLeft  = 0;
+		buttonPressesRight = 0;
 		hudPage = HudPage.STANDBY;
 	}
 	
@@ -160,7 +179,7 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	public bool IsConnected()
 	{
-		return (serialPort != null);	
+		return (connection != null) && connection.IsConnected();	
 	}	
 			
 
@@ -170,6 +189,11 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	public void OnDestroy()
 	{
+		if ( replayThread != null )
+		{
+			replayThread.Join();
+			replayThread = null;
+		}
 		if ( IsConnected() )
 		{
 			// turn off LEDs and clear display
@@ -177,11 +201,20 @@ public class ArduinoIO_Module : MonoBehaviour
 			setLed(ledRight, 0, 0, 0);
 			setLed(ledLCD, 0, 0, 0);
 			clearText();
-			
-			serialPort.Close();
-			serialPort = null;
+		}
+		String version = (connection != null) ? connection.GetVersion() : "";
+		if ( connection != null )
+		{
+			// sends the remaining commands before closing
+			connection.Close();
+			connection = null;
 			// Debug.Log ("Serial port " + modulePort + " closed.");
 		}
+		if ( trace != null )
+		{
+			trace.Save(traceFile, "Arduino IO trace, " + version + ", " + modulePort);
+			trace = null;
+		}
 	}
 	
 	
@@ -191,7 +224,24 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	public void Update() 
 	{
+		if ( replayReport != null )
+		{
+			Debug.Log("Benchmark finished:\n" + replayReport);
+			replayReport = null;
+		}
+		if ( connection == null ) return;
+		
+		// handle answers and errors that the I/O thread has received
+		connection.ProcessAnswers();
+		
 		if ( !IsConnected() || !scriptVehicleData ) return;
+		if ( !diagnoseStarted )
+		{
+			diagnoseStarted = true;
+			configureFromModule();
+			definePages(); // uploaded while the diagnose routine runs
+			StartCoroutine(RunDiagnose());
+		}
 		if ( hudPage < HudPage.STANDBY ) return;
 		
 		checkVehicleState();
@@ -248,34 +298,39 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void checkButtons()
 	{
-		if ( IsConnected() && (Time.time > nextButtonPollTime) )
+		if ( IsConnected() && (Time.time > nextButtonPollTime) && (buttonRequestsPending == 0) )
 		{
-			// poll the buttons and switch the HUD accordingly
-			HudPage newPage = hudPage;
-			if ( getButtonPresses(buttonLeft)  > 0 ) newPage--;
-			if ( getButtonPresses(buttonRight) > 0 ) newPage++;
-			
-			// if vehicle starts to move: switch to speed page automatically
-			if ( (vehicleData.speed > 0.1) && (hudPage == HudPage.STANDBY) )
+			// poll the buttons, the answers arrive in one of the next frames
+			requestButtonPresses(buttonLeft);
+			requestButtonPresses(buttonRight);
+			nextButtonPollTime = Time.time + (buttonPollInterval / 1000.0);
+		}
+		
+		// switch the HUD according to the button presses received so far
+		HudPage newPage = hudPage;
+		if ( buttonPressesLeft  > 0 ) newPage--;
+		if ( buttonPressesRight > 0 ) newPage++;
+		buttonPressesLeft  = 0;
+		buttonPressesRight = 0;
+		
+		// if vehicle starts to move: switch to speed page automatically
+		if ( (vehicleData.speed > 0.1) && (hudPage == HudPage.STANDBY) )
+		{
+			newPage = HudPage.SPEED;
+		}
+		
+		if ( newPage != hudPage )
+		{
+			// page has changed: stay within "selectable" range
+			if ( newPage <= HudPage.FIRST_SELECTABLE ) 
 			{
-				newPage = HudPage.SPEED;
+				newPage = HudPage.LAST_SELECTABLE - 1;
 			}
-			
-			if ( newPage != hudPage )
+			if ( newPage >= HudPage.LAST_SELECTABLE ) 
 			{
-				// page has changed: stay within "selectable" range
-				if ( newPage <= HudPage.FIRST_SELECTABLE ) 
-				{
-					newPage = HudPage.LAST_SELECTABLE - 1;
-				}
-				if ( newPage >= HudPage.LAST_SELECTABLE ) 
-				{
-					newPage = HudPage.FIRST_SELECTABLE + 1;
-				}
-				changeHudPage(newPage);
+				newPage = HudPage.FIRST_SELECTABLE + 1;
 			}
-			
-			nextButtonPollTime = Time.time + (buttonPollInterval / 1000.0);
+			changeHudPage(newPage);
 		}
 	}
 	
@@ -291,41 +346,25 @@ public class ArduinoIO_Module : MonoBehaviour
 	{
 		if ( page != hudPage )
 		{
-			clearText();
+			// text and backlight are stored on the module (see definePages())
+			showPage(page);
 			switch ( page )
 			{
 				case HudPage.SPEED:
 				{
-					setLedColour(ledLCD, Color.white); 
-					setLed(ledLCD, 99, 0, 0);
-					setText(0, "Speed: 0000 km/h");
-					setText(1, "       0.00 mach");
+					defineField(0, 0, 7, 4, 0);
+					defineField(1, 1, 7, 4, 2);
 					break;
 				}
 				case HudPage.THRUST:
 				{
-					setLedColour(ledLCD, Color.white); 
-					setLed(ledLCD, 99, 0, 0);
-					setText(0, "Thrust E1: 000%");
-					setText(1, "       E2: 000%");
+					defineField(0, 0, 11, 3, 0);
 					break;
 				}
 				case HudPage.FUEL:
 				{
-					setLedColour(ledLCD, Color.white); 
-					setLed(ledLCD, 99, 0, 0);
-					setText(0, "Fuel E1: 000%");
-					setText(1, "     E2: 000%");
-					break;
-				}
-				case HudPage.ABORT:
-				{
-					// make background LED blink in red
-					setLedColour(ledLCD, Color.red); 
-					setLed (9, 99, 500, 50);
-					// write text
-					setText(0, "!!!! ABORT !!!! ");
-					setText(1, "!!!! ABORT !!!! ");
+					defineField(0, 0, 9, 3, 0);
+					defineField(1, 1, 9, 3, 0);
 					break;
 				}
 			}
@@ -338,6 +377,86 @@ public class ArduinoIO_Module : MonoBehaviour
 	}
 	
 	
+	/// <summary>
+	/// Assigns the LEDs and buttons that have not been set in the inspector,
+	/// according to the description of the module:
+	/// the backlight of the first LCD, the two multicolour LEDs (right, then left) and the first two buttons.
+	/// </summary>
+	/// 
+	private void configureFromModule()
+	{
+		ArduinoIO_Capabilities caps = connection.GetCapabilities();
+		if ( ledLCD   < 0 ) ledLCD   = caps.FindLed(ArduinoIO_Capabilities.LED_BACKLIGHT,   0);
+		if ( ledRight < 0 ) ledRight = caps.FindLed(ArduinoIO_Capabilities.LED_MULTICOLOUR, 0);
+		if ( ledLeft  < 0 ) ledLeft  = caps.FindLed(ArduinoIO_Capabilities.LED_MULTICOLOUR, 1);
+		if ( (buttonLeft  < 0) && (caps.GetButtonCount() > 0) ) buttonLeft  = 0;
+		if ( (buttonRight < 0) && (caps.GetButtonCount() > 1) ) buttonRight = 1;
+		// older modules get the text of the pages and the numbers as text
+		usePages  = caps.GetPageCount()  > getModulePage(HudPage.ABORT);
+		useFields = caps.GetFieldCount() >= FIELD_COUNT;
+		Debug.Log("Arduino IO box: " + caps.GetDisplayCount() + " LCD(s), LEDs left/right/LCD " +
+		          ledLeft + "/" + ledRight + "/" + ledLCD + ", buttons left/right " + buttonLeft + "/" + buttonRight +
+		          (usePages ? ", pages" : "") + (useFields ? ", number fields" : ""));
+	}
+	
+	
+	/// <summary>
+	/// Uploads the text and backlight of the HUD pages to the module.
+	/// The module keeps the pages in its EEPROM, so a page change only needs one short command.
+	/// Modules without screen pages get the text with each page change instead (see showPage()).
+	/// </summary>
+	/// 
+	private void definePages()
+	{
+		if ( !usePages ) return;
+		foreach ( HudPage page in HUD_PAGES )
+		{
+			int   interval;
+			Color colour;
+			String[] text = getPageContent(page, out interval, out colour);
+			definePage(page, text[0], text[1]);
+			definePageLed(page, ledLCD, 99, interval, (interval > 0) ? 50 : 0, colour);
+		}
+	}
+	
+	
+	/// <summary>
+	/// Gets the text and the backlight of a HUD page.
+	/// </summary>
+	/// <returns>
+	/// the text of the top and the bottom line, or null if the HUD page has no text
+	/// </returns>
+	/// <param name='page'>
+	/// the HUD page
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval of the backlight in milliseconds (0: no blinking)
+	/// </param>
+	/// <param name='colour'>
+	/// the colour of the backlight
+	/// </param>
+	/// 
+	private static String[] getPageContent(HudPage page, out int interval, out Color colour)
+	{
+		interval = 0;
+		colour   = Color.white;
+		switch ( page )
+		{
+			case HudPage.SPEED:  return new String[] { "Speed: 0000 km/h", "       0.00 mach" };
+			case HudPage.THRUST: return new String[] { "Thrust E1: 000% ", "       E2: 000% " };
+			case HudPage.FUEL:   return new String[] { "Fuel E1: 000%   ", "     E2: 000%   " };
+			case HudPage.ABORT:
+			{
+				// make background LED blink in red
+				interval = 500;
+				colour   = Color.red;
+				return new String[] { "!!!! ABORT !!!! ", "!!!! ABORT !!!! " };
+			}
+			default: return null;
+		}
+	}
+	
+	
 	/// <summary>
 	/// Updates the data on the HUD.
 	/// </summary>
@@ -351,20 +470,17 @@ public class ArduinoIO_Module : MonoBehaviour
 				case HudPage.SPEED:
 				{
 					double speedKmH = vehicleData.speed * 3.6;
-					String speed = speedKmH.ToString("0000");
-					setText(0, 7, speed);
+					setField(0, speedKmH);
 					double speedMach = vehicleData.speed / speedOfSound;
-					speed = speedMach.ToString("0.00");
-					setText(1, 7, speed);
+					setField(1, speedMach * 100.0);
 					break;
 				}
 				case HudPage.THRUST:
 				{
 					double thrustPercent = vehicleData.engine1Thrust * 100.0;
-					String thrust = thrustPercent.ToString("000");
-					setText(0, 11, thrust);
+					setField(0, thrustPercent);
 				    thrustPercent = vehicleData.engine2Thrust * 100.0;
-					thrust = thrustPercent.ToString("000") + "% ";
+					String thrust = thrustPercent.ToString("000") + "% ";
 				    switch ( vehicleData.engine2State )
 					{
 						case AuxiliaryThrusterControl.State.STANDBY:  thrust = "stby"; break;
@@ -379,11 +495,9 @@ public class ArduinoIO_Module : MonoBehaviour
 				case HudPage.FUEL:
 				{
 				    double fuelPercent = vehicleData.engine1FuelLevel * 100.0;
-					String fuel = fuelPercent.ToString("000");
-					setText(0, 9, fuel);
+					setField(0, fuelPercent);
 				    fuelPercent = vehicleData.engine2FuelLevel * 100.0;
-					fuel = fuelPercent.ToString("000");
-					setText(1, 9, fuel);
+					setField(1, fuelPercent);
 					break;
 				}
 			}
@@ -404,7 +518,7 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void setLed(int led, int brightness)
 	{
-		sendCommand("L" + led + "," + brightness);
+		if ( connection != null ) connection.SetLed(led, brightness);
 	}
 
 	/// <summary>
@@ -425,7 +539,7 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void setLed(int led, int brightness, int interval, int ratio)
 	{
-		sendCommand("L" + led + "," + brightness + "," + interval + "," + ratio);
+		if ( connection != null ) connection.SetLed(led, brightness, interval, ratio);
 	}
 	
 	/// <summary>
@@ -440,10 +554,10 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void setLedColour(int led, Color colour)
 	{
-		sendCommand("M" + led + 
-			        "," + (int) (colour.r * 100) + 
-			        "," + (int) (colour.g * 100) + 
-			        "," + (int) (colour.b * 100));
+		if ( connection != null ) connection.SetLedColour(led, 
+			(int) (colour.r * 100), 
+			(int) (colour.g * 100), 
+			(int) (colour.b * 100));
 	}
 	
 	/// <summary>
@@ -458,8 +572,7 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void setText(int line, String text)
 	{
-		sendCommand("P" + line);
-		sendCommand("T\"" + text + "\""); 
+		setText(line, 0, text);
 	}
 	
 	/// <summary>
@@ -477,101 +590,186 @@ public class ArduinoIO_Module : MonoBehaviour
 	/// 
 	private void setText(int line, int column, String text)
 	{
-		sendCommand("P" + line + "," + column);
-		sendCommand("T\"" + text + "\""); 
+		if ( connection != null ) connection.SetText(line, column, text);
 	}
 	
 	/// <summary>
-	/// Clears the text.
+	/// Gets the number of the page on the module for a HUD page.
 	/// </summary>
 	/// 
-	private void clearText()
+	private int getModulePage(HudPage page)
 	{
-		sendCommand("C");
+		return (int) page - (int) HudPage.SPEED;
 	}
 	
 	/// <summary>
-	/// Gets the number of button presses.
+	/// Uploads the text of a HUD page to the module.
 	/// </summary>
-	/// <returns>
-	/// the number of button presses since the last poll
-	/// </returns>
-	/// <param name='button'>
-	/// the number of the button
+	/// <param name='page'>
+	/// the HUD page
+	/// </param>
+	/// <param name='line0'>
+	/// the text of the top line
+	/// </param>
+	/// <param name='line1'>
+	/// the text of the bottom line
 	/// </param>
 	/// 
-	private int getButtonPresses(int button)
+	private void definePage(HudPage page, String line0, String line1)
 	{
-		int numPresses = 0;
-		String answer = sendRequest("b" + button);
-		if ( answer.Length == 2 )
+		if ( connection != null ) connection.DefinePage(getModulePage(page), new String[] { line0, line1 });
+	}
+	
+	/// <summary>
+	/// Uploads the state of a LED on a HUD page to the module.
+	/// </summary>
+	/// <param name='page'>
+	/// the HUD page
+	/// </param>
+	/// <param name='led'>
+	/// the number of the LED
+	/// </param>
+	/// <param name='brightness'>
+	/// the brightness of the LED (0-99)
+	/// </param>
+	/// <param name='interval'>
+	/// the blink interval in milliseconds
+	/// </param>
+	/// <param name='ratio'>
+	/// the blink ratio in percent
+	/// </param>
+	/// <param name='colour'>
+	/// the colour of the LED
+	/// </param>
+	/// 
+	private void definePageLed(HudPage page, int led, int brightness, int interval, int ratio, Color colour)
+	{
+		if ( (connection != null) && (led >= 0) ) connection.DefinePageLed(getModulePage(page), led, brightness, interval, ratio,
+			(int) (colour.r * 100), 
+			(int) (colour.g * 100), 
+			(int) (colour.b * 100));
+	}
+	
+	/// <summary>
+	/// Shows a HUD page that has been uploaded to the module,
+	/// or sends the text and backlight of the page if the module has no screen pages.
+	/// </summary>
+	/// <param name='page'>
+	/// the HUD page
+	/// </param>
+	/// 
+	private void showPage(HudPage page)
+	{
+		if ( connection == null ) return;
+		if ( usePages )
 		{
-			numPresses = (int) (answer[1] - '0');
+			connection.ShowPage(getModulePage(page));
+			return;
 		}
-		return numPresses;
+		
+		int   interval;
+		Color colour;
+		String[] text = getPageContent(page, out interval, out colour);
+		if ( text == null ) return;
+		setLedColour(ledLCD, colour);
+		setLed(ledLCD, 99, interval, (interval > 0) ? 50 : 0);
+		setText(0, text[0]);
+		setText(1, text[1]);
 	}
 	
 	/// <summary>
-	/// Sends a command and waits for the acknowledge char.
+	/// Defines a right aligned number field with leading zeros.
 	/// </summary>
-	/// <param name='command'>
-	/// the command to send
+	/// <param name='field'>
+	/// the number of the field
+	/// </param>
+	/// <param name='line'>
+	/// the line of the field
+	/// </param>
+	/// <param name='column'>
+	/// the first column of the field
+	/// </param>
+	/// <param name='width'>
+	/// the number of characters of the field
+	/// </param>
+	/// <param name='decimals'>
+	/// the number of decimal places
 	/// </param>
 	/// 
-	private void sendCommand(String command)
+	private void defineField(int field, int line, int column, int width, int decimals)
 	{
-		if ( IsConnected() )
+		if ( useFields )
 		{
-			// Debug.Log("send: " + command);
-			serialPort.DiscardInBuffer();
-			serialPort.WriteLine(command);
-			try
-			{
-				String response = serialPort.ReadLine();
-				if ( response != "+" )
-				{
-					Debug.LogError("Arduino IO box error for command " + command + ": " + response);
-				}
-			}
-			catch (TimeoutException)
-			{
-				Debug.LogError("Arduino IO box timeout for command " + command);
-			}
+			if ( connection != null ) connection.DefineField(field, line, column, width, decimals, true, false);
+			return;
 		}
+		
+		// modules without number fields: the numbers are formatted here (see setField())
+		fieldLine[field]   = line;
+		fieldColumn[field] = column;
+		fieldFormat[field] = new String('0', (decimals > 0) ? width - decimals - 1 : width) +
+		                     ((decimals > 0) ? "." + new String('0', decimals) : "");
+		fieldScale[field]  = Math.Pow(10, decimals);
 	}
 	
 	/// <summary>
-	/// Sends a command and waits for an answer.
+	/// Sets the number of a field. The module formats the number.
 	/// </summary>
-	/// <returns>
-	/// The answer of the request or "" if a timeout occured
-	/// </returns>
-	/// <param name='command'>
-	/// the command to send
+	/// <param name='field'>
+	/// the number of the field
+	/// </param>
+	/// <param name='value'>
+	/// the number, multiplied by 10 to the power of the decimal places of the field
 	/// </param>
 	/// 
-	private String sendRequest(String command)
+	private void setField(int field, double value)
 	{
-		String answer = "";
-		if ( IsConnected() )
+		if ( useFields )
 		{
-			// Debug.Log("send: " + command);
-			serialPort.DiscardInBuffer();
-			serialPort.WriteLine(command);
-			try
-			{
-				answer = serialPort.ReadLine();
-				if ( answer == "!" )
-				{
-					Debug.LogError("Arduino IO box error for request " + command);
-				}
-			}
-			catch (TimeoutException)
-			{
-				Debug.LogError("Arduino IO box timeout for request " + command);
-			}
+			if ( connection != null ) connection.SetField(field, (int) Math.Round(value));
+		}
+		else if ( fieldFormat[field] != null )
+		{
+			setText(fieldLine[field], fieldColumn[field], (Math.Round(value) / fieldScale[field]).ToString(fieldFormat[field]));
+		}
+	}
+	
+	/// <summary>
+	/// Clears the text.
+	/// </summary>
+	/// 
+	private void clearText()
+	{
+		if ( connection != null ) connection.ClearText();
+	}
+	
+	/// <summary>
+	/// Requests the number of button presses.
+	/// The presses are added to buttonPressesLeft/buttonPressesRight when the answer arrives.
+	/// </summary>
+	/// <param name='button'>
+	/// the number of the button
+	/// </param>
+	/// 
+	private void requestButtonPresses(int button)
+	{
+		if ( button < 0 ) return; // module has no such button
+		bool isLeft = (button == buttonLeft);
+		if ( connection.SendRequest("b" + button, 
+		         delegate(String command, String answer)
+		         {
+		             buttonRequestsPending--;
+		             int numPresses = 0;
+		             if ( answer.Length == 2 )
+		             {
+		                 numPresses = (int) (answer[1] - '0');
+		             }
+		             if ( isLeft ) buttonPressesLeft  += numPresses;
+		             else          buttonPressesRight += numPresses;
+		         }) )
+		{
+			buttonRequestsPending++;
 		}
-		return answer;
 	}
 	
 	
@@ -586,13 +784,34 @@ public class ArduinoIO_Module : MonoBehaviour
 		ABORT
 	};
 	
-	private SerialPort                 serialPort  = null;
+	private ArduinoIO_Connection       connection  = null;
+	private ArduinoIO_Trace            trace       = null; // recording of the session (if traceFile is set)
+	private Thread                     replayThread = null;
+	private volatile String            replayReport = null; // report of the finished replay benchmark
 	private VehicleData                vehicleData = null;
 	private VehicleSafetyControl.State oldState;
 		
 	private double   nextHudUpdateTime  = 0;
 	private double   nextButtonPollTime = 0;
 	private HudPage  hudPage            = HudPage.DIAGNOSE;
+	private bool     diagnoseStarted    = false;
+	
+	private int      buttonPressesLeft     = 0; // button presses received from the module
+	private int      buttonPressesRight    = 0;
+	private int      buttonRequestsPending = 0; // button requests without answer so far
 	
 	private double   speedOfSound;
+	
+	private bool     usePages  = false; // true: the HUD pages are stored on the module
+	private bool     useFields = false; // true: the module formats the numbers
+	
+	// number fields of modules without the F command (see defineField())
+	private const int FIELD_COUNT = 2;
+	private int[]    fieldLine   = new int[FIELD_COUNT];
+	private int[]    fieldColumn = new int[FIELD_COUNT];
+	private String[] fieldFormat = new String[FIELD_COUNT]; // null: field not defined
+	private double[] fieldScale  = new double[FIELD_COUNT];
+	
+	// HUD pages with text
+	private static readonly HudPage[] HUD_PAGES = { HudPage.SPEED, HudPage.THRUST, HudPage.FUEL, HudPage.ABORT };
 }
@@ -0,0 +1,177 @@
+using System;
+using System.IO;
+using System.IO.Ports;
+using System.Threading;
+
+/// <summary>
+/// Serial speed changes of an Arduino I/O module (B command),
+/// used by ArduinoIO_Connection and ArduinoIO_TraceReplay.
+/// The module keeps a confirmed speed until it is reset, and the host does not reset it
+/// when opening the port (DTR is disabled). So the side that has switched the module to a faster speed
+/// switches it back to the default speed before closing the port (see Restore()).
+/// If that did not happen (e.g., the host program crashed), the module is found by trying
+/// the faster speeds as well (see GetProbeSpeeds()).
+/// </summary>
+///
+public static class ArduinoIO_SerialSpeed
+{
+	/// <summary>
+	/// Gets the speeds to try when the module does not answer at its default speed.
+	/// </summary>
+	/// <returns>
+	/// the speeds that the module supports above <c>speed</c>, up to <c>fastSpeed</c>, fastest first
+	/// </returns>
+	/// <param name='speed'>
+	/// the default speed of the module
+	/// </param>
+	/// <param name='fastSpeed'>
+	/// the fastest speed the host ever switches to
+	/// </param>
+	///
+	public static int[] GetProbeSpeeds(int speed, int fastSpeed)
+	{
+		int count = 0;
+		int[] speeds = new int[MODULE_SPEEDS.Length];
+		for ( int i = MODULE_SPEEDS.Length - 1 ; i >= 0 ; i-- )
+		{
+			if ( (MODULE_SPEEDS[i] > speed) && (MODULE_SPEEDS[i] <= fastSpeed) )
+			{
+				speeds[count++] = MODULE_SPEEDS[i];
+			}
+		}
+		Array.Resize(ref speeds, count);
+		return speeds;
+	}
+
+
+	/// <summary>
+	/// Switches the module and the serial port to a new speed.
+	/// The module falls back to its default speed if it does not receive a command at the new speed in time.
+	/// If the module does not answer at the new speed, both sides fall back to the default speed.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the new speed is used,
+	/// <code>false</code> if the default speed is used
+	/// </returns>
+	/// <param name='port'>
+	/// the open serial port
+	/// </param>
+	/// <param name='speed'>
+	/// the default speed of the module
+	/// </param>
+	/// <param name='newSpeed'>
+	/// the speed to switch to
+	/// </param>
+	/// <param name='version'>
+	/// the answer of the module to the E command
+	/// </param>
+	/// <param name='trace'>
+	/// the trace to record the commands and answers into (null: no recording)
+	/// </param>
+	///
+	public static bool Negotiate(SerialPort port, int speed, int newSpeed, String version, ArduinoIO_Trace trace)
+	{
+		// propose the new speed (modules without support answer with "?")
+		if ( ReadAnswer(port, CMD_SPEED + newSpeed, trace) != "+" ) return false;
+
+		// module switches after sending the answer: follow
+		Thread.Sleep(SPEED_SWITCH_WAIT);
+		port.BaudRate = newSpeed;
+		if ( ReadAnswer(port, CMD_ECHO, trace) == version )
+		{
+			return true; // the echo command has confirmed the new speed
+		}
+
+		// no answer: wait until the module has fallen back to the default speed
+		port.BaudRate = speed;
+		Thread.Sleep(SPEED_VERIFY_TIME);
+		if ( ReadAnswer(port, CMD_ECHO, trace) == version ) return false;
+
+		// no answer at the default speed either: the echo must have confirmed the new speed
+		port.BaudRate = newSpeed;
+		if ( ReadAnswer(port, CMD_ECHO, trace) == version ) return true;
+
+		port.BaudRate = speed;
+		return false;
+	}
+
+
+	/// <summary>
+	/// Switches the module and the serial port back to the default speed, e.g., before closing the port.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the module has confirmed the default speed,
+	/// <code>false</code> if not
+	/// </returns>
+	/// <param name='port'>
+	/// the open serial port
+	/// </param>
+	/// <param name='speed'>
+	/// the default speed of the module
+	/// </param>
+	/// <param name='version'>
+	/// the answer of the module to the E command
+	/// </param>
+	/// <param name='trace'>
+	/// the trace to record the commands and answers into (null: no recording)
+	/// </param>
+	///
+	public static bool Restore(SerialPort port, int speed, String version, ArduinoIO_Trace trace)
+	{
+		if ( port.BaudRate == speed ) return true;
+
+		// without the confirmation, the module also falls back to the default speed after a second
+		bool accepted = (ReadAnswer(port, CMD_SPEED + speed, trace) == "+");
+		Thread.Sleep(SPEED_SWITCH_WAIT);
+		port.BaudRate = speed;
+		return accepted && (ReadAnswer(port, CMD_ECHO, trace) == version);
+	}
+
+
+	/// <summary>
+	/// Sends a command and reads the answer line.
+	/// </summary>
+	/// <returns>
+	/// the answer or "" in case of a timeout
+	/// </returns>
+	/// <param name='port'>
+	/// the open serial port
+	/// </param>
+	/// <param name='command'>
+	/// the command to send
+	/// </param>
+	/// <param name='trace'>
+	/// the trace to record the command and the answer into (null: no recording)
+	/// </param>
+	///
+	public static String ReadAnswer(SerialPort port, String command, ArduinoIO_Trace trace)
+	{
+		String answer = "";
+		try
+		{
+			port.DiscardInBuffer();
+			if ( trace != null ) trace.Record(true, command);
+			port.WriteLine(command);
+			answer = port.ReadLine();
+		}
+		catch (TimeoutException)
+		{
+			// answer stays empty
+		}
+		catch (IOException)
+		{
+			// answer stays empty
+		}
+		if ( trace != null ) trace.Record(false, answer);
+		return answer;
+	}
+
+
+	private const String CMD_ECHO          = "E";
+	private const String CMD_SPEED         = "B";
+	private const int    SPEED_SWITCH_WAIT = 20;   // time in ms for the module to switch to a new speed
+	private const int    SPEED_VERIFY_TIME = 1100; // time in ms after which the module falls back to the default speed
+
+	// speeds that the module supports (see arrSerialSpeeds in the sketch)
+	private static readonly int[] MODULE_SPEEDS = { 115200, 250000, 500000, 1000000 };
+}
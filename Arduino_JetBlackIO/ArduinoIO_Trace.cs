@@ -0,0 +1,144 @@
+
+using System;
+using System.IO;
+using System.Globalization;
+using System.Collections.Generic;
+
+/// <summary>
+/// Recording of the serial traffic between the host and the Arduino I/O module.
+/// A trace file contains one line per command or answer:
+/// the time in milliseconds since the start of the recording,
+/// the direction ('&gt;' to the module, '&lt;' from the module) and the text, e.g.
+/// <code>
+/// 1250.125 &gt; T"Speed: 0000 km/h"
+/// 1253.870 &lt; +
+/// </code>
+/// Lines starting with '#' are comments.
+/// </summary>
+///
+public class ArduinoIO_Trace
+{
+	/// <summary>
+	/// A single command or answer.
+	/// </summary>
+	///
+	public class Entry
+	{
+		public double time;     // time in ms since the start of the recording
+		public bool   toModule; // true: command to the module, false: answer from the module
+		public String text;
+	}
+
+
+	/// <summary>
+	/// Creates an empty trace. The recording time starts now.
+	/// </summary>
+	///
+	public ArduinoIO_Trace()
+	{
+		entries = new List<Entry>();
+		clock   = System.Diagnostics.Stopwatch.StartNew();
+	}
+
+
+	/// <summary>
+	/// Adds a command or answer to the trace, using the current time.
+	/// </summary>
+	/// <param name='toModule'>
+	/// <code>true</code> for a command to the module,
+	/// <code>false</code> for an answer from the module
+	/// </param>
+	/// <param name='text'>
+	/// the text of the command or answer (without line terminator)
+	/// </param>
+	///
+	public void Record(bool toModule, String text)
+	{
+		Entry e    = new Entry();
+		e.time     = clock.Elapsed.TotalMilliseconds;
+		e.toModule = toModule;
+		e.text     = text;
+		lock ( entries )
+		{
+			entries.Add(e);
+		}
+	}
+
+
+	/// <summary>
+	/// Gets the recorded commands and answers.
+	/// </summary>
+	/// <returns>
+	/// the list of entries, ordered by time
+	/// </returns>
+	///
+	public List<Entry> GetEntries()
+	{
+		return entries;
+	}
+
+
+	/// <summary>
+	/// Writes the trace to a file.
+	/// </summary>
+	/// <param name='fileName'>
+	/// the name of the file to write
+	/// </param>
+	/// <param name='comment'>
+	/// a comment for the first line of the file (e.g., the module version)
+	/// </param>
+	///
+	public void Save(String fileName, String comment)
+	{
+		using ( StreamWriter writer = new StreamWriter(fileName) )
+		{
+			writer.WriteLine("# " + comment);
+			lock ( entries )
+			{
+				foreach ( Entry e in entries )
+				{
+					writer.WriteLine(e.time.ToString("0.000", CultureInfo.InvariantCulture) +
+					                 (e.toModule ? " > " : " < ") + e.text);
+				}
+			}
+		}
+	}
+
+
+	/// <summary>
+	/// Reads a trace from a file.
+	/// </summary>
+	/// <returns>
+	/// the trace
+	/// </returns>
+	/// <param name='fileName'>
+	/// the name of the file to read
+	/// </param>
+	///
+	public static ArduinoIO_Trace Load(String fileName)
+	{
+		ArduinoIO_Trace trace = new ArduinoIO_Trace();
+		using ( StreamReader reader = new StreamReader(fileName) )
+		{
+			String line;
+			while ( (line = reader.ReadLine()) != null )
+			{
+				if ( (line.Length == 0) || (line[0] == '#') ) continue;
+
+				// format: time, space, direction, space, text
+				int sep = line.IndexOf(' ');
+				if ( (sep < 0) || (sep + 1 >= line.Length) ) continue;
+				Entry e    = new Entry();
+				e.time     = double.Parse(line.Substring(0, sep), CultureInfo.InvariantCulture);
+				e.toModule = (line[sep + 1] == '>');
+				e.text     = (sep + 3 <= line.Length) ? line.Substring(sep + 3) : "";
+				trace.entries.Add(e);
+			}
+		}
+		return trace;
+	}
+
+
+	private readonly List<Entry>                  entries;
+	private readonly System.Diagnostics.Stopwatch clock;
+}
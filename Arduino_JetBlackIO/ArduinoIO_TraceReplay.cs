@@ -0,0 +1,453 @@
+
+using System;
+using System.IO;
+using System.IO.Ports;
+using System.Text;
+using System.Threading;
+using System.Globalization;
+using System.Collections.Generic;
+
+/// <summary>
+/// Benchmark that replays a recorded trace (see ArduinoIO_Trace) to an Arduino I/O module
+/// and measures the throughput and the latency of the answers.
+/// At the end, the statistics and latency histograms of the module itself are read
+/// (commands S and H, which include the time until the LCD shows the new text).
+/// The module can be a real box or an emulator on a virtual serial port.
+/// The LCD settle time for different display geometries can be measured with RunDisplayBenchmark().
+/// The serial speed is switched with ArduinoIO_SerialSpeed, like the connection does,
+/// and the module is switched back to the original speed at the end.
+/// </summary>
+///
+public class ArduinoIO_TraceReplay
+{
+	/// <summary>
+	/// Creates a replay benchmark for a serial port.
+	/// </summary>
+	/// <param name='portName'>
+	/// the name of the serial port
+	/// </param>
+	/// <param name='speed'>
+	/// the bitrate of the serial port
+	/// </param>
+	/// <param name='fastSpeed'>
+	/// the bitrate to switch to before replaying (0: stay at <c>speed</c>)
+	/// </param>
+	///
+	public ArduinoIO_TraceReplay(String portName, int speed, int fastSpeed)
+	{
+		this.portName  = portName;
+		this.speed     = speed;
+		this.fastSpeed = fastSpeed;
+	}
+
+
+	/// <summary>
+	/// Replays the commands of a trace and waits for each answer.
+	/// Speed changes (B commands) in the trace are skipped.
+	/// Commands with an execution time get a new time that is as far ahead of the module clock
+	/// as the recorded one was. The module clock during the recording is known from the recorded
+	/// time requests (Y commands), the current module clock from the replayed ones.
+	/// Answers that change over time (e.g., statistics or the clock) are not compared with the trace.
+	/// </summary>
+	/// <returns>
+	/// the benchmark report (several lines)
+	/// </returns>
+	/// <param name='trace'>
+	/// the trace to replay
+	/// </param>
+	/// <param name='keepTiming'>
+	/// <code>true</code>: send the commands at the recorded times,
+	/// <code>false</code>: send the commands as fast as possible
+	/// </param>
+	///
+	public String Run(ArduinoIO_Trace trace, bool keepTiming)
+	{
+		StringBuilder report = new StringBuilder();
+		if ( !Open(report) ) return report.ToString();
+
+		// start with fresh statistics on the module
+		ReadAnswer("S1");
+		ReadAnswer("H1");
+
+		List<double> latencies   = new List<double>();
+		int          errors      = 0;
+		int          timeouts    = 0;
+		int          mismatches  = 0;
+		int          rescheduled = 0;
+		int          unscheduled = 0;
+
+		// module clock now and during the recording
+		ArduinoIO_Clock liveClock     = new ArduinoIO_Clock();
+		ArduinoIO_Clock recordedClock = new ArduinoIO_Clock();
+		bool            timeBurst     = false;
+		SynchroniseClock(liveClock);
+
+		List<ArduinoIO_Trace.Entry> entries = trace.GetEntries();
+		System.Diagnostics.Stopwatch clock = System.Diagnostics.Stopwatch.StartNew();
+		for ( int i = 0 ; i < entries.Count ; i++ )
+		{
+			ArduinoIO_Trace.Entry e = entries[i];
+			if ( !e.toModule || e.text.StartsWith(CMD_SPEED) ) continue;
+			ArduinoIO_Trace.Entry recorded = ((i + 1 < entries.Count) && !entries[i + 1].toModule) ? entries[i + 1] : null;
+
+			if ( timeBurst && (e.text != CMD_TIME) )
+			{
+				// end of a clock synchronisation
+				liveClock.EndBurst();
+				recordedClock.EndBurst();
+				timeBurst = false;
+			}
+
+			if ( keepTiming )
+			{
+				int wait = (int) (e.time - clock.Elapsed.TotalMilliseconds);
+				if ( wait > 0 ) Thread.Sleep(wait);
+			}
+
+			String command = e.text;
+			if ( command.StartsWith(CMD_AT) )
+			{
+				command = Reschedule(command, e.time, recordedClock, liveClock);
+				if ( command.StartsWith(CMD_AT) ) rescheduled++;
+				else                              unscheduled++;
+			}
+
+			double sent         = clock.Elapsed.TotalMilliseconds;
+			long   sendTicks    = System.Diagnostics.Stopwatch.GetTimestamp();
+			String answer       = ReadAnswer(command);
+			long   receiveTicks = System.Diagnostics.Stopwatch.GetTimestamp();
+			latencies.Add(clock.Elapsed.TotalMilliseconds - sent);
+
+			if      ( answer == ""  ) timeouts++;
+			else if ( (answer == "!") || (answer == "?") ) errors++;
+
+			if ( (command == CMD_TIME) && (recorded != null) )
+			{
+				// sample of the module clock now and during the recording
+				AddTimeSample(liveClock, sendTicks, receiveTicks, answer);
+				AddTimeSample(recordedClock, MillisToTicks(e.time), MillisToTicks(recorded.time), recorded.text);
+				timeBurst = true;
+			}
+
+			// compare with the recorded answer, unless it changes over time
+			if ( (recorded != null) && (TIME_VARYING_COMMANDS.IndexOf(command[0]) < 0) && (recorded.text != answer) )
+			{
+				mismatches++;
+			}
+		}
+		double duration = clock.Elapsed.TotalMilliseconds;
+
+		String statistics = ReadAnswer("S");
+		String histograms = ReadAnswer("H");
+		Close();
+
+		// evaluate
+		latencies.Sort();
+		report.AppendLine("Commands      : " + latencies.Count + " in " + Format(duration) + " ms (" +
+		                  Format((duration > 0) ? (latencies.Count * 1000.0 / duration) : 0) + " commands/s)");
+		report.AppendLine("Ack latency   : p50 " + Format(Percentile(latencies, 50)) +
+		                  " ms, p90 " + Format(Percentile(latencies, 90)) +
+		                  " ms, p99 " + Format(Percentile(latencies, 99)) +
+		                  " ms, max " + Format(Percentile(latencies, 100)) + " ms");
+		report.AppendLine("Errors        : " + errors + ", timeouts: " + timeouts + ", answers different from trace: " + mismatches);
+		if ( rescheduled + unscheduled > 0 )
+		{
+			report.AppendLine("Scheduled     : " + rescheduled + " commands with a new execution time, " +
+			                  unscheduled + " executed straight away (no clock in the trace)");
+		}
+		report.AppendLine("Module stats  : " + statistics);
+		// eighth value of the statistics: refresh rate of the backlight dithering
+		String[] values = statistics.Split(',');
+		if ( (values.Length >= 8) && (values[7] != "0") )
+		{
+			int rate;
+			Int32.TryParse(values[7], out rate);
+			report.AppendLine("Backlight     : dithering at " + rate + " Hz" +
+			                  ((rate < FLICKER_RATE) ? " (below " + FLICKER_RATE + " Hz, may flicker)" : ""));
+		}
+		report.AppendLine("Module hist.  : " + histograms);
+		return report.ToString();
+	}
+
+
+	/// <summary>
+	/// Measures how long the LCD takes to show a full screen of new text
+	/// and a change of two characters, for several display geometries.
+	/// The HD44780 controller accepts all geometries, so this also works on a 16x2 LCD
+	/// (only the visible part of the text appears).
+	/// At the end, the default geometry of 16x2 is restored.
+	/// </summary>
+	/// <returns>
+	/// the benchmark report (one line per geometry)
+	/// </returns>
+	/// <param name='display'>
+	/// the index of the LCD to use
+	/// </param>
+	///
+	public String RunDisplayBenchmark(int display)
+	{
+		StringBuilder report = new StringBuilder();
+		if ( !Open(report) ) return report.ToString();
+
+		int[,] geometries = { { 16, 2 }, { 20, 4 }, { 40, 2 } };
+		for ( int g = 0 ; g < geometries.GetLength(0) ; g++ )
+		{
+			int    columns  = geometries[g, 0];
+			int    rows     = geometries[g, 1];
+			String geometry = columns + "x" + rows;
+			if ( ReadAnswer(CMD_GEOMETRY + columns + "," + rows + "," + display) != "+" )
+			{
+				report.AppendLine(geometry + " : not supported");
+				continue;
+			}
+			WaitForLcd();
+			ReadAnswer("S1");
+
+			// full screen
+			System.Diagnostics.Stopwatch clock = System.Diagnostics.Stopwatch.StartNew();
+			for ( int row = 0 ; row < rows ; row++ )
+			{
+				StringBuilder text = new StringBuilder();
+				for ( int col = 0 ; col < columns ; col++ )
+				{
+					text.Append((char) ('A' + (row * 7 + col) % 26));
+				}
+				ReadAnswer(CMD_CURSOR + row + ",0," + display);
+				ReadAnswer(CMD_TEXT + "\"" + text + "\"");
+			}
+			bool   fullSettled = WaitForLcd();
+			double fullTime    = clock.Elapsed.TotalMilliseconds;
+			String statistics  = ReadAnswer("S");
+
+			// small change
+			clock = System.Diagnostics.Stopwatch.StartNew();
+			ReadAnswer(CMD_CURSOR + "0,3," + display);
+			ReadAnswer(CMD_TEXT + "\"xy\"");
+			bool   smallSettled = WaitForLcd();
+			double smallTime    = clock.Elapsed.TotalMilliseconds;
+
+			report.AppendLine(geometry + " : full screen " + (fullSettled ? Format(fullTime) : "-") +
+			                  " ms, 2 characters " + (smallSettled ? Format(smallTime) : "-") +
+			                  " ms, module stats: " + statistics);
+		}
+		ReadAnswer(CMD_GEOMETRY + "16,2," + display);
+		Close();
+		return report.ToString();
+	}
+
+
+	/// <summary>
+	/// Waits until the module has written all text changes to the LCDs.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the LCDs are up to date,
+	/// <code>false</code> if the module did not answer or took too long
+	/// </returns>
+	///
+	private bool WaitForLcd()
+	{
+		System.Diagnostics.Stopwatch clock = System.Diagnostics.Stopwatch.StartNew();
+		while ( clock.ElapsedMilliseconds < LCD_SETTLE_TIMEOUT )
+		{
+			// fourth value of the statistics: characters waiting for the LCD refresh
+			String[] values = ReadAnswer("S").Split(',');
+			if ( values.Length < 4 ) return false;
+			if ( values[3] == "0" ) return true;
+		}
+		return false;
+	}
+
+
+	/// <summary>
+	/// Opens the serial port, checks if the module answers and switches to the fast speed.
+	/// A module that does not answer at the original speed might still be at a fast speed
+	/// from a session that was not closed properly, so the fast speeds are tried as well.
+	/// </summary>
+	///
+	private bool Open(StringBuilder report)
+	{
+		serialPort = new SerialPort(portName, speed, Parity.None, 8, StopBits.One);
+		serialPort.Handshake   = Handshake.None;
+		serialPort.RtsEnable   = false;
+		serialPort.DtrEnable   = false;
+		serialPort.ReadTimeout = ANSWER_TIMEOUT;
+		try
+		{
+			serialPort.Open();
+		}
+		catch (IOException)
+		{
+			report.AppendLine("Could not open serial port " + portName);
+			return false;
+		}
+
+		version = ReadAnswer(CMD_ECHO);
+		int[] probeSpeeds = ArduinoIO_SerialSpeed.GetProbeSpeeds(speed, fastSpeed);
+		for ( int i = 0 ; (version.Length <= 1) && (i < probeSpeeds.Length) ; i++ )
+		{
+			serialPort.BaudRate = probeSpeeds[i];
+			version = ReadAnswer(CMD_ECHO);
+			// a garbled answer is possible: the second echo needs to confirm it
+			if ( ReadAnswer(CMD_ECHO) != version ) version = "";
+		}
+		if ( version.Length <= 1 )
+		{
+			report.AppendLine("No answer from the module on " + portName);
+			serialPort.Close();
+			return false;
+		}
+
+		if ( (fastSpeed > speed) && (serialPort.BaudRate != fastSpeed) )
+		{
+			ArduinoIO_SerialSpeed.Negotiate(serialPort, speed, fastSpeed, version, null);
+		}
+		usedSpeed = serialPort.BaudRate;
+		report.AppendLine("Module        : " + version + " on " + portName + ", " + usedSpeed + " baud");
+		return true;
+	}
+
+
+	/// <summary>
+	/// Switches the module back to the original speed and closes the serial port.
+	/// </summary>
+	///
+	private void Close()
+	{
+		ArduinoIO_SerialSpeed.Restore(serialPort, speed, version, null);
+		serialPort.Close();
+	}
+
+
+	/// <summary>
+	/// Asks the module for its time several times and updates a clock estimate.
+	/// </summary>
+	///
+	private void SynchroniseClock(ArduinoIO_Clock clock)
+	{
+		for ( int i = 0 ; i < SYNC_SAMPLES ; i++ )
+		{
+			long   sendTicks    = System.Diagnostics.Stopwatch.GetTimestamp();
+			String answer       = ReadAnswer(CMD_TIME);
+			long   receiveTicks = System.Diagnostics.Stopwatch.GetTimestamp();
+			AddTimeSample(clock, sendTicks, receiveTicks, answer);
+		}
+		clock.EndBurst();
+	}
+
+
+	/// <summary>
+	/// Adds the answer to a time request to a clock estimate (see ArduinoIO_Clock.AddSample()).
+	/// Answers that are not a time (e.g., "?" from modules without a clock) are ignored.
+	/// </summary>
+	///
+	private void AddTimeSample(ArduinoIO_Clock clock, long sendTicks, long receiveTicks, String answer)
+	{
+		uint deviceMicros;
+		if ( !uint.TryParse(answer, out deviceMicros) ) return;
+
+		// the answer (with CR LF) takes longer to transfer than the command (with LF), 10 bits per byte
+		long transferTicks = (answer.Length + 1) * 10 * System.Diagnostics.Stopwatch.Frequency / usedSpeed;
+		clock.AddSample(sendTicks, receiveTicks, deviceMicros, transferTicks);
+	}
+
+
+	/// <summary>
+	/// Gives a recorded command with an execution time a new time,
+	/// as far ahead of the current module clock as it was ahead of the module clock when it was recorded.
+	/// </summary>
+	/// <returns>
+	/// the command with the new time,
+	/// or the command without a time if one of the clocks is unknown (executed straight away)
+	/// </returns>
+	/// <param name='command'>
+	/// the recorded command, e.g. "@81250000L0,99"
+	/// </param>
+	/// <param name='time'>
+	/// the time of the recorded command in ms since the start of the recording
+	/// </param>
+	/// <param name='recordedClock'>
+	/// the module clock during the recording
+	/// </param>
+	/// <param name='liveClock'>
+	/// the current module clock
+	/// </param>
+	///
+	private static String Reschedule(String command, double time, ArduinoIO_Clock recordedClock, ArduinoIO_Clock liveClock)
+	{
+		int pos = CMD_AT.Length;
+		while ( (pos < command.Length) && Char.IsDigit(command[pos]) ) pos++;
+
+		uint executeAt;
+		if ( !uint.TryParse(command.Substring(CMD_AT.Length, pos - CMD_AT.Length), out executeAt) ||
+		     !recordedClock.IsSynchronised() || !liveClock.IsSynchronised() )
+		{
+			return command.Substring(pos);
+		}
+
+		// the module time wraps around, the difference does not
+		int ahead = (int) (executeAt - recordedClock.ToDeviceTime(MillisToTicks(time)));
+		return CMD_AT + (uint) (liveClock.ToDeviceTime(System.Diagnostics.Stopwatch.GetTimestamp()) + ahead) + command.Substring(pos);
+	}
+
+
+	/// <summary>
+	/// Sends a command and reads the answer line.
+	/// </summary>
+	/// <returns>
+	/// the answer or "" in case of a timeout
+	/// </returns>
+	///
+	private String ReadAnswer(String command)
+	{
+		return ArduinoIO_SerialSpeed.ReadAnswer(serialPort, command, null);
+	}
+
+
+	/// <summary>
+	/// Converts a time of the trace into Stopwatch ticks.
+	/// </summary>
+	///
+	private static long MillisToTicks(double millis)
+	{
+		return (long) (millis * System.Diagnostics.Stopwatch.Frequency / 1000);
+	}
+
+
+	/// <summary>
+	/// Gets a percentile of a sorted list of values.
+	/// </summary>
+	///
+	private static double Percentile(List<double> sorted, int percent)
+	{
+		if ( sorted.Count == 0 ) return 0;
+		int idx = (int) Math.Ceiling(sorted.Count * percent / 100.0) - 1;
+		return sorted[Math.Max(0, Math.Min(idx, sorted.Count - 1))];
+	}
+
+
+	private static String Format(double value)
+	{
+		return value.ToString("0.00", CultureInfo.InvariantCulture);
+	}
+
+
+	private const String CMD_ECHO          = "E";
+	private const String CMD_SPEED         = "B";
+	private const String CMD_TIME          = "Y";
+	private const String CMD_AT            = "@";  // prefix for commands with an execution time
+	private const String CMD_GEOMETRY      = "G";
+	private const String CMD_CURSOR        = "P";
+	private const String CMD_TEXT          = "T";
+	private const String TIME_VARYING_COMMANDS = "SHRQYbl"; // statistics, clock and states: answers differ from the trace
+	private const int    ANSWER_TIMEOUT    = 250;  // time in ms to wait for an answer
+	private const int    SYNC_SAMPLES      = 8;    // number of time requests for one clock synchronisation
+	private const int    LCD_SETTLE_TIMEOUT = 5000; // time in ms to wait for the LCD refresh
+	private const int    FLICKER_RATE       = 100;  // lowest backlight dithering rate in Hz that does not flicker visibly
+
+	private readonly String portName;
+	private readonly int    speed;
+	private readonly int    fastSpeed;
+	private SerialPort      serialPort;
+	private String          version;   // answer of the module to the echo command
+	private int             usedSpeed; // speed after opening the port
+}
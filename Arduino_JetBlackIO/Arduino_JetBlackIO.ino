@@ -19,56 +19,163 @@
  *                            - Modified button command
  *                            - Added clear command
  * @version 1.7 - 2012.12.11: - Adding a "text frame buffer" to handle the T command quickly and then slowly update the actua LCD
+ * @version 1.8 - 2026.10.18: - Removed all dynamic memory allocation (LEDs, buttons, LCD and text buffers are static)
+ *                            - Added free RAM command
+ *                            - LED and button states stored in per-type tables, updated without virtual calls
+ * @version 1.9 - 2026.10.18: - Added serial speed negotiation command
+ * @version 1.10 - 2026.10.18: - Added performance counters and statistics command
+ *                             - Added command latency histograms
+ *                             - Added LCD settle time histogram
+ * @version 1.11 - 2026.10.18: - Table driven command dispatch, parameters are decoded and validated before execution
+ *                             - Commands are decoded byte by byte while they are received,
+ *                               LCD text is written into the text buffer directly
+ * @version 1.12 - 2026.10.18: - LED and big number commands are acknowledged after validation and executed later in the main loop
+ *                             - Added work queue state command
+ * @version 1.13 - 2026.10.18: - Support for up to 4 LCD shields with different I2C addresses,
+ *                               each with its own text buffer and backlight LED
+ *                             - Only changed characters are written to the LCDs
+ * @version 1.14 - 2026.10.18: - Display geometry configurable at runtime (e.g., 20x4, 40x2)
+ * @version 1.15 - 2026.10.18: - Added scrolling text regions
+ * @version 1.16 - 2026.10.18: - Added number fields that are formatted on the device
+ * @version 1.17 - 2026.10.18: - Added screen pages stored in the EEPROM, shown with a single command
+ * @version 1.18 - 2026.10.18: - Constant tables and strings moved to flash memory,
+ *                               the freed RAM is used for a bigger text buffer and work queue
+ * @version 1.19 - 2026.10.18: - Serial communication starts before the LCDs are initialised,
+ *                               the LCD initialisation runs in the main loop
+ * @version 1.20 - 2026.10.18: - Added the I command that describes the module, so the host can configure itself
+ * @version 1.21 - 2026.10.18: - LEDs on pins 3, 11 and 13 are dimmed by software PWM (timer 2)
+ * @version 1.22 - 2026.10.18: - LEDs on MCP23017 pins, all expander outputs (including the backlights)
+ *                               are written once per loop with one I2C transfer per chip
+ * @version 1.23 - 2026.10.18: - Added clock command and scheduled execution of queued commands,
+ *                               time comparisons work across the millis()/micros() wraparound
+ * @version 1.24 - 2026.10.18: - Backlight colours are mixed by temporal dithering instead of 8 colours,
+ *                               the dithering rate is part of the statistics
+ * @version 1.25 - 2026.10.18: - Optional back buffer for the LCD text, shown at once with the X command
+ * @version 1.26 - 2026.10.18: - Bugfix: LCD commands no longer overtake queued big numbers
+ *                             - The LED on the spare pin of LCD shield 0 is dimmable,
+ *                               and it is only available if that shield is connected
+ *                             - LEDs that do not fit into their tables are reported on the LCD at startup
+ *                             - LEDs on pins 3 and 11 use hardware PWM again, software PWM only for the LED on pin 13
+ *                             - Bugfix: text of a scheduled command that can not be scheduled no longer reaches the LCD
+ *                             - Bugfix: only a successful E command confirms a new serial speed
+ *                             - Screen pages are programmed into the EEPROM in the background, one byte per loop.
+ *                               U, W and K wait for the previous page command to be programmed before they are executed
+ *                             - Compiles without warnings with -Wall -Wextra
+ *                             - Bugfix: G removes the number fields of the display, their positions may no longer exist
  *
  * Command set:
- * C               : Clear LCD
+ * Bs              : Switch serial speed to s baud (115200, 250000, 500000, 1000000) after sending the reply.
+ *                   If the host does not confirm the new speed with an E command within 1s, the speed reverts to 115200
+ * C[d]            : Clear LCD d (default: 0) and select it for the T command
  * E               : Echo version number
+ * I               : Get the description of the module: name and version, protocol version, supported commands,
+ *                   fastest serial speed, LCD geometries, LED types, number of buttons, fields, scrolling regions
+ *                   and screen pages (see processGetInfoCommand)
  * ba              : Get state of button a (00:off, no change / 1x: on, x=number of presses sincel last poll)
  * Ln,b[,i[,r]]    : Set LED n brightness to b (00-99) (and blink interval to i, and blink ratio to r)
  * ln              : Get brightness of LED n
  * Mn,r,g,b[,i[,r]]: Set multicolour LED n colour to r,g,b (00-99) (and blink interval to i, and blink ratio to r)
- * T"string"       : Set text on LCD display, the string to be displayed must be enclosed with quotation marks               
- * Nx              : Displays large numerical text on the LCD where x is the number to be displayed
- * Pr[,c]          : Sets the row r [and column c] for the cursor
+ * T"string"       : Set text on the selected LCD display, the string to be displayed must be enclosed with quotation marks               
+ * Nx[,d]          : Displays large numerical text on LCD d (default: 0) where x is the number to be displayed
+ * Pr[,c[,d]]      : Sets the row r [and column c] for the cursor [of LCD d] and selects the LCD for the T command
+ * Gc,r[,d[,b]]    : Sets the geometry of LCD d (default: 0) to c columns and r rows (max. 4 rows, 80 characters)
+ *                   and clears it, its scrolling text regions and number fields are removed.
+ *                   The text of the LCDs with a higher number is cleared as well.
+ *                   b=1: C, T, N, V and D write into a back buffer that is shown with the X command
+ * X[d]            : Shows the back buffer of LCD d (default: 0) at once, only the changed characters are written to the LCD
+ * An,r,c,w,i[,"string"[,d]] : Scrolls the string in region n (0-1) at row r, columns c to c+w-1 of LCD d (default: 0),
+ *                   one step every i ms. Without a string or with i=0, the region stops scrolling
+ * Fn,r,c,w[,p[,z[,a[,d]]]] : Defines number field n (0-7) at row r, column c with width w of LCD d (default: 0)
+ *                   with p decimal places, z=1: leading zeros, a=1: left aligned. w=0 removes the field
+ * Vn,v[,v...]     : Shows the numbers v in field n and the following fields (up to 6 numbers), e.g. V0,1234,56
+ * Up[,d]          : Starts screen page p (0-5) for LCD d (default: 0) with the current geometry of the LCD,
+ *                   without text and LED states. Pages are stored in the EEPROM
+ * Wp,r,"string"   : Sets the text of row r of page p
+ * Kp,n,b,i,r[,R,G,B] : Sets the state of LED n on page p to brightness b, blink interval i and blink ratio r
+ *                   (and colour R,G,B), up to 4 LEDs per page
+ * Dp              : Shows page p: the text of the page replaces the text of its LCD, the LEDs of the page are set
+ * R               : Get free RAM in bytes, lowest free RAM since startup, and string buffer peak usage
+ * Q               : Get the state of the work queue: queued commands, executed commands, failed commands,
+ *                   scheduled commands and the longest scheduling delay in us
+ *                   (L, M and N are acknowledged when they are received and executed later in the main loop,
+ *                   the other LCD commands and l execute the queued commands first)
+ * Y               : Get the time of the module in us (micros()), for synchronising the clocks of host and module
+ * @t<command>     : Execute L, M or N when micros() reaches t, e.g. "@81250000L0,99"
+ *                   (up to 35 minutes ahead, commands that are due are executed straight away)
+ * S[r]            : Get performance statistics (see processGetStatisticsCommand), r=1: reset the counters afterwards
+ * H[r]            : Get command latency histograms (see processGetHistogramsCommand), r=1: reset the histograms afterwards
  *
- * Return value: "+" or value if command successful, "!" if an error occured
+ * Return value: "+" or value if command successful, "!" if an error occured (e.g., invalid parameters), "?" if the command is unknown
  */
  
 #include <Wire.h>
+#include <EEPROM.h>
 #include "DigitalButton.h"
-#include "DigitalLED.h"
 #include "AnalogLED.h"
+#include "SoftPwmLED.h"
 #include "RGB_LED.h"
 #include "LCD_Backlight.h"
+#include "ExpanderLED.h"
+#include "ExpanderPort.h"
 #include "Adafruit_MCP23017.h"
 #include "Adafruit_RGBLCDShield.h"
+#include "LcdDisplay.h"
+#include "Marquee.h"
+#include "NumberField.h"
+#include "PageStore.h"
+#include "LatencyHistogram.h"
+#include "CommandInfo.h"
 
-// version of the IO box
-const char MODULE_NAME[]    = "JetBlack IO-Box";
-const char MODULE_VERSION[] = "v1.7";
+// version of the IO box (in flash memory, see getText())
+const char MODULE_NAME[]    PROGMEM = "JetBlack IO-Box";
+const char MODULE_VERSION[] PROGMEM = "v1.26";
+// startup error: the LED objects of the sketch need bigger tables (see LedTable::overflow)
+const char ERROR_LED_TABLE[] PROGMEM = "LED table full";
+// version of the command syntax, increased when existing commands change
+const byte PROTOCOL_VERSION = 1;
 
 // macro for the size of an array
 #define ARRSIZE(x) (sizeof(x) / sizeof(x[0] ))
+
+// macro for printing a string that is stored in flash memory
+#define getText(x) ((const __FlashStringHelper*) (x))
  
+// LED objects (statically allocated, there is no heap usage in this sketch)
+AnalogLED     ledPin3(3), ledPin5(5), ledPin6(6);
+AnalogLED     ledPin9(9), ledPin10(10), ledPin11(11);
+SoftPwmLED    ledPin13(13); // LED on the board, no hardware PWM
+RGB_LED       ledMulti0(&ledPin3, &ledPin5,  &ledPin6);
+RGB_LED       ledMulti1(&ledPin9, &ledPin10, &ledPin11);
+ExpanderLED   ledShield0(0, 5); // spare pin GPA5 of the MCP23017 of the LCD shield with address 0
+
 // array with LEDs
 LED* arrLEDs[] = {
-  new AnalogLED(3), 
-  new AnalogLED(5), 
-  new AnalogLED(6), 
-  NULL, // LED 3 will be Multicolour LED 0
-  new AnalogLED(9), 
-  new AnalogLED(10), 
-  new AnalogLED(11), 
-  NULL, // LED 7 will be Multicolour LED 1
-  new DigitalLED(13), // LED on the board
-  NULL  // LED 9 will be the LCD background LED
+  &ledPin3, 
+  &ledPin5, 
+  &ledPin6, 
+  &ledMulti0, // LED 3 is Multicolour LED 0
+  &ledPin9, 
+  &ledPin10, 
+  &ledPin11, 
+  &ledMulti1, // LED 7 is Multicolour LED 1
+  &ledPin13, 
+  NULL, // LEDs 9 to 12 will be the backlights of LCD 0 to 3 (if present)
+  NULL,
+  NULL,
+  NULL,
+  NULL  // LED 13 will be the spare pin of the LCD shield with address 0 (if present)
 };
+const byte LED_BACKLIGHT = 9;  // index of the backlight of LCD 0
+const byte LED_SHIELD    = 13; // index of the LED on the spare pin of the LCD shield with address 0
+
+// button objects
+DigitalButton buttonPin2(2), buttonPin4(4), buttonPin7(7);
 
 // array with buttons
 Button* arrButtons[] = { 
-  new DigitalButton(2), 
-  new DigitalButton(4), 
-  new DigitalButton(7)
+  &buttonPin2, 
+  &buttonPin4, 
+  &buttonPin7
 };
 
 // constants for communication
@@ -77,29 +184,155 @@ const char ERROR_CHAR   = '!';
 const char CHAR_CR      = 13;
 const char CHAR_LF      = 10;
 
-// receive buffer
-char       rxBuffer[128];
+// serial speed
+const unsigned long SERIAL_SPEED_DEFAULT     = 115200;
+const unsigned long arrSerialSpeeds[] PROGMEM = { 115200, 250000, 500000, 1000000 };
+const unsigned long SERIAL_SPEED_VERIFY_TIME = 1000; // time in ms for the first valid command after a speed change
+boolean             serialSpeedPending       = false; // true: new speed not confirmed by the host yet
+unsigned long       serialSpeedDeadline      = 0;
+
+// command handlers
+boolean processSetSerialSpeedCommand(const CommandParam* params, byte paramCount);
+boolean processEchoCommand(const CommandParam* params, byte paramCount);
+boolean processGetInfoCommand(const CommandParam* params, byte paramCount);
+boolean processGetButtonStateCommand(const CommandParam* params, byte paramCount);
+boolean processGetLedBrightnessCommand(const CommandParam* params, byte paramCount);
+boolean processSetLedBrightnessCommand(const CommandParam* params, byte paramCount);
+boolean processSetMulticolourLedColourCommand(const CommandParam* params, byte paramCount);
+boolean processClearLcdCommand(const CommandParam* params, byte paramCount);
+boolean processSetLcdTextCommand(const CommandParam* params, byte paramCount);
+boolean processSetCursorCommand(const CommandParam* params, byte paramCount);
+boolean processSetGeometryCommand(const CommandParam* params, byte paramCount);
+boolean processSetMarqueeCommand(const CommandParam* params, byte paramCount);
+boolean processDefineFieldCommand(const CommandParam* params, byte paramCount);
+boolean processSetFieldValuesCommand(const CommandParam* params, byte paramCount);
+boolean processSetBigNumberCommand(const CommandParam* params, byte paramCount);
+boolean processCreatePageCommand(const CommandParam* params, byte paramCount);
+boolean processSetPageRowCommand(const CommandParam* params, byte paramCount);
+boolean processSetPageLedCommand(const CommandParam* params, byte paramCount);
+boolean processShowPageCommand(const CommandParam* params, byte paramCount);
+boolean processCommitCommand(const CommandParam* params, byte paramCount);
+boolean processGetFreeRamCommand(const CommandParam* params, byte paramCount);
+boolean processGetStatisticsCommand(const CommandParam* params, byte paramCount);
+boolean processGetHistogramsCommand(const CommandParam* params, byte paramCount);
+boolean processGetWorkQueueCommand(const CommandParam* params, byte paramCount);
+boolean processGetTimeCommand(const CommandParam* params, byte paramCount);
+
+// command table: parameter schema (see CommandInfo.h), flags and handler of each command
+const CommandInfo commandTable[] PROGMEM = {
+  // cmd  schema     flags                         handler
+  { 'B', "u",       0,                            processSetSerialSpeedCommand },
+  { 'E', "",        0,                            processEchoCommand },
+  { 'I', "",        0,                            processGetInfoCommand },
+  { 'b', "k",       0,                            processGetButtonStateCommand },
+  { 'l', "n",       CMD_FLAG_SYNC,                processGetLedBrightnessCommand },
+  { 'L', "nv[iv",   CMD_FLAG_ACK | CMD_FLAG_DEFER, processSetLedBrightnessCommand },
+  { 'M', "mvvv[iv", CMD_FLAG_ACK | CMD_FLAG_DEFER, processSetMulticolourLedColourCommand },
+  { 'C', "[x",      CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processClearLcdCommand },
+  { 'T', "s",       CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_TEXT | CMD_FLAG_SYNC, processSetLcdTextCommand },
+  { 'P', "r[cx",    CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processSetCursorCommand },
+  { 'G', "vv[xf",   CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processSetGeometryCommand },
+  { 'A', "vrcvi[sx", CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processSetMarqueeCommand },
+  { 'F', "vrcv[vffx", CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processDefineFieldCommand },
+  { 'V', "vu[uuuuu", CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processSetFieldValuesCommand },
+  { 'N', "d[x",     CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_DEFER, processSetBigNumberCommand },
+  { 'U', "v[x",     CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_EEPROM, processCreatePageCommand },
+  { 'W', "vrs",     CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_EEPROM, processSetPageRowCommand },
+  { 'K', "vnviv[vvv", CMD_FLAG_ACK | CMD_FLAG_EEPROM,            processSetPageLedCommand },
+  { 'D', "v",       CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processShowPageCommand },
+  { 'X', "[x",      CMD_FLAG_ACK | CMD_FLAG_LCD | CMD_FLAG_SYNC, processCommitCommand },
+  { 'R', "",        0,                            processGetFreeRamCommand },
+  { 'S', "[f",      0,                            processGetStatisticsCommand },
+  { 'H', "[f",      0,                            processGetHistogramsCommand },
+  { 'Q', "",        0,                            processGetWorkQueueCommand },
+  { 'Y', "",        0,                            processGetTimeCommand }
+};
+
+// command decoder states
+const byte PARSE_IDLE   = 0; // waiting for the command character
+const byte PARSE_PARAMS = 1; // between parameters
+const byte PARSE_NUMBER = 2; // inside a number
+const byte PARSE_STRING = 3; // inside a string
+const byte PARSE_ERROR  = 4; // invalid command: skip the rest of the line
+const byte PARSE_TIME   = 5; // inside the execution time before the command character
+
+// command that is currently received and its parameters
+byte         parseState    = PARSE_IDLE;
+int          parseCmdIdx   = -1; // index in the command table (-1: unknown command)
+CommandInfo  parseCmd;           // copy of the command table entry
+CommandParam cmdParams[CMD_MAX_PARAMS];
+byte         cmdParamCount = 0;
+boolean      cmdScheduled  = false; // true: command has an execution time
+unsigned long cmdExecuteAt = 0;     // execution time in us (micros())
+
+// queue for commands that are executed in the main loop (see enqueueWork())
+byte         workQueue[128];
+byte         workQueueHead     = 0; // next byte to read
+byte         workQueueUsed     = 0; // number of bytes in the queue
+byte         workQueueCount    = 0; // number of commands in the queue
+unsigned int workExecuted      = 0; // number of executed commands since startup
+unsigned int workFailed        = 0; // number of commands that failed during execution
+
+// queue for commands with an execution time, sorted by time (see scheduleWork())
+byte          scheduleQueue[80];
+byte          scheduleUsed     = 0; // number of bytes in the queue
+byte          scheduleCount    = 0; // number of commands in the queue
+unsigned long scheduleDelayMax = 0; // longest time in us between execution time and execution
+// a scheduled command that is due within this time (in us) holds back the LCD refresh,
+// so the main loop is short enough to execute it on time
+const unsigned long SCHEDULE_GUARD_TIME = 5000;
+
+// buffer for string parameters (text for the LCD is not buffered)
+char       rxBuffer[40];
 byte       rxBufferIdx = 0;
-byte       rxReadIdx   = 0;
 const byte rxBufferMax = sizeof(rxBuffer) / sizeof(rxBuffer[0]);
+byte       rxBufferPeak = 0; // maximum string buffer usage since startup
+
+// performance counters (reset by the S1 command)
+unsigned long perfWindowStart     = 0; // start of the current loop counting second in ms
+unsigned int  perfWindowLoops     = 0; // loop iterations in the current second
+unsigned int  perfLoopsPerSecond  = 0; // loop iterations in the last complete second
+boolean       perfLoopTimeValid   = false; // false: no previous loop iteration to measure against
+unsigned long perfLastLoopStart   = 0; // start of the last loop iteration in us
+unsigned long perfLoopTimeMax     = 0; // longest time between two loop iterations in us
+unsigned int  perfRxOverflows     = 0; // commands with strings that did not fit into the string buffer
+unsigned int  perfUnknownCommands = 0; // commands answered with '?'
+boolean       perfLcdBusy         = false; // true: LCD refresh from the text buffer in progress
+unsigned long perfLcdBusyStart    = 0; // time the LCD refresh started in ms
+unsigned long perfLcdBusyMax      = 0; // longest LCD refresh in ms
 
-// LCD and text initialization
-Adafruit_RGBLCDShield* pLCD = NULL; // if NO LCD is connnected, pLCD stays null
+// command latency histograms (reset by the H1 command)
+LatencyHistogram histLoopTime; // time between two loop iterations (= longest wait for serialEvent())
+LatencyHistogram histLcdSettle; // time in ms from a text change until the LCD shows all changes
+LatencyHistogram histLatency[ARRSIZE(commandTable)]; // per command: line terminator received -> reply sent
+unsigned int     histDelayMax[ARRSIZE(commandTable)]; // per command: longest time in us from line terminator to execution start
 
-int    iLcdRows    = 2;    // size of the LCD
-int    iLcdColumns = 16;
-char** arrTextIn   = NULL; // input text buffer
-int    iCursorRow  = 0;    // cursor for input
-int    iCursorCol  = 0;
+// free RAM measurement
+extern uint8_t  __heap_start; // end of static data, provided by the linker
+extern uint8_t* __brkval;     // top of the heap (NULL as long as the heap is not used)
+const  uint8_t  RAM_CANARY = 0xC5; // pattern for painting unused RAM
 
-char** arrTextBuf  = NULL; // text buffer
-int    iTextBufRow = 0;    // current LCD update position
-int    iTextBufCol = 0;
+// LCD displays (one for each LCD shield found on the I2C bus)
+LcdDisplay arrDisplays[LCD_MAX_DISPLAYS];
+byte       iDisplayCount   = 0; // number of connected displays
+byte       iCurrentDisplay = 0; // display for the T command (selected by C and P)
+byte       iRefreshDisplay = 0; // display that was refreshed last
 
-byte   bUpdateTextBufCounter = 0; // counter for updating LCD text buffer
+// memory for the text buffers of all displays (e.g., four 16x2 displays, three 20x4 displays or three 40x2 displays)
+char arrTextPool[240];
+byte arrDirtyPool[ARRSIZE(arrTextPool) / 8 + LCD_MAX_DISPLAYS];
 
-// the 8 arrays that form each segment of the large custom numbers
-byte bigNumberSegments[][8] = { { B00111, B01111, B11111, B11111, B11111, B11111, B11111, B11111 },
+// scrolling text regions
+Marquee arrMarquees[2];
+
+// number fields
+NumberField arrFields[8];
+
+// screen pages (in the EEPROM)
+PageStore pageStore;
+
+// the 8 arrays that form each segment of the large custom numbers (in flash memory)
+const byte bigNumberSegments[][8] PROGMEM = { { B00111, B01111, B11111, B11111, B11111, B11111, B11111, B11111 },
                                 { B11111, B11111, B11111, B00000, B00000, B00000, B00000, B00000 },
                                 { B11100, B11110, B11111, B11111, B11111, B11111, B11111, B11111 },
                                 { B11111, B11111, B11111, B11111, B11111, B11111, B01111, B00111 },
@@ -108,8 +341,8 @@ byte bigNumberSegments[][8] = { { B00111, B01111, B11111, B11111, B11111, B11111
                                 { B11111, B11111, B11111, B00000, B00000, B00000, B11111, B11111 },
                                 { B11111, B00000, B00000, B00000, B00000, B11111, B11111, B11111 } 
                               };
-// the 10 arrays for building a big number out of the special characters
-byte bigNumberChars[][6] =  { { 0,  1,  2,   3,  4,  5 }, // 0
+// the 10 arrays for building a big number out of the special characters (in flash memory)
+const byte bigNumberChars[][6] PROGMEM = { { 0,  1,  2,   3,  4,  5 }, // 0
                               { 1,  2, 32,   4,255,  4 }, // 1
                               { 6,  6,  2,   3,  7,  7 }, // 2
                               { 6,  6,  2,   7,  7,  5 }, // 3
@@ -131,14 +364,26 @@ byte bigNumberChars[][6] =  { { 0,  1,  2,   3,  4,  5 }, // 0
  */
 void setup()
 {
-  arrLEDs[3] = new RGB_LED(arrLEDs[0], arrLEDs[1], arrLEDs[2]); // LED 3 is a multicolour LED
-  arrLEDs[7] = new RGB_LED(arrLEDs[4], arrLEDs[5], arrLEDs[6]); // LED 7 is a multicolour LED
+  // prepare free RAM measurement
+  paintFreeRam();
+  
+  // start the timer for the software PWM LEDs
+  SoftPwmLED::begin();
   
-  // initialise the LCD (if present)
-  initializeLCD();
+  // initialize serial communication at the default bitrate (can be increased by the B command)
+  // first, so that the host can connect while the LCDs are initialised
+  Serial.begin(SERIAL_SPEED_DEFAULT);
   
-  // initialize serial communication at maximum bitrate
-  Serial.begin(115200);
+  // look for the LCDs, their initialisation continues in the main loop
+  initializeDisplays();
+  
+  // LEDs that share a table entry or output change each other: show the error instead of the version
+  if ( LedTable::overflow && (iDisplayCount > 0) )
+  {
+    arrDisplays[0].setCursor(1, 0);
+    arrDisplays[0].print(getText(ERROR_LED_TABLE));
+    arrDisplays[0].setCursor(0, 0);
+  }
 }
 
 
@@ -148,608 +393,1591 @@ void setup()
 void loop() 
 {
   unsigned long time = millis();
-  // update the LEDs
-  for ( int i = 0 ; i < ARRSIZE(arrLEDs) ; i++ ) 
+  
+  // measure loop time (including the serial event processing in between)
+  unsigned long loopStart = micros();
+  if ( perfLoopTimeValid )
   {
-    if ( arrLEDs[i] != NULL ) arrLEDs[i]->update(time);
+    unsigned long loopTime = loopStart - perfLastLoopStart;
+    if ( loopTime > perfLoopTimeMax ) perfLoopTimeMax = loopTime;
+    histLoopTime.add(loopTime);
   }
+  perfLastLoopStart = loopStart;
+  perfLoopTimeValid = true;
+  // count loop iterations per second
+  perfWindowLoops++;
+  if ( time - perfWindowStart >= 1000 )
+  {
+    perfLoopsPerSecond = perfWindowLoops;
+    perfWindowLoops    = 0;
+    perfWindowStart    = time;
+  }
+  
+  // execute one queued command and the scheduled commands that are due
+  executeWork();
+  boolean scheduleDue = executeScheduledWork();
+  
+  // update the LEDs, type by type (RGB LEDs are updated through their components)
+  AnalogLED::updateAll(time);
+  SoftPwmLED::updateAll(time);
+  LCD_Backlight::updateAll(time);
+  ExpanderLED::updateAll(time);
+  // write the changed expander outputs, one I2C transfer per chip
+  ExpanderPort::flush();
   // update the Buttons
-  for ( int i = 0 ; i < ARRSIZE(arrButtons) ; i++ ) 
+  DigitalButton::updateAll(time);
+  
+  // program the next changed byte of the screen pages into the EEPROM
+  pageStore.update();
+  
+  // new serial speed not confirmed in time: fall back to default speed
+  if ( serialSpeedPending && ((long) (time - serialSpeedDeadline) >= 0) )
+  {
+    setSerialSpeed(SERIAL_SPEED_DEFAULT);
+    serialSpeedPending = false;
+  }
+  
+  // advance the scrolling text regions
+  for ( byte i = 0 ; i < ARRSIZE(arrMarquees) ; i++ )
+  {
+    arrMarquees[i].update(time);
+  }
+  
+  // slowly update the LCDs from their text buffers, one character per loop.
+  // The displays take turns, so that a display with a lot of changes does not hold up the others
+  // The refresh waits while a scheduled command is due soon (one character can take a few ms)
+  boolean lcdBusy = false;
+  for ( byte i = 0 ; (i < iDisplayCount) && !lcdBusy && !scheduleDue ; i++ )
   {
-    if ( arrButtons[i] != NULL ) arrButtons[i]->update(time);
+    iRefreshDisplay++;
+    if ( iRefreshDisplay >= iDisplayCount ) iRefreshDisplay = 0;
+    lcdBusy = arrDisplays[iRefreshDisplay].refresh();
   }
   
-  // slowly update LCD text from text buffer
-  if ( (arrTextIn != NULL) && (bUpdateTextBufCounter > 0) )
+  // measure how long the LCD refresh lags behind the text buffers
+  if ( lcdBusy )
   {
-    char c = arrTextIn[iTextBufRow][iTextBufCol];
-    if ( c != arrTextBuf[iTextBufRow][iTextBufCol] )
+    if ( !perfLcdBusy )
     {
-      // a character has changed -> update LCD
-      pLCD->setCursor(iTextBufCol, iTextBufRow);
-      pLCD->print(c);
-      arrTextBuf[iTextBufRow][iTextBufCol] = c;
+      perfLcdBusy      = true;
+      perfLcdBusyStart = time;
     }
-    
-    // update "update" cursor
-    iTextBufCol++;
-    if ( iTextBufCol >= iLcdColumns )
-    {
-      iTextBufCol = 0;
-      iTextBufRow++;
-      if ( iTextBufRow >= iLcdRows )
-      {
-        iTextBufRow = 0;
-        bUpdateTextBufCounter--;
-      }
-    }    
+    if ( time - perfLcdBusyStart > perfLcdBusyMax ) perfLcdBusyMax = time - perfLcdBusyStart;
+  }
+  else if ( perfLcdBusy && !scheduleDue )
+  {
+    // LCDs have caught up with the text buffers
+    histLcdSettle.add(time - perfLcdBusyStart);
+    perfLcdBusy = false;
   }
 }
 
 
 /********************************************************************************
- * Methods for receiving serial data and reading parameters
+ * Methods for receiving serial data and decoding commands
  ********************************************************************************/
 
 /**
  * This method is called whenever a byte over a the serial line is received.
- * It stores the bytes in the receive buffer
- * and triggers parsing of the recevied data when CR or LF is received.
+ * Each byte is decoded immediately,
+ * the command is executed when CR or LF is received.
  */
 void serialEvent()
 {
   while ( Serial.available() ) 
   {
-    char rxIn = (char) Serial.read();
-    rxBuffer[rxBufferIdx] = rxIn;
-    
-    // did we receive a CR or LF?
-    if ( (rxIn == CHAR_LF) || (rxIn == CHAR_CR) )     
+    // a page command waits at the end of its line until the last page command has been written to the EEPROM.
+    // The host waits for the reply, so nothing else arrives in the meantime, and the main loop keeps running
+    char c = (char) Serial.peek();
+    if ( ((c == CHAR_LF) || (c == CHAR_CR)) && (parseState != PARSE_IDLE) && (parseState != PARSE_ERROR) &&
+         (parseCmdIdx >= 0) && (parseCmd.flags & CMD_FLAG_EEPROM) && !pageStore.isIdle() )
     {
-      // look at what the received command is
-      char cmd = readChar();
-      switch ( cmd )
-      {
-        // proper commands
-        case 'E': processEchoCommand(); break;
-        case 'b': processGetButtonStateCommand(); break;
-        case 'l': processGetLedBrightnessCommand(); break;
-        case 'L': processSetLedBrightnessCommand(); break;
-        case 'M': processSetMulticolourLedColourCommand(); break;
-        case 'C': processClearLcdCommand(); break;
-        case 'T': processSetLcdTextCommand(); break;
-        case 'P': processSetCursorCommand(); break;
-        case 'N': processSetBigNumberCommand(); break;
-        
-        // ignore extraneous bytes
-        case CHAR_LF: break;
-        case CHAR_CR: break;
-        case '\0'   : break;
-        
-        // everything else is wrong
-        default : Serial.println('?'); break;
-      }
-      // prepare for next command: reset read buffer
-      rxBufferIdx = 0;
-      rxReadIdx   = 0;
+      return;
     }
-    else if ( rxBufferIdx < rxBufferMax-1 )
-    {
-      // read a byte: advance read buffer index
-      rxBufferIdx++;
-    }    
+    parseChar((char) Serial.read());
   }
 }
 
 
 /**
- * Returns the number of characters available in the receive buffer.
+ * Decodes the next received character of a command.
+ * Parameters are numbers or strings in quotation marks,
+ * separated by commas, spaces or tabs.
+ * Each parameter is checked against the parameter schema of the command as soon as it is complete.
  *
- * @return number of characters available
+ * @param c the received character
  */
-byte charsAvailable()
+void parseChar(char c)
 {
-  return rxBufferIdx - rxReadIdx;
+  if ( (c == CHAR_LF) || (c == CHAR_CR) )
+  {
+    finishCommand();
+    return;
+  }
+  
+  switch ( parseState )
+  {
+    case PARSE_IDLE:
+    {
+      cmdScheduled = (c == '@');
+      if ( cmdScheduled )
+      {
+        // execution time before the command character
+        parseCmdIdx  = -1;
+        cmdExecuteAt = 0;
+        parseState   = PARSE_TIME;
+      }
+      else
+      {
+        startCommand(c);
+      }
+      break;
+    }
+    
+    case PARSE_TIME:
+    {
+      if ( (c >= '0') && (c <= '9') )
+      {
+        // the time wraps around like micros()
+        cmdExecuteAt = (cmdExecuteAt * 10) + (c - '0');
+      }
+      else
+      {
+        startCommand(c);
+      }
+      break;
+    }
+    
+    case PARSE_PARAMS:
+    {
+      startParameter(c);
+      break;
+    }
+    
+    case PARSE_NUMBER:
+    {
+      if ( (c >= '0') && (c <= '9') )
+      {
+        // number stops growing instead of overflowing
+        CommandParam& param = cmdParams[cmdParamCount - 1];
+        if ( param.value < 100000000L )
+        {
+          param.value = (param.value * 10) + (c - '0');
+        }
+        param.length++;
+      }
+      else if ( endParameter() )
+      {
+        startParameter(c);
+      }
+      break;
+    }
+    
+    case PARSE_STRING:
+    {
+      if ( c == '"' )
+      {
+        endParameter();
+      }
+      else
+      {
+        addStringChar(c);
+      }
+      break;
+    }
+    
+    default:
+    {
+      // error: ignore the rest of the line
+      break;
+    }
+  }
 }
 
 
 /**
- * Reads the next character from the receive buffer
- * and advances the read pointer.
+ * Starts decoding a command.
  *
- * @return next received character or '\0' if there is no next character
+ * @param cmd the command character
  */
-char readChar()
+void startCommand(char cmd)
 {
-  char c = pollChar();
-  // is there a next character?
-  if ( c != '\0' )
+  cmdParamCount = 0;
+  rxBufferIdx   = 0;
+  parseCmdIdx   = findCommand(cmd);
+  if ( parseCmdIdx < 0 )
+  {
+    parseState = PARSE_ERROR; // unknown command
+    return;
+  }
+  
+  memcpy_P(&parseCmd, &commandTable[parseCmdIdx], sizeof(parseCmd));
+  if ( (parseCmd.flags & CMD_FLAG_LCD) && (iDisplayCount == 0) )
+  {
+    parseState = PARSE_ERROR; // no LCD connected
+    return;
+  }
+  if ( cmdScheduled && !(parseCmd.flags & CMD_FLAG_DEFER) )
+  {
+    // only commands that can be queued can be scheduled.
+    // This happens before decoding, because text goes into the LCD buffer while it is received
+    parseState = PARSE_ERROR;
+    return;
+  }
+  if ( parseCmd.flags & CMD_FLAG_SYNC )
   {
-    // if so, advance read pointer
-    rxReadIdx++;
+    // command depends on the result of the queued commands.
+    // This happens before decoding, because text goes into the LCD buffer while it is received
+    while ( executeWork() ) { }
   }
-  return c;
+  parseState = PARSE_PARAMS;
 }
 
 
 /**
- * Reads the next character from the receive buffer
- * but does not advance the read pointer.
+ * Starts decoding a parameter or skips a separator.
  *
- * @return next received character or '\0' if there is no next character
+ * @param c the first character of the parameter or a separator
  */
-char pollChar()
+void startParameter(char c)
 {
-  char c = '\0';
-  // is there a next character?
-  if ( charsAvailable() > 0 ) 
+  parseState = PARSE_PARAMS;
+  if ( (c == ',') || (c == ' ') || (c == '\t') )
   {
-    c = rxBuffer[rxReadIdx];
+    return;
+  }
+  if ( cmdParamCount >= CMD_MAX_PARAMS )
+  {
+    parseState = PARSE_ERROR; // too many parameters
+    return;
+  }
+  
+  CommandParam& param = cmdParams[cmdParamCount++];
+  param.value  = 0;
+  param.length = 0;
+  param.start  = rxBufferIdx;
+  if ( c == '"' )
+  {
+    param.isString = true;
+    if ( getParameterType(cmdParamCount - 1) != CMD_PARAM_STRING )
+    {
+      parseState = PARSE_ERROR;
+      return;
+    }
+    if ( parseCmd.flags & CMD_FLAG_TEXT )
+    {
+      startText();
+    }
+    parseState = PARSE_STRING;
+  }
+  else if ( (c >= '0') && (c <= '9') )
+  {
+    param.isString = false;
+    param.value    = c - '0';
+    param.length   = 1;
+    parseState     = PARSE_NUMBER;
+  }
+  else
+  {
+    parseState = PARSE_ERROR; // neither a number nor a string
   }
-  return c;
 }
 
 
 /**
- * Checks if there is a next parameter.
+ * Adds a character to the current string parameter.
+ * Text for the LCD goes directly into the text buffer.
  *
- * @return <code>true</code> if there is a next parameter,
- *         <code>false</code> if not
+ * @param c the character to add
  */
-boolean hasNextParameter()
+void addStringChar(char c)
 {
-  // skip any whitespace
-  boolean skipChar = false;
-  do
+  CommandParam& param = cmdParams[cmdParamCount - 1];
+  if ( parseCmd.flags & CMD_FLAG_TEXT )
   {
-    char c = pollChar();
-    skipChar = ( (c == ',') || (c == ' ') || (c == '\t') );
-    if ( skipChar )
-    {
-      // "consume" skippable characters
-      c = readChar();
-    }
-  } while ( (charsAvailable() > 0) && skipChar);
-    
-  // is there more inthe receive buffer? yes: must be a next parameter
-  return (charsAvailable() > 0);
+    addTextChar(c);
+  }
+  else if ( rxBufferIdx < rxBufferMax )
+  {
+    rxBuffer[rxBufferIdx++] = c;
+    if ( rxBufferIdx > rxBufferPeak ) rxBufferPeak = rxBufferIdx;
+  }
+  else
+  {
+    // string buffer full
+    perfRxOverflows++;
+    parseState = PARSE_ERROR;
+    return;
+  }
+  param.value++;
+  param.length++;
 }
 
 
 /**
- * Checks if there is a next parameter and if it is a number.
+ * Finishes the current parameter and checks it against the parameter schema.
  *
- * @return <code>true</code> if there is a next integer parameter,
+ * @return <code>true</code> if the parameter is valid,
  *         <code>false</code> if not
  */
-boolean hasInt()
+boolean endParameter()
 {
-  char c = pollChar();
-  return (c >= '0') && (c <= '9');
+  byte type = getParameterType(cmdParamCount - 1);
+  boolean valid = (type != '\0') && checkParameter(type, cmdParams[cmdParamCount - 1]);
+  parseState = valid ? PARSE_PARAMS : PARSE_ERROR;
+  return valid;
 }
 
 
 /**
- * Reads the next integer value from the receive buffer
- * and advances the read pointer to the last valid digit.
- *
- * @return next received integer or -1 if there is no next integer
+ * Executes the command that has been decoded when the line terminator is received.
+ * Commands that fail or have invalid parameters are answered with '!',
+ * unknown commands with '?'.
  */
-int readInt()
+void finishCommand()
 {
-  int i = -1;
-  boolean isNumeric;
-  do 
+  unsigned long receivedTime = micros();
+  
+  // finish a number or a string without terminating "
+  if ( (parseState == PARSE_NUMBER) || (parseState == PARSE_STRING) )
   {
-    char c = pollChar();
-    isNumeric = (c >= '0') && (c <= '9');
-    
-    if ( isNumeric )
+    endParameter();
+  }
+  
+  if ( parseState == PARSE_IDLE )
+  {
+    // ignore empty lines (e.g., LF after CR)
+  }
+  else if ( parseCmdIdx < 0 )
+  {
+    Serial.println('?');
+    perfUnknownCommands++;
+  }
+  else
+  {
+    boolean success = (parseState != PARSE_ERROR) && (cmdParamCount >= getRequiredParameters());
+    unsigned long startTime = micros();
+    if ( success && cmdScheduled )
+    {
+      // startCommand() has rejected the commands that can not be queued
+      success = scheduleWork(parseCmdIdx);
+    }
+    else if ( success )
     {
-      c = readChar(); // actually read the character
-      // shift previous result one digit and add new digit
-      if ( i < 0 )
+      if ( parseCmd.flags & CMD_FLAG_DEFER )
       {
-        i = 0;
+        // execute later, if the queue is full: make space by executing the oldest commands now
+        while ( !enqueueWork(parseCmdIdx) && executeWork() ) { }
+      }
+      else
+      {
+        // commands with CMD_FLAG_SYNC have emptied the queue in startCommand()
+        success = parseCmd.handler(cmdParams, cmdParamCount);
       }
-      i = (i * 10) + (c-'0');
     }
-  } while ( isNumeric );
-  
-  return i;
+    
+    if ( !success )
+    {
+      Serial.println(ERROR_CHAR);
+    }
+    else if ( parseCmd.flags & CMD_FLAG_ACK )
+    {
+      Serial.println(SUCCESS_CHAR);
+    }
+    
+    // the host confirms a new serial speed with the E command,
+    // other commands might have been misread at the wrong speed
+    if ( success && (parseCmd.cmd == 'E') )
+    {
+      serialSpeedPending = false;
+    }
+    recordLatency(parseCmdIdx, receivedTime, startTime, micros());
+  }
+  parseState = PARSE_IDLE;
 }
 
 
 /**
- * Checks if there is a next parameter and if it is a string.
+ * Finds a command in the command table.
  *
- * @return <code>true</code> if there is a next string parameter,
- *         <code>false</code> if not
+ * @param cmd the command character
+ * @return index of the command in the table or -1 if the command is unknown
  */
-boolean hasString()
+int findCommand(char cmd)
 {
-  char c = pollChar();
-  return (c == '"');
+  for ( byte i = 0 ; i < ARRSIZE(commandTable) ; i++ )
+  {
+    if ( (char) pgm_read_byte(&commandTable[i].cmd) == cmd )
+    {
+      return i;
+    }
+  }
+  return -1;
 }
 
 
 /**
- * Reads a string enclosed in quotation marks from the receive buffer
- * and advances the read pointer to the end of the terminating ".
+ * Gets the type of a parameter of the current command from its parameter schema.
  *
- * @return next received string or an empty string if there is no next string
+ * @param idx the index of the parameter
+ * @return the parameter type (see CommandInfo.h) or '\0' if the command has less parameters
  */
-String readString()
+char getParameterType(byte idx)
 {
-  String str = "";
-  // needs to start with a "
-  if ( readChar() == '"' )
+  for ( const char* pType = parseCmd.schema ; *pType != '\0' ; pType++ )
   {
-    // read characters to the next "
-    while ( charsAvailable() > 0 ) 
-    {
-      char c = readChar();
-      if ( c != '"' )
-      {
-        str += c;
-      }
-      else
-      {
-        // found the terminating "
-        break;
-      }
-    }
+    if ( *pType == CMD_PARAM_OPTIONAL ) continue;
+    if ( idx == 0 ) return *pType;
+    idx--;
   }
-  return str;
+  return '\0';
 }
 
 
-/********************************************************************************
- * Methods for processing commands
- ********************************************************************************/
-
 /**
- * ECHO command was sent: return ID and serial number
+ * Gets the number of parameters of the current command that are not optional.
+ *
+ * @return the number of required parameters
  */
-void processEchoCommand()
+byte getRequiredParameters()
 {
-  Serial.print(MODULE_NAME); 
-  Serial.print(" ");
-  Serial.println(MODULE_VERSION);
+  byte count = 0;
+  for ( const char* pType = parseCmd.schema ; (*pType != '\0') && (*pType != CMD_PARAM_OPTIONAL) ; pType++ )
+  {
+    count++;
+  }
+  return count;
 }
 
 
 /**
- * Gets button state.
- * ba : a=Button number
+ * Checks if a parameter matches its type in the parameter schema.
+ *
+ * @param type  the parameter type (see CommandInfo.h)
+ * @param param the decoded parameter
+ * @return <code>true</code> if the parameter is valid,
+ *         <code>false</code> if not
  */
-void processGetButtonStateCommand()
+boolean checkParameter(char type, const CommandParam& param)
 {
-  int buttonIdx = readInt(); // Button index is first parameter
-  if ( (buttonIdx >= 0) && 
-       (buttonIdx < ARRSIZE(arrButtons)) && 
-       (arrButtons[buttonIdx] != NULL) )
+  if ( type == CMD_PARAM_STRING )
   {
-    // return button state (0,1)
-    Serial.print(arrButtons[buttonIdx]->isPressed() ? '1' : '0');
-    // return number of presses
-    Serial.println(arrButtons[buttonIdx]->getNumPresses());
+    return param.isString;
   }
-  else
+  if ( param.isString )
+  {
+    return false;
+  }
+  
+  if ( (type == CMD_PARAM_LED) || (type == CMD_PARAM_COLOUR_LED) )
+  {
+    // the LED has to exist, so queued commands can't fail later
+    if ( (param.value >= (long) ARRSIZE(arrLEDs)) || (arrLEDs[param.value] == NULL) )
+    {
+      return false;
+    }
+    return (type == CMD_PARAM_LED) || arrLEDs[param.value]->supportsColour();
+  }
+  
+  long maxValue;
+  switch ( type )
   {
-    Serial.println(ERROR_CHAR);
+    case CMD_PARAM_BUTTON   : maxValue = ARRSIZE(arrButtons) - 1; break;
+    case CMD_PARAM_BYTE     : maxValue = 255; break;
+    case CMD_PARAM_INTERVAL : maxValue = 65535L; break;
+    case CMD_PARAM_ROW      : maxValue = LCD_MAX_ROWS - 1; break;    // checked against the display by the command
+    case CMD_PARAM_COLUMN   : maxValue = LCD_MAX_COLUMNS - 1; break;
+    case CMD_PARAM_DISPLAY  : maxValue = iDisplayCount - 1; break;
+    case CMD_PARAM_FLAG     : maxValue = 1; break;
+    case CMD_PARAM_LONG     : return true;
+    case CMD_PARAM_DIGITS   : return true;
+    default                 : return false;
   }
+  return (param.value <= maxValue);
 }
 
+
+/********************************************************************************
+ * Methods for the work queue
+ ********************************************************************************/
+
 /**
- * Gets LED brightness
- * la : a=LED number
+ * Puts the current command with its decoded parameters into the work queue.
+ * The command is executed later by executeWork().
+ * Only number parameters are stored, commands with string parameters can't be queued.
+ * Each entry consists of the command index, the parameter count
+ * and the value (4 bytes) and the length (1 byte) of each parameter.
+ *
+ * @param cmdIdx the index of the command in the command table
+ * @return <code>true</code> if the command has been queued,
+ *         <code>false</code> if the queue is full
  */
-void processGetLedBrightnessCommand()
+boolean enqueueWork(byte cmdIdx)
 {
-  int ledIdx = readInt(); // LED index is first parameter
-  if ( (ledIdx >= 0) && 
-       (ledIdx < ARRSIZE(arrLEDs)) && 
-       (arrLEDs[ledIdx] != NULL) )
+  byte size = 2 + cmdParamCount * 5;
+  if ( workQueueUsed + size > sizeof(workQueue) )
   {
-    // return LED brightness
-    Serial.println(arrLEDs[ledIdx]->getBrightness());
+    return false;
   }
-  else
+  
+  byte pos = (workQueueHead + workQueueUsed) % sizeof(workQueue);
+  workQueue[pos] = cmdIdx;        pos = (pos + 1) % sizeof(workQueue);
+  workQueue[pos] = cmdParamCount; pos = (pos + 1) % sizeof(workQueue);
+  for ( byte i = 0 ; i < cmdParamCount ; i++ )
   {
-    Serial.println(ERROR_CHAR);
+    long value = cmdParams[i].value;
+    for ( byte b = 0 ; b < 4 ; b++ )
+    {
+      workQueue[pos] = value & 0xFF; pos = (pos + 1) % sizeof(workQueue);
+      value >>= 8;
+    }
+    workQueue[pos] = cmdParams[i].length; pos = (pos + 1) % sizeof(workQueue);
   }
+  workQueueUsed += size;
+  workQueueCount++;
+  return true;
 }
- 
+
 
 /**
- * Sets the LED brightness (and optionally blink parameters).
- * Ln,b[,i[,r]] : n=LED number, b=brightness (0-99), i=blink interval in ms, r=blink ratio (0-99)
+ * Executes the oldest command in the work queue.
+ *
+ * @return <code>true</code> if a command was executed,
+ *         <code>false</code> if the queue is empty
  */
-void processSetLedBrightnessCommand()
+boolean executeWork()
 {
-  boolean success = false;
-  // LED index is first parameter
-  int ledIdx = readInt(); 
-  if ( (ledIdx >= 0) && (ledIdx < ARRSIZE(arrLEDs)) && 
-       (arrLEDs[ledIdx] != NULL) &&
-       hasNextParameter() && hasInt() )
+  if ( workQueueCount == 0 )
   {
-    LED* pLed = arrLEDs[ledIdx];
-    
-    // LED brightness is second parameter
-    int brightness = readInt(); 
-    pLed->setBrightness(brightness);
-    
-    // optional blink interval in ms
-    if ( hasNextParameter() && hasInt() )
-    {
-      int interval = readInt();
-      pLed->setBlinkInterval(interval);
-    }
-    
-    // optional blink ratio in percent
-    if ( hasNextParameter() && hasInt() )
+    return false;
+  }
+  
+  // read entry
+  CommandParam params[CMD_MAX_PARAMS];
+  byte pos = workQueueHead;
+  byte cmdIdx     = workQueue[pos]; pos = (pos + 1) % sizeof(workQueue);
+  byte paramCount = workQueue[pos]; pos = (pos + 1) % sizeof(workQueue);
+  for ( byte i = 0 ; i < paramCount ; i++ )
+  {
+    long value = 0;
+    for ( byte b = 0 ; b < 4 ; b++ )
     {
-      int ratio = readInt();
-      pLed->setBlinkRatio(ratio);
+      value |= (long) workQueue[pos] << (b * 8); pos = (pos + 1) % sizeof(workQueue);
     }
-
-    success = true;
+    params[i].value    = value;
+    params[i].length   = workQueue[pos]; pos = (pos + 1) % sizeof(workQueue);
+    params[i].start    = 0;
+    params[i].isString = false;
   }
-  Serial.println(success ? SUCCESS_CHAR : ERROR_CHAR);
+  workQueueHead   = pos;
+  workQueueUsed  -= 2 + paramCount * 5;
+  workQueueCount--;
+  
+  runWork(cmdIdx, params, paramCount);
+  return true;
 }
 
 
 /**
- * Sets the colour (and optionally blink parameters) of a multicolour LED.
- * Mn,r,g,b,[,i[,r]] : n=LED number, r,g,b=RGB brightness (0-99), i=blink interval in ms, r=blink ratio (0-99)
+ * Executes a command from the work queue or the schedule queue.
+ *
+ * @param cmdIdx     the index of the command in the command table
+ * @param params     the parameters
+ * @param paramCount the number of parameters
  */
-void processSetMulticolourLedColourCommand()
-{
-  boolean success = false;
-  // LED index is first parameter
-  int ledIdx = readInt(); 
-  if ( (ledIdx >= 0) && (ledIdx < ARRSIZE(arrLEDs)) && 
-       (arrLEDs[ledIdx] != NULL) && arrLEDs[ledIdx]->supportsColour() &&
-       hasNextParameter() && hasInt() )
-  {
-    LED* pLed = arrLEDs[ledIdx];
-    // Red/Green/Blue brightness are the next three parameters
-    int red   = readInt(); hasNextParameter();
-    int green = readInt(); hasNextParameter();
-    int blue  = readInt(); 
-    if ( (red >= 0) && (green >=0) && (blue >= 0) )
-    {
-      pLed->setColour(red, green, blue);
-      
-      // optional blink interval in ms
-      if ( hasNextParameter() && hasInt() )
-      {
-        int interval = readInt();
-        pLed->setBlinkInterval(interval);
-      }
-      
-      // optional blink ratio in percent
-      if ( hasNextParameter() && hasInt() )
-      {
-        int ratio = readInt();
-        pLed->setBlinkRatio(ratio);
-      }
-  
-      success = true;
-    }
+void runWork(byte cmdIdx, const CommandParam* params, byte paramCount)
+{
+  CommandInfo info;
+  memcpy_P(&info, &commandTable[cmdIdx], sizeof(CommandInfo));
+  if ( !info.handler(params, paramCount) )
+  {
+    workFailed++;
   }
-  Serial.println(success ? SUCCESS_CHAR : ERROR_CHAR);
+  workExecuted++;
 }
 
 
 /**
- * Checks if the LCD panel is connected.
- * If so, initialises the LCD panel and sets the default text to the module name and version.
+ * Puts the current command with its decoded parameters and its execution time into the schedule queue.
+ * The queue is sorted by the execution time, commands with the same time stay in the order they were received.
+ * Each entry consists of the execution time (4 bytes), the command index, the parameter count
+ * and the value (4 bytes) and the length (1 byte) of each parameter.
+ *
+ * @param cmdIdx the index of the command in the command table
+ * @return <code>true</code> if the command has been scheduled,
+ *         <code>false</code> if the queue is full
  */
-void initializeLCD()
+boolean scheduleWork(byte cmdIdx)
 {
-  if ( checkLcdConnection() )
+  byte size = 6 + cmdParamCount * 5;
+  if ( scheduleUsed + size > sizeof(scheduleQueue) )
   {
-    pLCD = new Adafruit_RGBLCDShield();
-    
-    // set up the LCD's number of columns and rows: 
-    pLCD->begin(iLcdColumns, iLcdRows);
-    
-    // create text buffer
-    arrTextIn  = (char**) malloc(iLcdRows * sizeof(char*));
-    arrTextBuf = (char**) malloc(iLcdRows * sizeof(char*));
-    for ( int iRow = 0 ; iRow < iLcdRows ; iRow++ )
-    {
-      arrTextIn[iRow]  = (char*) malloc(iLcdColumns * sizeof(char));
-      arrTextBuf[iRow] = (char*) malloc(iLcdColumns * sizeof(char));
-      for ( int iCol = 0 ; iCol < iLcdColumns ; iCol++ )
-      {
-        arrTextIn[iRow][iCol]  = ' ';
-        arrTextBuf[iRow][iCol] = '\0'; // force update
-      }
-    }
-    bUpdateTextBufCounter = 2;
-    
-    // set the cursor to the top left position
-    pLCD->setCursor(0,0);
-    // print module name on the top line
-    pLCD->print(MODULE_NAME);
-    // move cursor to the bottom line
-    pLCD->setCursor(0,1);
-    // print version number
-    pLCD->print(MODULE_VERSION);
-
-    // create the backlight LED
-    LED* pBacklight = new LCD_Backlight(pLCD);
-    arrLEDs[9] = pBacklight;
-    // set the backlight to white
-    pBacklight->setColour(99, 99, 99);
-    pBacklight->setBrightness(99);
+    return false;
+  }
   
-    // define custom segments for big numbers
-    for ( int i = 0 ; i < ARRSIZE(bigNumberSegments) ; i++ )
+  // find the first entry with a later execution time (the times can wrap around)
+  byte pos = 0;
+  while ( (pos < scheduleUsed) && ((long) (getScheduleTime(pos) - cmdExecuteAt) <= 0) )
+  {
+    pos += 6 + scheduleQueue[pos + 5] * 5;
+  }
+  memmove(&scheduleQueue[pos + size], &scheduleQueue[pos], scheduleUsed - pos);
+  
+  unsigned long time = cmdExecuteAt;
+  for ( byte b = 0 ; b < 4 ; b++ )
+  {
+    scheduleQueue[pos++] = time & 0xFF;
+    time >>= 8;
+  }
+  scheduleQueue[pos++] = cmdIdx;
+  scheduleQueue[pos++] = cmdParamCount;
+  for ( byte i = 0 ; i < cmdParamCount ; i++ )
+  {
+    long value = cmdParams[i].value;
+    for ( byte b = 0 ; b < 4 ; b++ )
     {
-      pLCD->createChar(i, bigNumberSegments[i]);
+      scheduleQueue[pos++] = value & 0xFF;
+      value >>= 8;
     }
+    scheduleQueue[pos++] = cmdParams[i].length;
   }
+  scheduleUsed += size;
+  scheduleCount++;
+  return true;
 }
 
 
 /**
- * Sets the cursor to a defined position
- * default positions are row - 0 and column - 0
- * e.g. P1,2 shifts the cursor to row 1, column 2,
- * any text printed afterwards will start from this location
+ * Gets the execution time of an entry of the schedule queue.
+ *
+ * @param pos the position of the entry in the queue
+ * @return the execution time in us
  */
-void processSetCursorCommand()
+unsigned long getScheduleTime(byte pos)
 {
-  if ( pLCD == NULL )
-  {
-    // no LCD connected -> get me out of here
-    Serial.println(ERROR_CHAR);
-    return;
-  } 
-  
-  // read any integers passed through
-  iCursorRow = readInt(); 
-  iCursorCol = 0;
-  if ( hasNextParameter() ) // column is optional
+  unsigned long time = 0;
+  for ( byte b = 0 ; b < 4 ; b++ )
   {
-     iCursorCol = readInt();
+    time |= (unsigned long) scheduleQueue[pos + b] << (b * 8);
   }
-  
-  Serial.println(SUCCESS_CHAR);
+  return time;
 }
 
 
 /**
- * Sets received numbers to display in big font on the LCD screen
- * e.g. N123 will print 123 in big font on the screen
+ * Executes the scheduled commands whose execution time has come.
+ *
+ * @return <code>true</code> if the next scheduled command is due within SCHEDULE_GUARD_TIME,
+ *         <code>false</code> if not
  */
-void processSetBigNumberCommand()
+boolean executeScheduledWork()
 {
-  int cursorIterator = 0; // Iterator for large font locations
-  while(charsAvailable() > 0)
+  while ( scheduleCount > 0 )
   {
-    int num = readChar() - '0';
-    if ( (num >=0) && (num <= 9) )
+    unsigned long now   = micros();
+    long          delay = (long) (now - getScheduleTime(0));
+    if ( delay < 0 )
+    {
+      return (-delay < (long) SCHEDULE_GUARD_TIME);
+    }
+    if ( (unsigned long) delay > scheduleDelayMax ) scheduleDelayMax = delay;
+    
+    // remove the first entry, then execute it
+    CommandParam params[CMD_MAX_PARAMS];
+    byte pos        = 4;
+    byte cmdIdx     = scheduleQueue[pos++];
+    byte paramCount = scheduleQueue[pos++];
+    for ( byte i = 0 ; i < paramCount ; i++ )
     {
-      byte arrIter = 0; // iterator through character array
-      for ( byte y = 0 ; y < 2 ; y++ ) // two lines
+      long value = 0;
+      for ( byte b = 0 ; b < 4 ; b++ )
       {
-        pLCD->setCursor(cursorIterator, y);
-        for ( byte x = 0 ; x < 3 ; x++ ) // three chars each line
-        {
-          pLCD->write(bigNumberChars[num][arrIter++]);
-        }
+        value |= (long) scheduleQueue[pos++] << (b * 8);
       }
-      cursorIterator += 4; // advance cursor 4 spaces
+      params[i].value    = value;
+      params[i].length   = scheduleQueue[pos++];
+      params[i].start    = 0;
+      params[i].isString = false;
     }
+    scheduleUsed -= pos;
+    memmove(&scheduleQueue[0], &scheduleQueue[pos], scheduleUsed);
+    scheduleCount--;
+    
+    runWork(cmdIdx, params, paramCount);
   }
-   
-  //use cursor iterator to check if anything was printed 
-  if ( cursorIterator > 0 )
+  return false;
+}
+
+
+/********************************************************************************
+ * Methods for processing commands
+ ********************************************************************************/
+
+/**
+ * ECHO command was sent: return ID and serial number
+ */
+boolean processEchoCommand(const CommandParam* /* params */, byte /* paramCount */)
+{
+  Serial.print(getText(MODULE_NAME)); 
+  Serial.print(' ');
+  Serial.println(getText(MODULE_VERSION));
+  return true;
+}
+
+
+/**
+ * Gets the description of the module, so that the host can configure itself with one request.
+ * I : returns sections separated by semicolons:
+ *     the echo text (see processEchoCommand), 'P' protocol version,
+ *     'C' the characters of all supported commands, 'B' the fastest serial speed,
+ *     'D' the geometry of each connected LCD as columns x rows,
+ *     'L' the type of each LED (see LED_TYPE_..., '-': not present), 'K' the number of buttons,
+ *     'F' the number of number fields, 'A' the number of scrolling text regions, 'U' the number of screen pages,
+ * e.g. "JetBlack IO-Box v1.20;P1;CBEIbl...;B1000000;D16x2;Laaamaaamdb---;K3;F8;A2;U6"
+ */
+boolean processGetInfoCommand(const CommandParam* /* params */, byte /* paramCount */)
+{
+  Serial.print(getText(MODULE_NAME));
+  Serial.print(' ');
+  Serial.print(getText(MODULE_VERSION));
+  Serial.print(F(";P"));
+  Serial.print(PROTOCOL_VERSION);
+  Serial.print(F(";C"));
+  for ( byte i = 0 ; i < ARRSIZE(commandTable) ; i++ )
   {
-    Serial.println(SUCCESS_CHAR);  
-    cursorIterator = 0; 
-  } 
-  else
+    Serial.print((char) pgm_read_byte(&commandTable[i].cmd));
+  }
+  Serial.print(F(";B"));
+  Serial.print(pgm_read_dword(&arrSerialSpeeds[ARRSIZE(arrSerialSpeeds) - 1]));
+  Serial.print(F(";D"));
+  for ( byte i = 0 ; i < iDisplayCount ; i++ )
+  {
+    if ( i > 0 ) Serial.print(',');
+    Serial.print(arrDisplays[i].getColumns());
+    Serial.print('x');
+    Serial.print(arrDisplays[i].getRows());
+  }
+  Serial.print(F(";L"));
+  for ( byte i = 0 ; i < ARRSIZE(arrLEDs) ; i++ )
   {
-     //deemed unsuccessful if nothing was printed
-     Serial.println(ERROR_CHAR);
-  }  
+    Serial.print((arrLEDs[i] != NULL) ? arrLEDs[i]->getType() : '-');
+  }
+  Serial.print(F(";K"));
+  Serial.print(ARRSIZE(arrButtons));
+  Serial.print(F(";F"));
+  Serial.print(ARRSIZE(arrFields));
+  Serial.print(F(";A"));
+  Serial.print(ARRSIZE(arrMarquees));
+  Serial.print(F(";U"));
+  Serial.println(PAGE_COUNT);
+  return true;
 }
 
 
 /**
- * Clears the text on the LCD panel.
+ * Switches the serial speed.
+ * Bs : s=new speed in baud
+ * The reply is sent at the old speed, then the speed changes.
  */
-void processClearLcdCommand()
-{  
-  if ( pLCD == NULL )
+boolean processSetSerialSpeedCommand(const CommandParam* params, byte /* paramCount */)
+{
+  long speed = params[0].value;
+  for ( byte i = 0 ; i < ARRSIZE(arrSerialSpeeds) ; i++ )
   {
-    // no LCD connected -> get me out of here
-    Serial.println(ERROR_CHAR);
-    return;
+    if ( speed == (long) pgm_read_dword(&arrSerialSpeeds[i]) )
+    {
+      Serial.println(SUCCESS_CHAR);
+      setSerialSpeed(speed);
+      // wait for the host to confirm the new speed
+      serialSpeedPending  = true;
+      serialSpeedDeadline = millis() + SERIAL_SPEED_VERIFY_TIME;
+      return true;
+    }
   }
+  return false;
+}
+
+
+/**
+ * Changes the serial speed after all pending output has been sent.
+ *
+ * @param speed the new serial speed in baud
+ */
+void setSerialSpeed(unsigned long speed)
+{
+  Serial.flush(); // wait for pending output
+  Serial.end();
+  Serial.begin(speed);
+}
+
+
+/**
+ * Gets the free RAM information.
+ * R : returns free RAM, lowest free RAM since startup and peak string buffer usage (in bytes)
+ */
+boolean processGetFreeRamCommand(const CommandParam* /* params */, byte /* paramCount */)
+{
+  Serial.print(getFreeRam());
+  Serial.print(',');
+  Serial.print(getMinFreeRam());
+  Serial.print(',');
+  Serial.println(rxBufferPeak);
+  return true;
+}
+
+
+/**
+ * Gets the state of the work queue.
+ * Q : returns the number of queued commands, the number of executed commands since startup,
+ *     the number of commands that failed during execution, the number of scheduled commands
+ *     and the longest time in us that a scheduled command was executed after its execution time,
+ *     e.g., "2,1534,0,3,412".
+ *     When the first number is 0, all acknowledged commands without an execution time have been executed.
+ */
+boolean processGetWorkQueueCommand(const CommandParam* /* params */, byte /* paramCount */)
+{
+  Serial.print(workQueueCount);
+  Serial.print(',');
+  Serial.print(workExecuted);
+  Serial.print(',');
+  Serial.print(workFailed);
+  Serial.print(',');
+  Serial.print(scheduleCount);
+  Serial.print(',');
+  Serial.println(scheduleDelayMax);
+  return true;
+}
+
+
+/**
+ * Gets the time of the module.
+ * Y : returns the result of micros(), e.g., "81250000".
+ *     The host sends this command several times and uses the answer with the shortest round trip
+ *     to estimate the offset between its clock and the clock of the module (see the @ prefix).
+ */
+boolean processGetTimeCommand(const CommandParam* /* params */, byte /* paramCount */)
+{
+  Serial.println(micros());
+  return true;
+}
+
+
+/**
+ * Gets the performance statistics.
+ * S[r] : r=1: reset the counters after sending them
+ * returns loop iterations in the last second, longest loop time in us, receive buffer overflows,
+ * characters waiting for the LCD refresh, longest LCD refresh in ms, I2C transfers, unknown commands
+ * and the effective refresh rate of the backlight dithering in the last second
+ * (lowest number of times a colour channel with a duty cycle between 0% and 100% was switched on, 0: no dithering),
+ * e.g. "8534,1880,0,2,64,1210,0,412"
+ */
+boolean processGetStatisticsCommand(const CommandParam* params, byte paramCount)
+{
+  Serial.print(perfLoopsPerSecond);
+  Serial.print(',');
+  Serial.print(perfLoopTimeMax);
+  Serial.print(',');
+  Serial.print(perfRxOverflows);
+  Serial.print(',');
+  Serial.print(getDirtyCharacters());
+  Serial.print(',');
+  Serial.print(perfLcdBusyMax);
+  Serial.print(',');
+  Serial.print(Adafruit_MCP23017::transactionCount);
+  Serial.print(',');
+  Serial.print(perfUnknownCommands);
+  Serial.print(',');
+  Serial.println(LCD_Backlight::getDitherRate());
   
-  for ( int iRow = 0 ; iRow < iLcdRows ; iRow++ )
+  if ( (paramCount > 0) && (params[0].value == 1) )
   {
-    for ( int iCol = 0 ; iCol < iLcdColumns ; iCol++ )
+    resetStatistics();
+  }
+  return true;
+}
+
+
+/**
+ * Gets the command latency histograms.
+ * H[r] : r=1: reset the histograms after sending them
+ * returns the histogram of the loop time, the histogram of the LCD settle time
+ * and the latency histograms of all commands that have been received, separated by semicolons.
+ * Each histogram contains the counts for <64, <256, <1024, <4096, <16384 and >=16384 units.
+ * The loop time histogram starts with '*', its unit is us.
+ * The LCD settle time histogram starts with '#', its unit is ms.
+ * The command histograms start with the command character, their unit is us.
+ * They end with the longest delay between line terminator and execution start
+ * (including the decoding of the parameters) in us,
+ * e.g. "*8120,310,2,0,0,0;#0,12,1,0,0,0;E1,0,0,0,0,0/12;T0,25,3,0,0,0/16"
+ */
+boolean processGetHistogramsCommand(const CommandParam* params, byte paramCount)
+{
+  Serial.print('*');
+  histLoopTime.print(Serial);
+  Serial.print(F(";#"));
+  histLcdSettle.print(Serial);
+  for ( byte i = 0 ; i < ARRSIZE(histLatency) ; i++ )
+  {
+    if ( !histLatency[i].isEmpty() )
     {
-      arrTextIn[iRow][iCol]  = ' ';
+      Serial.print(';');
+      Serial.print((char) pgm_read_byte(&commandTable[i].cmd));
+      histLatency[i].print(Serial);
+      Serial.print('/');
+      Serial.print(histDelayMax[i]);
     }
   }
-  iCursorRow = 0;
-  iCursorCol = 0;
-  bUpdateTextBufCounter = 2;
+  Serial.println();
+  
+  if ( (paramCount > 0) && (params[0].value == 1) )
+  {
+    resetHistograms();
+  }
+  return true;
+}
+
+
+/**
+ * Adds the timing of a command to its latency histogram.
+ *
+ * @param idx          the index of the command in the command table
+ * @param receivedTime time in us when the line terminator was received
+ * @param startTime    time in us when the execution started
+ * @param replyTime    time in us when the reply was sent
+ */
+void recordLatency(byte idx, unsigned long receivedTime, unsigned long startTime, unsigned long replyTime)
+{
+  histLatency[idx].add(replyTime - receivedTime);
+  unsigned long waitTime = startTime - receivedTime;
+  if ( waitTime > histDelayMax[idx] )
+  {
+    histDelayMax[idx] = (waitTime < 0xFFFF) ? waitTime : 0xFFFF;
+  }
+}
+
+
+/**
+ * Resets the command latency histograms.
+ */
+void resetHistograms()
+{
+  histLoopTime.reset();
+  histLcdSettle.reset();
+  for ( byte i = 0 ; i < ARRSIZE(histLatency) ; i++ )
+  {
+    histLatency[i].reset();
+    histDelayMax[i] = 0;
+  }
+}
+
+
+/**
+ * Resets the performance counters.
+ */
+void resetStatistics()
+{
+  perfLoopTimeValid   = false;
+  perfLoopTimeMax     = 0;
+  perfRxOverflows     = 0;
+  perfUnknownCommands = 0;
+  perfLcdBusyMax      = 0;
+  perfLcdBusy         = false;
+  Adafruit_MCP23017::transactionCount = 0;
+}
+
+
+/**
+ * Gets button state.
+ * ba : a=Button number
+ */
+boolean processGetButtonStateCommand(const CommandParam* params, byte /* paramCount */)
+{
+  Button* pButton = arrButtons[params[0].value];
+  if ( pButton == NULL ) return false;
+  
+  // return button state (0,1)
+  Serial.print(pButton->isPressed() ? '1' : '0');
+  // return number of presses
+  Serial.println(pButton->getNumPresses());
+  return true;
+}
+
+/**
+ * Gets LED brightness
+ * la : a=LED number
+ */
+boolean processGetLedBrightnessCommand(const CommandParam* params, byte /* paramCount */)
+{
+  LED* pLed = arrLEDs[params[0].value];
+  if ( pLed == NULL ) return false;
+  
+  // return LED brightness
+  Serial.println(pLed->getBrightness());
+  return true;
+}
+ 
+
+/**
+ * Sets the LED brightness (and optionally blink parameters).
+ * Ln,b[,i[,r]] : n=LED number, b=brightness (0-99), i=blink interval in ms, r=blink ratio (0-99)
+ */
+boolean processSetLedBrightnessCommand(const CommandParam* params, byte paramCount)
+{
+  LED* pLed = arrLEDs[params[0].value];
+  if ( pLed == NULL ) return false;
+  
+  pLed->setBrightness(params[1].value);
+  // optional blink interval in ms and blink ratio in percent
+  if ( paramCount > 2 ) pLed->setBlinkInterval(params[2].value);
+  if ( paramCount > 3 ) pLed->setBlinkRatio(params[3].value);
+  return true;
+}
+
+
+/**
+ * Sets the colour (and optionally blink parameters) of a multicolour LED.
+ * Mn,r,g,b,[,i[,r]] : n=LED number, r,g,b=RGB brightness (0-99), i=blink interval in ms, r=blink ratio (0-99)
+ */
+boolean processSetMulticolourLedColourCommand(const CommandParam* params, byte paramCount)
+{
+  LED* pLed = arrLEDs[params[0].value];
+  if ( (pLed == NULL) || !pLed->supportsColour() ) return false;
+  
+  pLed->setColour(params[1].value, params[2].value, params[3].value);
+  // optional blink interval in ms and blink ratio in percent
+  if ( paramCount > 4 ) pLed->setBlinkInterval(params[4].value);
+  if ( paramCount > 5 ) pLed->setBlinkRatio(params[5].value);
+  return true;
+}
+
+
+/**
+ * Looks for LCD panels on all MCP23017 addresses.
+ * The initialisation of each panel found is started, it runs in the main loop (see LcdDisplay::refresh()).
+ * The module name and version are written into the text buffer,
+ * and the backlight becomes accessible as LED 9, 10, ...
+ * The LED on the spare pin of the shield with address 0 becomes accessible as LED 13.
+ * Commands for the LCDs can be executed straight away, they only change the text buffers.
+ */
+void initializeDisplays()
+{
+  byte arrAddresses[LCD_MAX_DISPLAYS];
+  Wire.begin();
+  for ( byte addr = 0 ; (addr < 8) && (iDisplayCount < LCD_MAX_DISPLAYS) ; addr++ )
+  {
+    if ( checkLcdConnection(addr) )
+    {
+      arrAddresses[iDisplayCount] = addr;
+      iDisplayCount++;
+    }
+  }
+  layoutDisplays();
+  
+  for ( byte i = 0 ; i < iDisplayCount ; i++ )
+  {
+    LcdDisplay& display = arrDisplays[i];
+    // custom segments for big numbers
+    display.setGlyphs(&bigNumberSegments[0][0], ARRSIZE(bigNumberSegments));
+    display.begin(arrAddresses[i]);
+    
+    // print module name on the top line and version number on the bottom line
+    display.print(getText(MODULE_NAME));
+    display.setCursor(1, 0);
+    display.print(getText(MODULE_VERSION));
+    display.setCursor(0, 0);
     
-  Serial.println(SUCCESS_CHAR); 
+    // activate the backlight LED
+    LED* pBacklight = display.getBacklight();
+    arrLEDs[LED_BACKLIGHT + i] = pBacklight;
+    // set the backlight to white
+    pBacklight->setColour(99, 99, 99);
+    pBacklight->setBrightness(99);
+
+    if ( (arrAddresses[i] == 0) && ledShield0.begin() )
+    {
+      arrLEDs[LED_SHIELD] = &ledShield0;
+    }
+  }
 }
 
 
 /**
- * Sets the text to display on the LCD panel
- * 'T' followed by the text to display within quotation marks "text"
+ * Distributes the text buffer memory among the displays according to their geometry.
+ * Displays whose buffer moves are cleared.
+ *
+ * @return <code>true</code> if the buffers of all displays fit into the memory,
+ *         <code>false</code> if not (nothing is changed in this case)
  */
-void processSetLcdTextCommand()
-{  
-  if ( pLCD == NULL )
+boolean layoutDisplays()
+{
+  int textSize  = 0;
+  int dirtySize = 0;
+  for ( byte i = 0 ; i < iDisplayCount ; i++ )
   {
-    // no LCD connected -> get me out of here
-    Serial.println(ERROR_CHAR);
-    return;
+    textSize  += arrDisplays[i].getBufferSize();
+    dirtySize += (arrDisplays[i].getCells() + 7) / 8;
+  }
+  if ( (textSize > (int) ARRSIZE(arrTextPool)) || (dirtySize > (int) ARRSIZE(arrDirtyPool)) )
+  {
+    return false;
+  }
+  
+  char* pText  = arrTextPool;
+  byte* pDirty = arrDirtyPool;
+  for ( byte i = 0 ; i < iDisplayCount ; i++ )
+  {
+    LcdDisplay& display = arrDisplays[i];
+    if ( display.getBuffer() != pText )
+    {
+      display.setBuffer(pText, pDirty);
+    }
+    pText  += display.getBufferSize();
+    pDirty += (display.getCells() + 7) / 8;
+  }
+  return true;
+}
+
+
+/**
+ * Gets the number of characters that are not shown on the LCDs yet.
+ *
+ * @return number of characters waiting for the LCD refresh
+ */
+int getDirtyCharacters()
+{
+  int count = 0;
+  for ( byte i = 0 ; i < iDisplayCount ; i++ )
+  {
+    count += arrDisplays[i].getDirtyCount();
+  }
+  return count;
+}
+
+
+/**
+ * Sets the cursor to a defined position
+ * default positions are row - 0 and column - 0
+ * e.g. P1,2 shifts the cursor to row 1, column 2,
+ * any text printed afterwards will start from this location.
+ * The optional third parameter selects the display (default: 0), e.g. P0,0,1
+ */
+boolean processSetCursorCommand(const CommandParam* params, byte paramCount)
+{
+  iCurrentDisplay = (paramCount > 2) ? params[2].value : 0; // display is optional
+  byte col        = (paramCount > 1) ? params[1].value : 0; // column is optional
+  return arrDisplays[iCurrentDisplay].setCursor(params[0].value, col);
+}
+
+
+/**
+ * Sets the geometry of a display.
+ * Gc,r[,d[,b]] : c=columns, r=rows, d=display (default: 0), b=1: back buffer (default: 0)
+ * e.g. G20,4 for a 20x4 display or G40,2 for a 40x2 display,
+ * G16,2,0,1 for a 16x2 display whose text is shown with the X command.
+ * The LCD is initialised again and the text is cleared,
+ * its scrolling text regions are stopped and its number fields are removed.
+ * The text of the displays after d is cleared as well because their buffers move.
+ * The back buffer needs as much memory as the text itself.
+ */
+boolean processSetGeometryCommand(const CommandParam* params, byte paramCount)
+{
+  byte columns = params[0].value;
+  byte rows    = params[1].value;
+  if ( (columns < 1) || (columns > LCD_MAX_COLUMNS) ||
+       (rows    < 1) || (rows    > LCD_MAX_ROWS) ||
+       (columns * rows > LCD_MAX_CELLS) )
+  {
+    return false;
+  }
+  
+  LcdDisplay& display = arrDisplays[(paramCount > 2) ? params[2].value : 0];
+  byte    oldColumns  = display.getColumns();
+  byte    oldRows     = display.getRows();
+  boolean oldBuffered = display.isDoubleBuffered();
+  display.setGeometry(columns, rows);
+  display.setDoubleBuffered((paramCount > 3) && (params[3].value == 1));
+  if ( !layoutDisplays() )
+  {
+    // not enough memory for the text buffer
+    display.setGeometry(oldColumns, oldRows);
+    display.setDoubleBuffered(oldBuffered);
+    return false;
+  }
+  display.begin(display.getAddress());
+  stopMarquees(&display);
+  removeFields(&display);
+  return true;
+}
+
+
+/**
+ * Starts or stops a scrolling text region.
+ * An,r,c,w,i[,"string"[,d]] : n=region (0-1), r=row, c=first column, w=width, i=scroll interval in ms,
+ *                             d=display (default: 0)
+ * e.g. A0,1,0,16,300,"Warning: fuel low" scrolls the text through the bottom row every 300ms.
+ * A text that fits into the region does not scroll.
+ * Without a string or with an interval of 0, the region stops and the text stays where it is.
+ */
+boolean processSetMarqueeCommand(const CommandParam* params, byte paramCount)
+{
+  if ( params[0].value >= (long) ARRSIZE(arrMarquees) ) return false;
+  
+  Marquee& marquee = arrMarquees[params[0].value];
+  if ( (paramCount < 6) || (params[4].value == 0) )
+  {
+    marquee.stop();
+    return true;
+  }
+  
+  LcdDisplay& display = arrDisplays[(paramCount > 6) ? params[6].value : 0];
+  byte row   = params[1].value;
+  byte col   = params[2].value;
+  byte width = params[3].value;
+  if ( (row >= display.getRows()) || (width < 1) || (col + width > display.getColumns()) )
+  {
+    return false;
+  }
+  
+  marquee.start(&display, row, col, width, params[4].value, &rxBuffer[params[5].start], params[5].length);
+  return true;
+}
+
+
+/**
+ * Defines or removes a number field.
+ * Fn,r,c,w[,p[,z[,a[,d]]]] : n=field (0-7), r=row, c=first column, w=width (0: remove the field),
+ *                            p=decimal places (0-4), z=1: leading zeros, a=1: left aligned,
+ *                            d=display (default: 0)
+ * e.g. F0,0,7,4,0,1 for the speed in "Speed: 0000 km/h",
+ *      F1,1,6,5,2   for the mach number in "       0.00 mach"
+ */
+boolean processDefineFieldCommand(const CommandParam* params, byte paramCount)
+{
+  if ( params[0].value >= (long) ARRSIZE(arrFields) ) return false;
+  
+  NumberField& field = arrFields[params[0].value];
+  byte width = params[3].value;
+  if ( width == 0 )
+  {
+    field.remove();
+    return true;
+  }
+  
+  LcdDisplay& display  = arrDisplays[(paramCount > 7) ? params[7].value : 0];
+  byte        row      = params[1].value;
+  byte        col      = params[2].value;
+  byte        decimals = (paramCount > 4) ? params[4].value : 0;
+  byte        flags    = 0;
+  if ( (paramCount > 5) && (params[5].value == 1) ) flags |= FIELD_FLAG_ZEROS;
+  if ( (paramCount > 6) && (params[6].value == 1) ) flags |= FIELD_FLAG_LEFT;
+  if ( (row >= display.getRows()) || (col + width > display.getColumns()) ||
+       (width > FIELD_MAX_WIDTH) || (decimals > FIELD_MAX_DECIMALS) )
+  {
+    return false;
+  }
+  
+  field.define(&display, row, col, width, decimals, flags);
+  return true;
+}
+
+
+/**
+ * Shows numbers in consecutive number fields.
+ * Vn,v[,v...] : n=first field, v=numbers without decimal point (up to 6)
+ * e.g. V0,1234,125 shows 1234 in field 0 and 125 in field 1 (as "1.25" with 2 decimal places).
+ * All fields need to be defined, otherwise nothing is shown.
+ */
+boolean processSetFieldValuesCommand(const CommandParam* params, byte paramCount)
+{
+  byte first = params[0].value;
+  byte count = paramCount - 1;
+  if ( first + count > ARRSIZE(arrFields) ) return false;
+  for ( byte i = 0 ; i < count ; i++ )
+  {
+    if ( !arrFields[first + i].isDefined() ) return false;
+  }
+  
+  for ( byte i = 0 ; i < count ; i++ )
+  {
+    arrFields[first + i].show(params[1 + i].value);
   }
+  return true;
+}
+
+
+/**
+ * Starts a screen page for a display.
+ * Up[,d] : p=page (0-5), d=display (default: 0)
+ * The page gets the current geometry of the display, it has no text and no LED states yet.
+ * The pages are stored in the EEPROM, so they only need to be uploaded again when they change.
+ */
+boolean processCreatePageCommand(const CommandParam* params, byte paramCount)
+{
+  byte        displayIdx = (paramCount > 1) ? params[1].value : 0;
+  LcdDisplay& display    = arrDisplays[displayIdx];
+  return pageStore.create(params[0].value, displayIdx, display.getColumns(), display.getRows());
+}
+
+
+/**
+ * Sets the text of a row of a screen page.
+ * Wp,r,"string" : p=page, r=row
+ * e.g. W0,0,"Speed: 0000 km/h"
+ */
+boolean processSetPageRowCommand(const CommandParam* params, byte /* paramCount */)
+{
+  return pageStore.setRow(params[0].value, params[1].value, &rxBuffer[params[2].start], params[2].length);
+}
+
+
+/**
+ * Sets the state of a LED on a screen page.
+ * Kp,n,b,i,r[,R,G,B] : p=page, n=LED number, b=brightness (0-99), i=blink interval in ms (0: no blinking),
+ *                      r=blink ratio (0-99), R,G,B=colour of a multicolour LED (0-99)
+ * e.g. K3,9,99,500,50,99,0,0 lets the backlight of LCD 0 blink in red on page 3
+ */
+boolean processSetPageLedCommand(const CommandParam* params, byte paramCount)
+{
+  byte  colour[3];
+  byte* pColour = NULL;
+  if ( paramCount > 5 )
+  {
+    // colour needs all three components and a multicolour LED
+    if ( (paramCount < 8) || !arrLEDs[params[1].value]->supportsColour() ) return false;
+    colour[0] = params[5].value;
+    colour[1] = params[6].value;
+    colour[2] = params[7].value;
+    pColour   = colour;
+  }
+  return pageStore.setLed(params[0].value, params[1].value, params[2].value, params[3].value, params[4].value, pColour);
+}
+
+
+/**
+ * Shows a screen page.
+ * Dp : p=page
+ * The text of the page replaces the text of its display, only the characters that differ are written to the LCD.
+ * The scrolling text regions of the display stop, the number fields stay defined.
+ * The LEDs of the page are set, all other LEDs stay as they are.
+ * The display is selected for the T command.
+ */
+boolean processShowPageCommand(const CommandParam* params, byte /* paramCount */)
+{
+  byte page = params[0].value;
+  if ( !pageStore.isDefined(page) || (pageStore.getDisplay(page) >= iDisplayCount) ) return false;
   
-  String receivedString = readString();
-  int len = receivedString.length();
-  if ( len > 0 )
+  iCurrentDisplay = pageStore.getDisplay(page);
+  LcdDisplay& display = arrDisplays[iCurrentDisplay];
+  stopMarquees(&display);
+  pageStore.showText(page, &display);
+  display.commit(); // the page replaces the back buffer as well
+  pageStore.showLeds(page, arrLEDs, ARRSIZE(arrLEDs));
+  display.setCursor(0, 0);
+  return true;
+}
+
+
+/**
+ * Shows the back buffer of a display.
+ * X[d] : d=display (default: 0), e.g. P0,0 T"Speed" P1,0 T"12 km/h" X
+ * The text that C, T, N, V and D have written since the last X appears on the LCD at once,
+ * characters that have changed several times are written to the LCD only once.
+ * Fails if the display has no back buffer (see the G command).
+ */
+boolean processCommitCommand(const CommandParam* params, byte paramCount)
+{
+  return arrDisplays[(paramCount > 0) ? params[0].value : 0].commit();
+}
+
+
+/**
+ * Removes all number fields of a display.
+ *
+ * @param pDisplay the display
+ */
+void removeFields(LcdDisplay* pDisplay)
+{
+  for ( byte i = 0 ; i < ARRSIZE(arrFields) ; i++ )
   {
-    // if LCD was completely updated, or a text starts from the top left
-    // start updating actual LCD from the current cursor coordinates on
-    // to speed up the process
-    if ( (bUpdateTextBufCounter == 0) ||
-         ( (iCursorRow == 0) && (iCursorCol == 0) )
-       )
+    if ( arrFields[i].getDisplay() == pDisplay )
     {
-      iTextBufRow = iCursorRow;
-      iTextBufCol = iCursorCol;
+      arrFields[i].remove();
     }
+  }
+}
+
+
+/**
+ * Stops all scrolling text regions of a display.
+ *
+ * @param pDisplay the display
+ */
+void stopMarquees(LcdDisplay* pDisplay)
+{
+  for ( byte i = 0 ; i < ARRSIZE(arrMarquees) ; i++ )
+  {
+    if ( arrMarquees[i].getDisplay() == pDisplay )
+    {
+      arrMarquees[i].stop();
+    }
+  }
+}
+
+
+/**
+ * Sets received numbers to display in big font on the LCD screen
+ * e.g. N123 will print 123 in big font on the screen,
+ * N123,1 prints it on display 1
+ */
+boolean processSetBigNumberCommand(const CommandParam* params, byte paramCount)
+{
+  LcdDisplay& display = arrDisplays[(paramCount > 1) ? params[1].value : 0];
+  
+
+  // divisor for the first digit (including leading zeros)
+  long divisor = 1;
+  for ( byte i = 1 ; (i < params[0].length) && (divisor < 100000000L) ; i++ )
+  {
+    divisor *= 10;
+  }
+  
+  int cursorIterator = 0; // Iterator for large font locations
+  for ( ; divisor > 0 ; divisor /= 10 )
+  {
+    int num = (params[0].value / divisor) % 10;
     
-    for ( int iIdx = 0 ; iIdx < len ; iIdx++ )
+    byte arrIter = 0; // iterator through character array
+    for ( byte y = 0 ; y < 2 ; y++ ) // two lines
     {
-      arrTextIn[iCursorRow][iCursorCol] = receivedString[iIdx];
-      iCursorCol++; // move input cursor
-      if ( iCursorCol >= iLcdColumns )
+      for ( byte x = 0 ; x < 3 ; x++ ) // three chars each line
       {
-        iCursorCol = 0;
-        iCursorRow++;
-        if ( iCursorRow >= iLcdRows )
-        {
-          iCursorRow = 0;
-        }
-      }  
+        display.setChar(y, cursorIterator + x, pgm_read_byte(&bigNumberChars[num][arrIter++]));
+      }
     }
-    
-    bUpdateTextBufCounter = 2; // update LCD at least twice
+    cursorIterator += 4; // advance cursor 4 spaces
   }
-  
-  Serial.println(SUCCESS_CHAR); // send success char very quickly
+  return true;
+}
+
+
+/**
+ * Clears the text on the LCD panel and stops its scrolling text regions.
+ * C[d] : d=display (default: 0), the display is selected for the T command
+ */
+boolean processClearLcdCommand(const CommandParam* params, byte paramCount)
+{  
+  iCurrentDisplay = (paramCount > 0) ? params[0].value : 0;
+  arrDisplays[iCurrentDisplay].clear();
+  stopMarquees(&arrDisplays[iCurrentDisplay]);
+  return true;
+}
+
+
+/**
+ * Sets the text to display on the LCD panel selected by the last C or P command
+ * 'T' followed by the text to display within quotation marks "text"
+ */
+boolean processSetLcdTextCommand(const CommandParam* /* params */, byte /* paramCount */)
+{  
+  // the text has already been written into the text buffer while it was received
+  return true; // success char is sent very quickly
 }
 
 
 /**
- * Checks the LCD's default i2c to see if it is connected
+ * Prepares writing a text into the text buffer of the selected display at the cursor position.
+ */
+void startText()
+{
+  arrDisplays[iCurrentDisplay].startText();
+}
+
+
+/**
+ * Writes a character of a text into the text buffer of the selected display
+ * at the cursor position and advances the cursor.
+ *
+ * @param c the character to write
+ */
+void addTextChar(char c)
+{
+  arrDisplays[iCurrentDisplay].print(c);
+}
+
+
+/**
+ * Checks if an LCD is connected to an MCP23017 address.
+ *
+ * @param addr the address of the MCP23017 (0-7)
  *
  * @return <code>true</code> if LCD is connected, <code>false</code> if not
  */
-boolean checkLcdConnection()
+boolean checkLcdConnection(byte addr)
 {
-  Wire.begin();
-  Wire.beginTransmission(32);
+  Wire.beginTransmission(MCP23017_ADDRESS | addr);
   boolean found = (Wire.endTransmission() == 0);
   return found;
 }
-
+
+
+/********************************************************************************
+ * Methods for measuring free RAM
+ ********************************************************************************/
+
+/**
+ * Gets the start of the unused RAM between the static data/heap and the stack.
+ *
+ * @return pointer to the first unused byte
+ */
+uint8_t* getFreeRamStart()
+{
+  return (__brkval == NULL) ? &__heap_start : __brkval;
+}
+
+
+/**
+ * Fills the unused RAM with a known pattern
+ * so that the lowest amount of free RAM can be determined later.
+ */
+void paintFreeRam()
+{
+  uint8_t  stackTop;
+  uint8_t* p = getFreeRamStart();
+  // leave some bytes for the stack frame of this function
+  while ( p < &stackTop - 16 )
+  {
+    *p++ = RAM_CANARY;
+  }
+}
+
+
+/**
+ * Gets the amount of RAM currently free between the static data/heap and the stack.
+ *
+ * @return free RAM in bytes
+ */
+int getFreeRam()
+{
+  uint8_t stackTop;
+  return &stackTop - getFreeRamStart();
+}
+
+
+/**
+ * Gets the lowest amount of free RAM since startup
+ * by counting how much of the painted pattern is still untouched by the stack.
+ *
+ * @return lowest free RAM in bytes
+ */
+int getMinFreeRam()
+{
+  uint8_t  stackTop;
+  uint8_t* p = getFreeRamStart();
+  int      count = 0;
+  while ( (p < &stackTop) && (*p == RAM_CANARY) )
+  {
+    p++;
+    count++;
+  }
+  return count;
+}
@@ -4,6 +4,7 @@
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.22: Created
  * @version 1.1 - 2012.12.06: Modified interface to return number of key presses
+ * @version 1.2 - 2026.10.18: update() replaced by static per-type updateAll()
  */
  
 #ifndef BUTTON_H_INCLUDED
@@ -11,6 +12,12 @@
 
 #include "Arduino.h"
 
+/**
+ * Abstract base class for buttons connected to the board.
+ * The button object itself is only a handle to the state of its type.
+ * Each derived class provides a static updateAll() method that needs to be called
+ * inside the main loop with the current millis() result.
+ */
 class Button
 {
   public:
@@ -28,14 +35,6 @@ class Button
      * @return number of key presses 
      */
     virtual int getNumPresses() = 0;
-    
-    /**
-     * This method needs to be called inside the main loop with the current millis() result
-     * to allow for time-controlled events and control to function properly.
-     *
-     * @param time the current result of the millis() function
-     */
-    virtual void update(unsigned long time) = 0;
 
   protected:
   
@@ -48,4 +47,4 @@ class Button
 
 
 #endif // BUTTON_H_INCLUDED
-
+
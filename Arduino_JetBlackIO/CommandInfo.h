@@ -0,0 +1,87 @@
+/**
+ * Declarations for the table driven command dispatch.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Added text flag and parameter length for decoding while receiving
+ * @version 1.2 - 2026.10.18: Added flags for deferred execution, parameters are passed to the handler
+ * @version 1.3 - 2026.10.18: Added display index parameter
+ * @version 1.4 - 2026.10.18: Longer parameter schemas
+ * @version 1.5 - 2026.10.18: Synchronised flag also used by the LCD commands
+ * @version 1.6 - 2026.10.18: Added flag for commands that wait for the EEPROM
+ */
+
+#ifndef COMMAND_INFO_H_INCLUDED
+#define COMMAND_INFO_H_INCLUDED
+
+#include "Arduino.h"
+
+// maximum number of parameters of a command
+#define CMD_MAX_PARAMS 8
+
+// maximum length of a parameter schema
+#define CMD_SCHEMA_LENGTH 10
+
+// command flags
+#define CMD_FLAG_ACK   0x01 // success is acknowledged with '+' (otherwise the command sends its own reply)
+#define CMD_FLAG_LCD   0x02 // command needs the LCD
+#define CMD_FLAG_TEXT  0x04 // string parameter is written into the LCD text buffer while it is received
+#define CMD_FLAG_DEFER 0x08 // command is queued and executed in the main loop (only number parameters)
+#define CMD_FLAG_SYNC  0x10 // queued commands are executed before the command (e.g. for reading a state or writing the LCD)
+#define CMD_FLAG_EEPROM 0x20 // command waits at the end of its line until the screen pages have been written to the EEPROM
+
+/**
+ * Parameter types of a command schema, one character per parameter.
+ * Parameters after CMD_PARAM_OPTIONAL can be omitted.
+ */
+#define CMD_PARAM_OPTIONAL '['
+#define CMD_PARAM_LED      'n' // index of a LED
+#define CMD_PARAM_COLOUR_LED 'm' // index of a LED that supports colours
+#define CMD_PARAM_BUTTON   'k' // index of a button
+#define CMD_PARAM_BYTE     'v' // value 0-255 (brightness, colour, ratio)
+#define CMD_PARAM_INTERVAL 'i' // time in ms 0-65535
+#define CMD_PARAM_ROW      'r' // LCD row
+#define CMD_PARAM_COLUMN   'c' // LCD column
+#define CMD_PARAM_DISPLAY  'x' // index of a connected LCD display
+#define CMD_PARAM_LONG     'u' // any unsigned number
+#define CMD_PARAM_FLAG     'f' // 0 or 1
+#define CMD_PARAM_STRING   's' // text in quotation marks
+#define CMD_PARAM_DIGITS   'd' // sequence of digits (leading zeros are kept in the parameter length)
+
+
+/**
+ * A parameter of a received command, decoded by the tokenizer.
+ */
+struct CommandParam
+{
+  long    value;    // numerical value or length of the string
+  byte    length;   // number of digits or string characters
+  byte    start;    // position of the first string character in the string buffer
+  boolean isString; // true: parameter was given in quotation marks
+};
+
+
+/**
+ * Function that executes a command.
+ *
+ * @param params     the decoded parameters
+ * @param paramCount the number of parameters
+ * @return <code>true</code> if the command was successful,
+ *         <code>false</code> if not
+ */
+typedef boolean (*CommandHandler)(const CommandParam* params, byte paramCount);
+
+
+/**
+ * Entry of the command table.
+ * The table is stored in program memory, so entries need to be copied with memcpy_P before use.
+ */
+struct CommandInfo
+{
+  char    cmd;                       // command character
+  char    schema[CMD_SCHEMA_LENGTH]; // parameter types (see CMD_PARAM_...)
+  byte    flags;                     // see CMD_FLAG_...
+  CommandHandler handler;            // executes the command with the decoded parameters
+};
+
+#endif // COMMAND_INFO_H_INCLUDED
@@ -4,19 +4,33 @@
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.22: Created
  * @version 1.1 - 2012.12.06: Modified to new button interface 
+ * @version 1.2 - 2026.10.18: State moved to static arrays
+ * @version 1.3 - 2026.10.18: Debounce time works across the millis() wraparound
  */
  
 #include "DigitalButton.h"
 
 const unsigned long DEBOUNCE_TIME = 100; // time in ms to avoid bouncing contacts
 
+// state of all digital buttons
+static byte          buttonCount = 0;
+static byte          buttonPinNo[DIGITAL_BUTTON_CAPACITY];
+static byte          buttonNumPresses[DIGITAL_BUTTON_CAPACITY];
+static boolean       buttonState[DIGITAL_BUTTON_CAPACITY];
+static boolean       buttonOldState[DIGITAL_BUTTON_CAPACITY];
+static unsigned long buttonNextPollTime[DIGITAL_BUTTON_CAPACITY];
+
+
 DigitalButton::DigitalButton(byte pinNo) : Button()
 {
-  this->pinNo  = pinNo;
-  state        = false;
-  oldState     = false;
-  numPresses   = 0;
-  nextPollTime = 0;
+  // reserve entry (if all are taken, the last one is shared)
+  idx = (buttonCount < DIGITAL_BUTTON_CAPACITY) ? buttonCount++ : DIGITAL_BUTTON_CAPACITY - 1;
+  
+  buttonPinNo[idx]        = pinNo;
+  buttonState[idx]        = false;
+  buttonOldState[idx]     = false;
+  buttonNumPresses[idx]   = 0;
+  buttonNextPollTime[idx] = 0;
   
   // prepare pin to output signal
   pinMode(pinNo, INPUT); 
@@ -25,33 +39,35 @@ DigitalButton::DigitalButton(byte pinNo) : Button()
 
 boolean DigitalButton::isPressed()
 {
-  return state;
+  return buttonState[idx];
 }
 
     
 int DigitalButton::getNumPresses()
 {
-  byte retPresses = numPresses;
-  numPresses = 0; // reset counter
+  byte retPresses = buttonNumPresses[idx];
+  buttonNumPresses[idx] = 0; // reset counter
   return retPresses;
 }
 
     
-void DigitalButton::update(unsigned long time)
+void DigitalButton::updateAll(unsigned long time)
 {
-  if ( time > nextPollTime ) // avoid bouncing contacts
+  for ( byte i = 0 ; i < buttonCount ; i++ )
   {
-    state = (digitalRead(pinNo) == HIGH);
-    if ( state != oldState ) 
+    if ( (long) (time - buttonNextPollTime[i]) > 0 ) // avoid bouncing contacts (works across the millis() wraparound)
     {
-      if ( state )
+      boolean state = (digitalRead(buttonPinNo[i]) == HIGH);
+      buttonState[i] = state;
+      if ( state != buttonOldState[i] ) 
       {
-        numPresses++;
+        if ( state )
+        {
+          buttonNumPresses[i]++;
+        }
+        buttonNextPollTime[i] = time + DEBOUNCE_TIME;
+        buttonOldState[i] = state;
       }
-      nextPollTime = time + DEBOUNCE_TIME;
-      oldState = state;
     }
   }
 }
-
-
@@ -4,6 +4,7 @@
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.22: Created
  * @version 1.1 - 2012.12.06: Modified to new button interface
+ * @version 1.2 - 2026.10.18: State moved to static arrays, update() replaced by updateAll()
  */
  
 #ifndef DIGITAL_BUTTON_H_INCLUDED
@@ -11,6 +12,9 @@
 
 #include "Button.h"
 
+// maximum number of digital buttons
+#define DIGITAL_BUTTON_CAPACITY 3
+
 class DigitalButton : public Button
 {
   public:
@@ -26,14 +30,18 @@ class DigitalButton : public Button
     
     virtual int getNumPresses();
     
-    virtual void update(unsigned long time);
+    /**
+     * Updates all digital buttons.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
 
   private:
   
-    byte          pinNo, numPresses;
-    boolean       state, oldState;
-    unsigned long nextPollTime;
+    byte idx;
 };
 
 #endif // DIGITAL_BUTTON_H_INCLUDED
-
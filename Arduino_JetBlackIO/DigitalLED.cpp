@@ -3,13 +3,32 @@
  *
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.14: Created
+ * @version 1.1 - 2026.10.18: State moved to the digital LED table
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #include "DigitalLED.h"
 
-DigitalLED::DigitalLED(byte pinNo) : LED()
+// state of all digital LEDs
+DEFINE_LED_TABLE(digitalTable, DIGITAL_LED_CAPACITY);
+static byte digitalPinNo[DIGITAL_LED_CAPACITY];
+
+
+/**
+ * Sets the actual output pin state of a digital LED.
+ *
+ * @param idx the index of the LED in the table
+ */
+static inline void writeDigitalOutput(byte idx)
+{
+  digitalWrite(digitalPinNo[idx], 
+               ((digitalTable.brightness[idx] > 0) && digitalTable.state[idx]) ? HIGH : LOW);
+}
+
+
+DigitalLED::DigitalLED(byte pinNo) : LED(digitalTable)
 {
-  this->pinNo = pinNo;
+  digitalPinNo[idx] = pinNo;
 
   // prepare pin to output signal
   pinMode(pinNo, OUTPUT); 
@@ -25,8 +44,25 @@ void DigitalLED::setBrightness(byte brightness)
 }
 
 
+void DigitalLED::updateAll(unsigned long time)
+{
+  for ( byte i = 0 ; i < digitalTable.count ; i++ )
+  {
+    if ( digitalTable.updateBlink(i, time) )
+    {
+      writeDigitalOutput(i);
+    }
+  }
+}
+
+
+char DigitalLED::getType()
+{
+  return LED_TYPE_DIGITAL;
+}
+
+
 void DigitalLED::updateLedState()
 {
-  digitalWrite(pinNo, ((brightness > 0) && state) ? HIGH : LOW);
+  writeDigitalOutput(idx);
 }
-
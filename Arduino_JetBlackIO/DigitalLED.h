@@ -5,6 +5,8 @@
  * 
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.22: Created
+ * @version 1.1 - 2026.10.18: State moved to the digital LED table
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #ifndef DIGITAL_LED_H_INCLUDED
@@ -12,6 +14,9 @@
 
 #include "LED.h"
 
+// maximum number of digital LEDs
+#define DIGITAL_LED_CAPACITY 1
+
 class DigitalLED : public LED
 {
   public:
@@ -25,16 +30,22 @@ class DigitalLED : public LED
     
     virtual void setBrightness(byte brightness);
 
-  private:
-  
-    virtual void updateLedState();
+    /**
+     * Updates all digital LEDs.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
+
+    virtual char getType();
 
   private:
   
-    byte pinNo;
+    virtual void updateLedState();
 
 };
 
 
 #endif // DIGITAL_LED_H_INCLUDED
-
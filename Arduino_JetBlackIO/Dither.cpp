@@ -0,0 +1,48 @@
+/**
+ * Class implementation for temporal dithering of on/off outputs.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Minimum step time
+ */
+
+#include "Dither.h"
+
+// the error is measured in steps of 16us (time since the last step, max. 4ms)
+#define DITHER_TIME_SHIFT 4
+#define DITHER_TIME_MAX   255
+// limit of the error in time steps, so a long loop does not cause a long on or off phase afterwards
+// (about 1ms, or one step if the steps are longer)
+#define DITHER_ERROR_STEPS 64
+
+
+Dither::Dither(unsigned int period)
+{
+  lastTime     = 0;
+  this->period = period;
+  errorMax     = 99 * max((int) (period >> DITHER_TIME_SHIFT), DITHER_ERROR_STEPS);
+}
+
+
+byte Dither::advance(unsigned long now)
+{
+  if ( now - lastTime < period ) return 0;
+
+  unsigned long delta = (now - lastTime) >> DITHER_TIME_SHIFT;
+  if ( delta > DITHER_TIME_MAX )
+  {
+    lastTime = now;
+    return DITHER_TIME_MAX;
+  }
+  lastTime += delta << DITHER_TIME_SHIFT;
+  return delta;
+}
+
+
+boolean Dither::step(int& error, byte level, boolean on, byte steps)
+{
+  // error and step can both be up to 99 * 255
+  long e = error + (long) steps * (level - (on ? 99 : 0));
+  error = constrain(e, -errorMax, errorMax);
+  return error > 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * Class declaration for temporal dithering of on/off outputs.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Minimum step time
+ */
+
+#ifndef DITHER_H_INCLUDED
+#define DITHER_H_INCLUDED
+
+#include "Arduino.h"
+
+/**
+ * Time base for outputs that can only be switched on and off, but are dimmed
+ * by switching them with the requested duty cycle (first order sigma-delta modulation),
+ * e.g., the colour pins of the LCD backlight.
+ * Each output accumulates the difference between the requested and the actual on time
+ * and is on while the difference is positive.
+ * The time steps are weighted by their length, so the duty cycle does not depend on the loop timing.
+ * Outputs that are expensive to switch (e.g., over I2C) can be stepped at a lower, fixed rate.
+ */
+class Dither
+{
+  public:
+
+    /**
+     * Creates a time base.
+     *
+     * @param period the minimum time between two steps in us (0: one step per call of advance(), at most 4000)
+     */
+    Dither(unsigned int period);
+
+    /**
+     * Starts the next dithering step, if the minimum time since the last step has passed.
+     * The rest of a time step is carried over to the next step.
+     *
+     * @param now the current result of the micros() function
+     *
+     * @return the time since the last step in units of 16us (at most 255), 0 if it is not time for a step
+     */
+    byte advance(unsigned long now);
+
+    /**
+     * Switches one output for the next time step.
+     *
+     * @param error the difference between the requested and the actual on time, updated by the step
+     * @param level the requested duty cycle (1-98)
+     * @param on    the state of the output during the last step
+     * @param steps the length of the last step (see advance())
+     *
+     * @return <code>true</code> if the output is on for the next step,
+     *         <code>false</code> if it is off
+     */
+    boolean step(int& error, byte level, boolean on, byte steps);
+
+  private:
+
+    unsigned long lastTime; // time of the last step in us
+    unsigned int  period;   // minimum time between two steps in us
+    int           errorMax; // limit of the error
+};
+
+
+#endif // DITHER_H_INCLUDED
@@ -0,0 +1,125 @@
+/**
+ * Expander LED class implementation.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Dimmable by temporal dithering, like the LCD backlight
+ * @version 1.2 - 2026.10.18: Dithering shared with the LCD backlight (see Dither)
+ * @version 1.3 - 2026.10.18: Dithering steps at a fixed rate, independent of the loop rate
+ * @version 1.4 - 2026.10.18: Added begin(), no I2C transfers for absent chips
+ * @version 1.5 - 2026.10.18: begin() fails if there is no space in ExpanderPort
+ */
+
+#include "ExpanderLED.h"
+#include "ExpanderPort.h"
+#include "Dither.h"
+
+// state of all expander LEDs
+DEFINE_LED_TABLE(expanderTable, EXPANDER_LED_CAPACITY);
+static byte expanderAddress[EXPANDER_LED_CAPACITY]; // address of the chip
+static byte expanderPort[EXPANDER_LED_CAPACITY];  // index of the chip in ExpanderPort (EXPANDER_PORT_NONE: not used yet)
+static word expanderMask[EXPANDER_LED_CAPACITY];  // bit of the pin in the chip
+static byte expanderLevel[EXPANDER_LED_CAPACITY]; // duty cycle 0-99 including blinking
+static int  expanderError[EXPANDER_LED_CAPACITY]; // requested minus actual on time
+static byte expanderOn = 0;                       // one bit per LED
+
+// time base of the dithering: at most one I2C transfer per chip every 4ms (250 per second),
+// however many LEDs of the chip are dimmed and however fast the main loop runs
+#define EXPANDER_DITHER_PERIOD 4000
+static Dither dither(EXPANDER_DITHER_PERIOD);
+
+
+/**
+ * Calculates the duty cycle of an expander LED from its brightness and blink state.
+ * LEDs that are fully on or off are written into the shadow word of their chip straight away,
+ * the others are switched by the next dithering step in updateAll().
+ *
+ * @param idx the index of the LED in the table
+ */
+static void writeExpanderOutput(byte idx)
+{
+  byte level = expanderTable.state[idx] ? expanderTable.brightness[idx] : 0;
+  expanderLevel[idx] = level;
+  if ( expanderPort[idx] == EXPANDER_PORT_NONE ) return;
+  if ( (level == 0) || (level >= 99) )
+  {
+    expanderError[idx] = 0;
+    if ( level == 0 ) expanderOn &= ~(1 << idx);
+    else              expanderOn |= (1 << idx);
+    ExpanderPort::write(expanderPort[idx], expanderMask[idx], (level == 0) ? 0 : 0xFFFF);
+  }
+}
+
+
+/**
+ * Switches a dimmed expander LED for the next time step.
+ * Only the shadow word is changed, ExpanderPort::flush() writes all pins of a chip at once.
+ *
+ * @param idx   the index of the LED in the table
+ * @param steps the time since the last step in units of 16us
+ */
+static void ditherExpanderLED(byte idx, byte steps)
+{
+  byte bit = 1 << idx;
+  if ( dither.step(expanderError[idx], expanderLevel[idx], expanderOn & bit, steps) ) expanderOn |= bit;
+  else                                                                               expanderOn &= ~bit;
+  ExpanderPort::write(expanderPort[idx], expanderMask[idx], (expanderOn & bit) ? 0xFFFF : 0);
+}
+
+
+ExpanderLED::ExpanderLED(byte addr, byte pinNo) : LED(expanderTable)
+{
+  expanderAddress[idx] = addr;
+  expanderMask[idx]    = 1 << (pinNo & 15);
+  expanderPort[idx]    = EXPANDER_PORT_NONE;
+  expanderLevel[idx]   = 0;
+  expanderError[idx]   = 0;
+
+  updateLedState();
+}
+
+
+boolean ExpanderLED::begin()
+{
+  // no I2C access here: the pin is switched to output by the next ExpanderPort::flush()
+  expanderPort[idx] = ExpanderPort::attach(expanderAddress[idx], expanderMask[idx]);
+  if ( expanderPort[idx] == EXPANDER_PORT_NONE )
+  {
+    LedTable::overflow = true;
+    return false;
+  }
+  updateLedState();
+  return true;
+}
+
+
+void ExpanderLED::updateAll(unsigned long time)
+{
+  for ( byte i = 0 ; i < expanderTable.count ; i++ )
+  {
+    if ( expanderTable.updateBlink(i, time) )
+    {
+      writeExpanderOutput(i);
+    }
+  }
+
+  byte steps = dither.advance(micros());
+  if ( steps == 0 ) return;
+  for ( byte i = 0 ; i < expanderTable.count ; i++ )
+  {
+    byte level = expanderLevel[i];
+    if ( (level > 0) && (level < 99) && (expanderPort[i] != EXPANDER_PORT_NONE) ) ditherExpanderLED(i, steps);
+  }
+}
+
+
+char ExpanderLED::getType()
+{
+  return LED_TYPE_ANALOG; // dimmable like an analog LED
+}
+
+
+void ExpanderLED::updateLedState()
+{
+  writeExpanderOutput(idx);
+}
@@ -0,0 +1,72 @@
+/**
+ * Class declaration for LEDs connected to pins of a MCP23017 port expander,
+ * e.g., the spare pin of the LCD shield or additional expander boards.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Dimmable by temporal dithering, capacity 8
+ * @version 1.2 - 2026.10.18: Dithering steps at a fixed rate
+ * @version 1.3 - 2026.10.18: Added begin(), no I2C transfers for absent chips
+ * @version 1.4 - 2026.10.18: begin() fails if there is no space in ExpanderPort
+ */
+
+#ifndef EXPANDER_LED_H_INCLUDED
+#define EXPANDER_LED_H_INCLUDED
+
+#include "LED.h"
+
+// maximum number of expander LEDs (each one uses 19 bytes of RAM, at most 8)
+#define EXPANDER_LED_CAPACITY 8
+
+/**
+ * LED on a MCP23017 pin.
+ * The LED only changes the shadow word of its chip (see ExpanderPort),
+ * the pins are written by ExpanderPort::flush() in the main loop.
+ * The pins are too slow for a PWM signal, so the brightness is set by switching the LED
+ * with the requested duty cycle (see Dither), every 4ms instead of every loop like the LCD backlight.
+ * All dimmed LEDs of a chip change with the same I2C transfer, so a chip gets at most 250 transfers
+ * per second for dimming, however many of its LEDs are dimmed.
+ * Low brightness values flicker visibly (e.g., 10%: on for 4ms every 40ms).
+ */
+class ExpanderLED : public LED
+{
+  public:
+
+    /**
+     * Creates an expander LED class for a specific pin of a MCP23017.
+     * The LED is not written before begin() has been called.
+     *
+     * @param addr  the address of the MCP23017 (0-7)
+     * @param pinNo the number of the expander pin (0: GPA0, ... 15: GPB7)
+     */
+    ExpanderLED(byte addr, byte pinNo);
+
+    /**
+     * Registers the pin as an output of its chip (see ExpanderPort).
+     * This needs to be called once the chip has answered,
+     * so that no I2C transfers go to a chip that is not connected.
+     *
+     * @return <code>true</code> if the LED can be used,
+     *         <code>false</code> if there is no space for its chip in ExpanderPort
+     */
+    boolean begin();
+
+    /**
+     * Updates all expander LEDs.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
+
+    virtual char getType();
+
+  private:
+
+    virtual void updateLedState();
+
+};
+
+
+#endif // EXPANDER_LED_H_INCLUDED
@@ -0,0 +1,89 @@
+/**
+ * Class implementation for the output pins of MCP23017 port expanders.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: attach() fails if the table is full
+ */
+
+#include "ExpanderPort.h"
+#include "Adafruit_MCP23017.h"
+
+// state of all chips
+static byte expanderAddress[EXPANDER_PORT_CAPACITY];
+static word expanderOutputs[EXPANDER_PORT_CAPACITY]; // mask of the output pins
+static word expanderShadow[EXPANDER_PORT_CAPACITY];  // state of the output pins
+static byte expanderCount      = 0;
+static byte expanderChanged    = 0; // one bit per chip: shadow word needs to be written
+static byte expanderConfigured = 0; // one bit per chip: output pins have been set up
+
+
+byte ExpanderPort::attach(byte addr, word outputs)
+{
+  byte port = 0;
+  while ( (port < expanderCount) && (expanderAddress[port] != addr) )
+  {
+    port++;
+  }
+  if ( port == expanderCount )
+  {
+    if ( expanderCount >= EXPANDER_PORT_CAPACITY ) return EXPANDER_PORT_NONE;
+    expanderCount++;
+    expanderAddress[port] = addr;
+    expanderOutputs[port] = 0;
+    expanderShadow[port]  = 0;
+  }
+  if ( (expanderOutputs[port] & outputs) != outputs )
+  {
+    expanderOutputs[port] |= outputs;
+    expanderConfigured    &= ~(1 << port);
+    expanderChanged       |= (1 << port);
+  }
+  return port;
+}
+
+
+void ExpanderPort::write(byte port, word mask, word value)
+{
+  word shadow = (expanderShadow[port] & ~mask) | (value & mask);
+  if ( shadow != expanderShadow[port] )
+  {
+    expanderShadow[port] = shadow;
+    expanderChanged     |= (1 << port);
+  }
+}
+
+
+void ExpanderPort::reset(byte addr)
+{
+  for ( byte port = 0 ; port < expanderCount ; port++ )
+  {
+    if ( expanderAddress[port] == addr )
+    {
+      expanderConfigured &= ~(1 << port);
+      expanderChanged    |= (1 << port);
+    }
+  }
+}
+
+
+void ExpanderPort::flush()
+{
+  if ( expanderChanged == 0 ) return;
+
+  Adafruit_MCP23017 chip;
+  for ( byte port = 0 ; port < expanderCount ; port++ )
+  {
+    byte bit = 1 << port;
+    if ( (expanderChanged & bit) == 0 ) continue;
+
+    chip.setAddress(expanderAddress[port]);
+    if ( (expanderConfigured & bit) == 0 )
+    {
+      chip.pinModeOutputAB(expanderOutputs[port]);
+      expanderConfigured |= bit;
+    }
+    chip.writeGPIOAB(expanderShadow[port] & expanderOutputs[port]);
+  }
+  expanderChanged = 0;
+}
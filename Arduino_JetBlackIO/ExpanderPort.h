@@ -0,0 +1,71 @@
+/**
+ * Class declaration for the output pins of MCP23017 port expanders.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: attach() fails if the table is full
+ */
+
+#ifndef EXPANDER_PORT_H_INCLUDED
+#define EXPANDER_PORT_H_INCLUDED
+
+#include "Arduino.h"
+
+// maximum number of MCP23017 chips with output pins (e.g., the LCD shields)
+#define EXPANDER_PORT_CAPACITY 4
+
+// result of attach() if there is no space for another chip
+#define EXPANDER_PORT_NONE 0xFF
+
+/**
+ * Shadow copies of the output latches of the MCP23017 port expanders.
+ * LEDs on expander pins only change the shadow word of their chip,
+ * flush() sends each changed chip with a single writeGPIOAB() transfer,
+ * so the I2C traffic does not depend on the number of LEDs that change in a loop.
+ * Pins that are not registered as outputs are written as LOW.
+ * This is safe for the pins of the LCD shield between two LCD transfers
+ * (R/W and enable low), and the LCD code reads the outputs back before it changes them.
+ */
+class ExpanderPort
+{
+  public:
+
+    /**
+     * Registers output pins of a chip. The pins are switched to output by the next flush().
+     *
+     * @param addr    the address of the MCP23017 (0-7)
+     * @param outputs the mask of the output pins (bit 0: GPA0, ... bit 15: GPB7)
+     *
+     * @return the index of the chip for write(),
+     *         EXPANDER_PORT_NONE if the table is full (the pins can not be used)
+     */
+    static byte attach(byte addr, word outputs);
+
+    /**
+     * Changes output pins of a chip in the shadow word.
+     * The pins are written by the next flush().
+     *
+     * @param port  the index of the chip (see attach())
+     * @param mask  the mask of the pins to change
+     * @param value the new state of the pins (only the bits of the mask are used)
+     */
+    static void write(byte port, word mask, word value);
+
+    /**
+     * Sets the pin directions and the outputs of a chip again at the next flush(),
+     * e.g., after the LCD shield has reset its MCP23017.
+     *
+     * @param addr the address of the MCP23017 (0-7)
+     */
+    static void reset(byte addr);
+
+    /**
+     * Writes the shadow words of all changed chips.
+     * This method needs to be called once inside the main loop, after the LEDs have been updated.
+     */
+    static void flush();
+
+};
+
+
+#endif // EXPANDER_PORT_H_INCLUDED
@@ -3,30 +3,188 @@
  *
  * @author  Stefan Marks
  * @version 1.0 - 2012.12.06: Created
+ * @version 1.1 - 2026.10.18: No LCD access in the constructor (static allocation)
+ *                            State moved to the backlight table
+ * @version 1.2 - 2026.10.18: Added getType()
+ * @version 1.3 - 2026.10.18: Colour is written through the shadow word of the I/O expander
+ * @version 1.4 - 2026.10.18: Colour mixes by temporal dithering of the three colour pins
+ * @version 1.5 - 2026.10.18: Dithering shared with the expander LEDs (see Dither)
+ * @version 1.6 - 2026.10.18: Backlight stays off if its I/O expander does not fit into ExpanderPort
  */
  
 #include "LCD_Backlight.h"
+#include "ExpanderPort.h"
+#include "Dither.h"
 
-// Predefined constants for LCD backlight color
-#define LCD_BLACK  0x0
-#define LCD_RED    0x1
-#define LCD_YELLOW 0x3
-#define LCD_GREEN  0x2
-#define LCD_TEAL   0x6
-#define LCD_BLUE   0x4
-#define LCD_VIOLET 0x5
-#define LCD_WHITE  0x7
+// I/O expander pins of the backlight colours (LOW: on)
+#define LCD_PIN_RED   6
+#define LCD_PIN_GREEN 7
+#define LCD_PIN_BLUE  8
+#define LCD_PINS      (_BV(LCD_PIN_RED) | _BV(LCD_PIN_GREEN) | _BV(LCD_PIN_BLUE))
 
+// colour channels of a backlight
+#define CHANNEL_RED   0
+#define CHANNEL_GREEN 1
+#define CHANNEL_BLUE  2
+#define CHANNELS      3
 
-LCD_Backlight::LCD_Backlight(Adafruit_RGBLCDShield* pLCD) : LED()
+static const byte channelPins[CHANNELS] = { LCD_PIN_RED, LCD_PIN_GREEN, LCD_PIN_BLUE };
+
+// state of all backlights
+DEFINE_LED_TABLE(backlightTable, LCD_BACKLIGHT_CAPACITY);
+static Adafruit_RGBLCDShield* backlightLCD[LCD_BACKLIGHT_CAPACITY];
+static byte                   backlightRed[LCD_BACKLIGHT_CAPACITY];
+static byte                   backlightGreen[LCD_BACKLIGHT_CAPACITY];
+static byte                   backlightBlue[LCD_BACKLIGHT_CAPACITY];
+static byte                   backlightLevel[LCD_BACKLIGHT_CAPACITY][CHANNELS]; // duty cycle 0-99 including brightness and blinking
+static int                    backlightError[LCD_BACKLIGHT_CAPACITY][CHANNELS]; // requested minus actual on time
+static unsigned int           backlightEdges[LCD_BACKLIGHT_CAPACITY][CHANNELS]; // switch-on count in the current second
+static byte                   backlightOn[LCD_BACKLIGHT_CAPACITY];              // one bit per channel
+static byte                   backlightDithered[LCD_BACKLIGHT_CAPACITY];        // one bit per channel dithered in the current second
+static byte                   backlightPort[LCD_BACKLIGHT_CAPACITY];            // index in ExpanderPort (EXPANDER_PORT_NONE: not used yet)
+
+// dithering time and refresh rate measurement
+static Dither        dither(0);             // time base of the dithering, one step per loop
+static unsigned long ditherWindowStart = 0; // start of the current counting second in ms
+static unsigned int  ditherRate        = 0; // lowest switch-on count of a dithered channel in the last second
+
+
+/**
+ * Calculates the duty cycles of the colour channels of a backlight
+ * from its colour, brightness and blink state.
+ * The pins are switched by the next dithering step in updateAll().
+ *
+ * @param idx the index of the backlight in the table
+ */
+static void writeBacklightOutput(byte idx)
+{
+  // the first change happens after LcdDisplay::begin(), when the address of the LCD is known
+  backlightPort[idx] = ExpanderPort::attach(backlightLCD[idx]->getAddress(), LCD_PINS);
+  if ( backlightPort[idx] == EXPANDER_PORT_NONE ) LedTable::overflow = true;
+
+  byte brightness = backlightTable.state[idx] ? backlightTable.brightness[idx] : 0;
+  backlightLevel[idx][CHANNEL_RED]   = (backlightRed[idx]   * brightness + 49) / 99;
+  backlightLevel[idx][CHANNEL_GREEN] = (backlightGreen[idx] * brightness + 49) / 99;
+  backlightLevel[idx][CHANNEL_BLUE]  = (backlightBlue[idx]  * brightness + 49) / 99;
+}
+
+
+/**
+ * Switches the colour pins of a backlight for the next time step.
+ * Each channel is dithered on its own (see Dither), so the mix does not depend on the loop timing.
+ * Only the shadow word of the I/O expander is changed, ExpanderPort::flush() writes all three pins at once.
+ *
+ * @param idx   the index of the backlight in the table
+ * @param steps the time since the last step in units of 16us
+ */
+static void ditherBacklight(byte idx, byte steps)
+{
+  byte on   = backlightOn[idx];
+  word pins = 0;
+  for ( byte c = 0 ; c < CHANNELS ; c++ )
+  {
+    byte level = backlightLevel[idx][c];
+    byte bit   = 1 << c;
+    if ( (level == 0) || (level >= 99) )
+    {
+      // fully off or on: nothing to dither
+      backlightError[idx][c] = 0;
+      if ( level == 0 ) on &= ~bit;
+      else              on |= bit;
+    }
+    else
+    {
+      backlightDithered[idx] |= bit;
+      if ( dither.step(backlightError[idx][c], level, on & bit, steps) )
+      {
+        if ( (on & bit) == 0 ) backlightEdges[idx][c]++;
+        on |= bit;
+      }
+      else
+      {
+        on &= ~bit;
+      }
+    }
+    // the LED pins are active low
+    if ( (on & bit) == 0 ) pins |= _BV(channelPins[c]);
+  }
+  backlightOn[idx] = on;
+  ExpanderPort::write(backlightPort[idx], LCD_PINS, pins);
+}
+
+
+/**
+ * Determines the lowest switch-on rate of all channels that are dithered
+ * and starts the next counting second.
+ */
+static void measureDitherRate()
 {
-  this->pLCD = pLCD;
+  unsigned int rate = 0;
+  for ( byte i = 0 ; i < backlightTable.count ; i++ )
+  {
+    for ( byte c = 0 ; c < CHANNELS ; c++ )
+    {
+      if ( (backlightDithered[i] & (1 << c)) && ((rate == 0) || (backlightEdges[i][c] < rate)) )
+      {
+        rate = backlightEdges[i][c];
+      }
+      backlightEdges[i][c] = 0;
+    }
+    backlightDithered[i] = 0;
+  }
+  ditherRate = rate;
+}
+
 
-  red   = 0;
-  green = 0;
-  blue  = 0;
+LCD_Backlight::LCD_Backlight(Adafruit_RGBLCDShield* pLCD) : LED(backlightTable)
+{
+  backlightLCD[idx]   = pLCD;
+  backlightRed[idx]   = 0;
+  backlightGreen[idx] = 0;
+  backlightBlue[idx]  = 0;
+  backlightOn[idx]    = 0;
+  backlightDithered[idx] = 0;
+  backlightPort[idx]  = EXPANDER_PORT_NONE;
+  for ( byte c = 0 ; c < CHANNELS ; c++ )
+  {
+    backlightLevel[idx][c] = 0;
+    backlightError[idx][c] = 0;
+    backlightEdges[idx][c] = 0;
+  }
   
-  updateLedState();
+  // no updateLedState() here: the object is created statically,
+  // the address of the LCD is only known after LcdDisplay::begin()
+}
+
+
+void LCD_Backlight::updateAll(unsigned long time)
+{
+  for ( byte i = 0 ; i < backlightTable.count ; i++ )
+  {
+    if ( backlightTable.updateBlink(i, time) )
+    {
+      writeBacklightOutput(i);
+    }
+  }
+
+  // one dithering step per loop
+  byte steps = dither.advance(micros());
+  for ( byte i = 0 ; i < backlightTable.count ; i++ )
+  {
+    if ( backlightPort[i] != EXPANDER_PORT_NONE ) ditherBacklight(i, steps);
+  }
+
+  if ( time - ditherWindowStart >= 1000 )
+  {
+    measureDitherRate();
+    ditherWindowStart = time;
+  }
+}
+
+
+unsigned int LCD_Backlight::getDitherRate()
+{
+  return ditherRate;
 }
 
 
@@ -38,27 +196,20 @@ bool LCD_Backlight::supportsColour()
 
 void LCD_Backlight::setColour(byte red, byte green, byte blue)
 {
-  this->red   = constrain(red,   0, 99);
-  this->green = constrain(green, 0, 99);
-  this->blue  = constrain(blue,  0, 99);
+  backlightRed[idx]   = constrain(red,   0, 99);
+  backlightGreen[idx] = constrain(green, 0, 99);
+  backlightBlue[idx]  = constrain(blue,  0, 99);
   updateLedState();
 }
 
 
+char LCD_Backlight::getType()
+{
+  return LED_TYPE_BACKLIGHT;
+}
+
+
 void LCD_Backlight::updateLedState()
 {
-  if ( state )
-  {
-    // create bitmask out of RGB values
-    // 5000: to avoid division by 100 to include brightness
-    pLCD->setBacklight(((red   * brightness >= 5000) ? LCD_RED   : 0) |
-                       ((green * brightness >= 5000) ? LCD_GREEN : 0) |
-                       ((blue  * brightness >= 5000) ? LCD_BLUE  : 0)
-                      );
-  }
-  else
-  {
-    pLCD->setBacklight(LCD_BLACK);
-  }
+  writeBacklightOutput(idx);
 }
-
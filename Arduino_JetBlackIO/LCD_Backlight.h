@@ -3,6 +3,10 @@
  * 
  * @author  Stefan Marks
  * @version 1.0 - 2012.12.06: Created
+ * @version 1.1 - 2026.10.18: State moved to the backlight table
+ * @version 1.2 - 2026.10.18: One backlight per LCD display
+ * @version 1.3 - 2026.10.18: Added getType()
+ * @version 1.4 - 2026.10.18: Colour mixes by temporal dithering, added getDitherRate()
  */
  
 #ifndef LCD_BACKLIGHT_H_INCLUDED
@@ -11,6 +15,15 @@
 #include "LED.h"
 #include "Adafruit_RGBLCDShield.h"
 
+// maximum number of LCD backlights
+#define LCD_BACKLIGHT_CAPACITY 4 // one per LCD display (see LCD_MAX_DISPLAYS)
+
+/**
+ * RGB backlight of an LCD shield.
+ * The three colour pins of the shield can only be switched on and off,
+ * so intermediate colours and brightnesses are mixed by switching each pin
+ * on and off in every loop with the requested duty cycle (temporal dithering).
+ */
 class LCD_Backlight : public LED
 {
   public:
@@ -22,6 +35,25 @@ class LCD_Backlight : public LED
      */
     LCD_Backlight(Adafruit_RGBLCDShield* pLCD);
 
+    /**
+     * Updates all LCD backlights.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
+
+    /**
+     * Gets the effective refresh rate of the dithering.
+     * A channel with a duty cycle between 0% and 100% is switched on several times per second,
+     * this is the lowest of these rates (the frequency of the flicker that might be visible).
+     *
+     * @return the lowest number of times a dithered colour channel has been switched on
+     *         in the last second, 0 if no channel is dithered
+     */
+    static unsigned int getDitherRate();
+
 
   // overridden methods
 
@@ -29,16 +61,13 @@ class LCD_Backlight : public LED
 
     virtual void setColour(byte red, byte green, byte blue);
 
+    virtual char getType();
+
   private:
   
     virtual void updateLedState();
 
-  private:
-  
-    Adafruit_RGBLCDShield* pLCD;
-    byte                   red, green, blue;
 };
 
 
 #endif // LCD_BACKLIGHT_H_INCLUDED
-
@@ -3,74 +3,72 @@
  *
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.14: Created
+ * @version 1.1 - 2026.10.18: State moved to per-type LED tables
+ * @version 1.2 - 2026.10.18: Blink phase starts when the blink interval is set
  */
  
 #include "LED.h"
 
-LED::LED()
+LED::LED(LedTable& table)
 {
-  // initialise variables
-  brightness = 0;
-  interval   = 0;
-  ratio      = 50;
-  onTime     = 0;
-  offTime    = 0;
-  state      = true;
+  // reserve entry in the table
+  pTable = &table;
+  idx    = table.add();
 }
 
 
 byte LED::getBrightness()
 {
-  return brightness;
+  return pTable->brightness[idx];
 }
 
 
 byte LED::getCurrentBrightness()
 {
-  return state ? brightness : 0;
+  return pTable->state[idx] ? pTable->brightness[idx] : 0;
 }
 
 
 void LED::setBrightness(byte brightness)
 {
-  this->brightness = constrain(brightness, 0, 99);
+  pTable->brightness[idx] = constrain(brightness, 0, 99);
   updateLedState();
 }
 
 
 unsigned int LED::getBlinkInterval()
 {
-  return interval;
+  return pTable->interval[idx];
 }
 
 
 void LED::setBlinkInterval(unsigned int interval)
 {
-  this->interval = interval;
+  pTable->interval[idx] = interval;
   if ( interval == 0 )
   {
     // no more blinking: activate LED
-    state = true;
+    pTable->state[idx] = true;
     updateLedState();
   }
   else
   {
-    // blinking: force recalculation NOW
-    onTime  = 0;
-    offTime = 0;
+    // blinking: the first period starts now
+    pTable->onTime[idx]  = millis();
+    pTable->offTime[idx] = pTable->onTime[idx];
   }
 }
 
 
 byte LED::getBlinkRatio()
 {
-  return ratio;
+  return pTable->ratio[idx];
 }
 
 
 void LED::setBlinkRatio(byte ratio)
 {
-  this->ratio = constrain(ratio, 1, 99);
+  pTable->ratio[idx] = constrain(ratio, 1, 99);
 }
 
 
@@ -85,24 +83,3 @@ void LED::setColour(byte /*red*/, byte /*green*/, byte /*blue*/)
   // do nothing here
 }
 
-
-void LED::update(unsigned long time)
-{
-  if ( interval > 0 )
-  {
-    if ( time >= onTime )
-    {
-      offTime = time + (interval * ratio / 100);
-      onTime  = time + interval;
-      state   = true;
-      updateLedState();
-    }
-    else if ( time >= offTime )
-    {
-      state = false;
-      updateLedState();
-    }
-  }
-}
-
-
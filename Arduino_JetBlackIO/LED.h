@@ -3,15 +3,28 @@
  * 
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.14: Created
+ * @version 1.1 - 2026.10.18: State moved to per-type LED tables, update() replaced by static per-type updateAll()
+ * @version 1.2 - 2026.10.18: Added getType()
+ * @version 1.3 - 2026.10.18: Backlight colours are dithered
  */
  
 #ifndef LED_H_INCLUDED
 #define LED_H_INCLUDED
 
 #include "Arduino.h"
+#include "LedTable.h"
+
+// LED types (see getType())
+#define LED_TYPE_DIGITAL    'd' // on/off only
+#define LED_TYPE_ANALOG     'a' // dimmable
+#define LED_TYPE_MULTICOLOUR 'm' // composed of three dimmable LEDs
+#define LED_TYPE_BACKLIGHT  'b' // LCD backlight, colours mixed by temporal dithering
 
 /**
  * Abstract base class for LEDs connected to the board.
+ * The LED object itself is only a handle to the entry in the LED table of its type.
+ * Each derived class provides a static updateAll() method that needs to be called
+ * inside the main loop with the current millis() result.
  */
 class LED
 {
@@ -82,21 +95,22 @@ class LED
      * @param blue  the blue  colour component (0-99)
      */
     virtual void setColour(byte red, byte green, byte blue);
-	
+
     /**
-     * This method needs to be called inside the main loop with the current millis() result
-     * to allow for time-controlled events and control to function properly.
+     * Gets the type of the LED, e.g., for describing the module to the host.
      *
-     * @param time the current result of the millis() function
+     * @return the type of the LED (see LED_TYPE_...)
      */
-    virtual void update(unsigned long time);
+    virtual char getType() = 0;
 
   protected:
   
     /**
      * Creates a generic LED class.
+     *
+     * @param table the table of the LED type to store the LED state in
      */
-    LED();
+    LED(LedTable& table);
     
   private:
   
@@ -107,13 +121,10 @@ class LED
     
   protected:
   
-    byte          brightness;
-    unsigned int  interval;
-    byte          ratio;
-    boolean       state;
-    unsigned long onTime, offTime;
+    LedTable* pTable;
+    byte      idx;
 };
 
 
 #endif // LED_H_INCLUDED
-
+
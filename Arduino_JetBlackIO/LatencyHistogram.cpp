@@ -0,0 +1,52 @@
+/**
+ * Latency histogram implementation.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "LatencyHistogram.h"
+
+void LatencyHistogram::add(unsigned long span)
+{
+  byte bucket = 0;
+  span >>= 6; // first bucket: < 64
+  while ( (span > 0) && (bucket < LATENCY_BUCKETS - 1) )
+  {
+    span >>= 2;
+    bucket++;
+  }
+  if ( buckets[bucket] < 0xFFFF )
+  {
+    buckets[bucket]++;
+  }
+}
+
+
+boolean LatencyHistogram::isEmpty()
+{
+  for ( byte i = 0 ; i < LATENCY_BUCKETS ; i++ )
+  {
+    if ( buckets[i] > 0 ) return false;
+  }
+  return true;
+}
+
+
+void LatencyHistogram::reset()
+{
+  for ( byte i = 0 ; i < LATENCY_BUCKETS ; i++ )
+  {
+    buckets[i] = 0;
+  }
+}
+
+
+void LatencyHistogram::print(Print& out)
+{
+  for ( byte i = 0 ; i < LATENCY_BUCKETS ; i++ )
+  {
+    if ( i > 0 ) out.print(',');
+    out.print(buckets[i]);
+  }
+}
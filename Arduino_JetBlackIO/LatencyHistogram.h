@@ -0,0 +1,53 @@
+/**
+ * Class declaration for latency histograms with fixed buckets.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef LATENCY_HISTOGRAM_H_INCLUDED
+#define LATENCY_HISTOGRAM_H_INCLUDED
+
+#include "Arduino.h"
+
+// number of buckets: <64, <256, <1024, <4096, <16384, >=16384 (e.g. us)
+#define LATENCY_BUCKETS 6
+
+/**
+ * Histogram of time spans (usually in microseconds).
+ * The bucket limits grow by a factor of 4, starting at 64 units.
+ * The counters stop at their maximum value instead of wrapping around.
+ */
+struct LatencyHistogram
+{
+    /**
+     * Adds a time span to the histogram.
+     *
+     * @param span the time span
+     */
+    void add(unsigned long span);
+
+    /**
+     * Checks if the histogram is empty.
+     *
+     * @return <code>true</code> if no time span has been added,
+     *         <code>false</code> if not
+     */
+    boolean isEmpty();
+
+    /**
+     * Sets all counters to zero.
+     */
+    void reset();
+
+    /**
+     * Prints the bucket counters, separated by commas.
+     *
+     * @param out where to print to
+     */
+    void print(Print& out);
+
+    unsigned int buckets[LATENCY_BUCKETS];
+};
+
+#endif // LATENCY_HISTOGRAM_H_INCLUDED
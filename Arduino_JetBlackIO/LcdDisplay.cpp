@@ -0,0 +1,378 @@
+/**
+ * Class implementation for a LCD display with a text frame buffer.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Geometry configurable at runtime, text buffer provided by the caller,
+ *                            consecutive changes are written without repositioning the LCD cursor
+ * @version 1.2 - 2026.10.18: Printing of texts stored in flash memory
+ * @version 1.3 - 2026.10.18: LCD initialisation runs in the background, custom characters are uploaded by refresh()
+ * @version 1.4 - 2026.10.18: Expander outputs are restored after the initialisation
+ * @version 1.5 - 2026.10.18: Optional back buffer, shown with commit()
+ */
+
+#include "LcdDisplay.h"
+#include "ExpanderPort.h"
+
+// LCD address counter position is unknown
+#define LCD_POS_UNKNOWN 0xFF
+// LCD address counter is in the custom character memory
+#define LCD_POS_GLYPHS  0xFE
+
+
+LcdDisplay::LcdDisplay() : backlight(&lcd)
+{
+  address        = 0;
+  text           = NULL;
+  back           = NULL;
+  doubleBuffered = false;
+  dirty          = NULL;
+  dirtyCount     = 0;
+  cursorPos      = 0;
+  refreshPos     = 0;
+  lcdPos         = LCD_POS_UNKNOWN;
+  glyphs         = NULL;
+  glyphCount     = 0;
+  initGlyphRow   = 0;
+  initTime       = 0;
+  initWait       = 0;
+  setGeometry(LCD_DEFAULT_COLUMNS, LCD_DEFAULT_ROWS);
+}
+
+
+void LcdDisplay::setGeometry(byte columns, byte rows)
+{
+  this->columns = columns;
+  this->rows    = rows;
+  cells         = columns * rows;
+}
+
+
+void LcdDisplay::setDoubleBuffered(boolean enabled)
+{
+  doubleBuffered = enabled;
+}
+
+
+boolean LcdDisplay::isDoubleBuffered()
+{
+  return doubleBuffered;
+}
+
+
+byte LcdDisplay::getColumns()
+{
+  return columns;
+}
+
+
+byte LcdDisplay::getRows()
+{
+  return rows;
+}
+
+
+byte LcdDisplay::getCells()
+{
+  return cells;
+}
+
+
+int LcdDisplay::getBufferSize()
+{
+  return doubleBuffered ? 2 * cells : cells;
+}
+
+
+void LcdDisplay::setBuffer(char* text, byte* dirty)
+{
+  this->text  = text;
+  this->back  = doubleBuffered ? text + cells : NULL;
+  this->dirty = dirty;
+  for ( int pos = 0 ; pos < getBufferSize() ; pos++ )
+  {
+    text[pos] = ' ';
+  }
+  for ( byte i = 0 ; i < (cells + 7) / 8 ; i++ )
+  {
+    dirty[i] = 0;
+  }
+  dirtyCount = 0;
+  for ( byte pos = 0 ; pos < cells ; pos++ )
+  {
+    markDirty(pos);
+  }
+  cursorPos  = 0;
+  refreshPos = 0;
+}
+
+
+char* LcdDisplay::getBuffer()
+{
+  return text;
+}
+
+
+void LcdDisplay::setGlyphs(const byte* glyphs, byte count)
+{
+  this->glyphs     = glyphs;
+  this->glyphCount = min(count, (byte) LCD_MAX_GLYPHS);
+}
+
+
+void LcdDisplay::begin(byte addr)
+{
+  address = addr;
+  lcd.setAddress(addr);
+  lcd.startInit(columns, rows);
+  initGlyphRow = 0;
+  initTime     = micros();
+  initWait     = 0;
+
+  // the initialisation clears the LCD: only characters that are not spaces need to be written
+  back = doubleBuffered ? text + cells : NULL;
+  for ( int pos = 0 ; pos < getBufferSize() ; pos++ )
+  {
+    text[pos] = ' ';
+  }
+  for ( byte i = 0 ; i < (cells + 7) / 8 ; i++ )
+  {
+    dirty[i] = 0;
+  }
+  dirtyCount = 0;
+  cursorPos  = 0;
+  refreshPos = 0;
+  lcdPos     = LCD_POS_UNKNOWN;
+}
+
+
+byte LcdDisplay::getAddress()
+{
+  return address;
+}
+
+
+Adafruit_RGBLCDShield* LcdDisplay::getLCD()
+{
+  // the caller might change the LCD address counter
+  lcdPos = LCD_POS_UNKNOWN;
+  return &lcd;
+}
+
+
+LED* LcdDisplay::getBacklight()
+{
+  return &backlight;
+}
+
+
+void LcdDisplay::clear()
+{
+  for ( byte pos = 0 ; pos < cells ; pos++ )
+  {
+    put(pos, ' ');
+  }
+  cursorPos = 0;
+}
+
+
+boolean LcdDisplay::setCursor(byte row, byte col)
+{
+  if ( (row >= rows) || (col >= columns) ) return false;
+
+  cursorPos = row * columns + col;
+  return true;
+}
+
+
+void LcdDisplay::startText()
+{
+  // with a back buffer, commit() chooses the refresh position
+  if ( back != NULL ) return;
+
+  if ( (dirtyCount == 0) || (cursorPos == 0) )
+  {
+    refreshPos = cursorPos;
+  }
+}
+
+
+void LcdDisplay::print(char c)
+{
+  put(cursorPos, c);
+  cursorPos++;
+  if ( cursorPos >= cells )
+  {
+    cursorPos = 0;
+  }
+}
+
+
+void LcdDisplay::print(const char* str)
+{
+  while ( *str != '\0' )
+  {
+    print(*str++);
+  }
+}
+
+
+void LcdDisplay::print(const __FlashStringHelper* str)
+{
+  const char* p = (const char*) str;
+  for ( char c = pgm_read_byte(p) ; c != '\0' ; c = pgm_read_byte(++p) )
+  {
+    print(c);
+  }
+}
+
+
+void LcdDisplay::setChar(byte row, byte col, char c)
+{
+  if ( (row >= rows) || (col >= columns) ) return;
+
+  put(row * columns + col, c);
+}
+
+
+void LcdDisplay::showChar(byte row, byte col, char c)
+{
+  if ( (row >= rows) || (col >= columns) ) return;
+
+  byte pos = row * columns + col;
+  if ( back != NULL ) back[pos] = c;
+  if ( text[pos] != c )
+  {
+    text[pos] = c;
+    markDirty(pos);
+  }
+}
+
+
+boolean LcdDisplay::commit()
+{
+  if ( back == NULL ) return false;
+
+  boolean upToDate = (dirtyCount == 0);
+  for ( byte pos = 0 ; pos < cells ; pos++ )
+  {
+    if ( text[pos] != back[pos] )
+    {
+      text[pos] = back[pos];
+      markDirty(pos);
+      // start the refresh at the first change, like startText() does
+      if ( upToDate )
+      {
+        refreshPos = pos;
+        upToDate   = false;
+      }
+    }
+  }
+  return true;
+}
+
+
+byte LcdDisplay::getDirtyCount()
+{
+  return dirtyCount;
+}
+
+
+boolean LcdDisplay::isReady()
+{
+  return lcd.isReady() && (initGlyphRow >= glyphCount * 8);
+}
+
+
+boolean LcdDisplay::refresh()
+{
+  if ( !isReady() ) return initialise();
+  if ( dirtyCount == 0 ) return false;
+
+  // find the next changed character, starting at the refresh position,
+  // skipping 8 unchanged characters at a time where possible
+  byte pos = refreshPos;
+  while ( (dirty[pos >> 3] & (1 << (pos & 7))) == 0 )
+  {
+    if ( ((pos & 7) == 0) && (dirty[pos >> 3] == 0) )
+    {
+      pos += 8;
+    }
+    else
+    {
+      pos++;
+    }
+    if ( pos >= cells ) pos = 0;
+  }
+
+  // the LCD address counter advances after each character,
+  // so changes next to each other only need one cursor command
+  if ( pos != lcdPos )
+  {
+    lcd.setCursor(pos % columns, pos / columns);
+  }
+  lcd.write(text[pos]);
+  dirty[pos >> 3] &= ~(1 << (pos & 7));
+  dirtyCount--;
+
+  refreshPos = pos + 1;
+  if ( refreshPos >= cells ) refreshPos = 0;
+  // at the end of a row, the address counter does not continue with the next row
+  lcdPos = ((refreshPos % columns) != 0) ? refreshPos : LCD_POS_UNKNOWN;
+  return true;
+}
+
+
+boolean LcdDisplay::initialise()
+{
+  if ( !lcd.isReady() )
+  {
+    // the HD44780 needs some waiting between the steps
+    unsigned long time = micros();
+    if ( time - initTime < initWait ) return false;
+    initWait = lcd.initStep();
+    initTime = time;
+    if ( lcd.isReady() )
+    {
+      // the initialisation has reset the pins of the MCP23017 (backlight, expander LEDs)
+      ExpanderPort::reset(address);
+    }
+    return true;
+  }
+
+  // one row of a custom character at a time,
+  // the address counter advances to the next row and the next character by itself
+  if ( lcdPos != LCD_POS_GLYPHS )
+  {
+    lcd.setCharRow(initGlyphRow >> 3, initGlyphRow & 7);
+  }
+  lcd.write(pgm_read_byte(glyphs + initGlyphRow));
+  initGlyphRow++;
+  lcdPos = LCD_POS_GLYPHS;
+  return true;
+}
+
+
+void LcdDisplay::put(byte pos, char c)
+{
+  if ( back != NULL )
+  {
+    back[pos] = c;
+  }
+  else if ( text[pos] != c )
+  {
+    text[pos] = c;
+    markDirty(pos);
+  }
+}
+
+
+void LcdDisplay::markDirty(byte pos)
+{
+  byte mask = 1 << (pos & 7);
+  if ( (dirty[pos >> 3] & mask) == 0 )
+  {
+    dirty[pos >> 3] |= mask;
+    dirtyCount++;
+  }
+}
@@ -0,0 +1,296 @@
+/**
+ * Class declaration for a LCD display with a text frame buffer.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Geometry configurable at runtime, text buffer provided by the caller,
+ *                            consecutive changes are written without repositioning the LCD cursor
+ * @version 1.2 - 2026.10.18: Printing of texts stored in flash memory
+ * @version 1.3 - 2026.10.18: LCD initialisation runs in the background, custom characters are uploaded by refresh()
+ * @version 1.4 - 2026.10.18: Expander outputs are restored after the initialisation
+ * @version 1.5 - 2026.10.18: Optional back buffer, shown with commit()
+ */
+
+#ifndef LCD_DISPLAY_H_INCLUDED
+#define LCD_DISPLAY_H_INCLUDED
+
+#include "Arduino.h"
+#include "Adafruit_RGBLCDShield.h"
+#include "LCD_Backlight.h"
+
+// maximum number of LCD shields (each one needs its own I2C address 0-7)
+#define LCD_MAX_DISPLAYS 4
+
+#if LCD_MAX_DISPLAYS > LCD_BACKLIGHT_CAPACITY
+#error Each LCD display needs an entry in the backlight table
+#endif
+
+// default size of a display
+#define LCD_DEFAULT_ROWS    2
+#define LCD_DEFAULT_COLUMNS 16
+
+// limits of the HD44780 controller
+#define LCD_MAX_ROWS    4
+#define LCD_MAX_COLUMNS 40
+#define LCD_MAX_CELLS   80
+#define LCD_MAX_GLYPHS  8 // custom characters
+
+/**
+ * A LCD shield with its text frame buffer and backlight.
+ * Text is written into the frame buffer quickly, changed characters are marked as dirty.
+ * The actual LCD is updated slowly by calling refresh() inside the main loop,
+ * one changed character at a time, so that the main loop is never blocked for long.
+ * The initialisation of the LCD runs the same way, text written before the LCD is ready
+ * waits in the frame buffer.
+ * With a back buffer, text is written into the back buffer instead
+ * and copied into the frame buffer by commit(), so that a screen built from several commands
+ * appears at once, and characters that change several times are written to the LCD only once.
+ */
+class LcdDisplay
+{
+  public:
+
+    /**
+     * Creates the LCD display object with the default geometry.
+     * The LCD is only accessed after begin().
+     */
+    LcdDisplay();
+
+    /**
+     * Sets the size of the display.
+     * The text buffer needs to be set again with setBuffer() and the LCD initialised with begin().
+     *
+     * @param columns the number of columns (1 - LCD_MAX_COLUMNS)
+     * @param rows    the number of rows (1 - LCD_MAX_ROWS)
+     */
+    void setGeometry(byte columns, byte rows);
+
+    /**
+     * Selects if the display has a back buffer.
+     * The text buffer needs to be set again with setBuffer() and the LCD initialised with begin().
+     *
+     * @param enabled <code>true</code>: text is written into the back buffer and shown by commit(),
+     *                <code>false</code>: text is written into the frame buffer directly
+     */
+    void setDoubleBuffered(boolean enabled);
+
+    /**
+     * Checks if the display has a back buffer.
+     *
+     * @return <code>true</code> if text is shown by commit(),
+     *         <code>false</code> if text is shown straight away
+     */
+    boolean isDoubleBuffered();
+
+    /**
+     * Gets the number of columns of the display.
+     *
+     * @return the number of columns
+     */
+    byte getColumns();
+
+    /**
+     * Gets the number of rows of the display.
+     *
+     * @return the number of rows
+     */
+    byte getRows();
+
+    /**
+     * Gets the number of characters of the display.
+     *
+     * @return columns * rows
+     */
+    byte getCells();
+
+    /**
+     * Gets the size of the text buffer memory of the display.
+     *
+     * @return getCells(), twice that with a back buffer
+     */
+    int getBufferSize();
+
+    /**
+     * Sets the memory for the text frame buffer and the back buffer.
+     * The buffers are filled with spaces and the frame buffer is marked as dirty.
+     *
+     * @param text  space for getBufferSize() characters (the back buffer follows the frame buffer)
+     * @param dirty space for (getCells() + 7) / 8 bytes
+     */
+    void setBuffer(char* text, byte* dirty);
+
+    /**
+     * Gets the memory of the text frame buffer.
+     *
+     * @return the text frame buffer
+     */
+    char* getBuffer();
+
+    /**
+     * Sets the custom characters that are uploaded to the LCD during the initialisation.
+     *
+     * @param glyphs the patterns of the characters, 8 bytes each, in flash memory
+     * @param count  the number of characters (0 - LCD_MAX_GLYPHS)
+     */
+    void setGlyphs(const byte* glyphs, byte count);
+
+    /**
+     * Starts the initialisation of the LCD shield and clears the frame buffer.
+     * The initialisation is executed by refresh(). It takes about 60ms,
+     * followed by the upload of the custom characters, one row per call.
+     *
+     * @param addr the address of the MCP23017 of the shield (0-7)
+     */
+    void begin(byte addr);
+
+    /**
+     * Checks if the LCD has been initialised.
+     *
+     * @return <code>true</code> if the LCD shows the frame buffer,
+     *         <code>false</code> if the initialisation is still running
+     */
+    boolean isReady();
+
+    /**
+     * Gets the address of the MCP23017 of the shield.
+     *
+     * @return the address given to begin()
+     */
+    byte getAddress();
+
+    /**
+     * Gets the LCD shield object, e.g., for defining custom characters.
+     *
+     * @return the LCD shield object
+     */
+    Adafruit_RGBLCDShield* getLCD();
+
+    /**
+     * Gets the backlight of the LCD.
+     *
+     * @return the backlight LED
+     */
+    LED* getBacklight();
+
+    /**
+     * Fills the frame buffer with spaces and moves the cursor to the top left.
+     */
+    void clear();
+
+    /**
+     * Sets the position where the next text is written.
+     *
+     * @param row the row (0 - getRows()-1)
+     * @param col the column (0 - getColumns()-1)
+     * @return <code>true</code> if the position is on the display,
+     *         <code>false</code> if not
+     */
+    boolean setCursor(byte row, byte col);
+
+    /**
+     * Prepares writing a text at the cursor position.
+     * If the LCD is up to date, or the text starts at the top left,
+     * the refresh continues from the cursor position to show the new text sooner.
+     */
+    void startText();
+
+    /**
+     * Writes a character into the frame buffer at the cursor position and advances the cursor.
+     * At the end of the last row, the cursor wraps around to the top left.
+     *
+     * @param c the character to write
+     */
+    void print(char c);
+
+    /**
+     * Writes a text into the frame buffer at the cursor position and advances the cursor.
+     *
+     * @param str the text to write
+     */
+    void print(const char* str);
+
+    /**
+     * Writes a text from flash memory into the frame buffer at the cursor position and advances the cursor.
+     *
+     * @param str the text to write, e.g., F("text")
+     */
+    void print(const __FlashStringHelper* str);
+
+    /**
+     * Writes a character into the frame buffer at a specific position.
+     * The cursor is not changed, positions outside of the display are ignored.
+     *
+     * @param row the row
+     * @param col the column
+     * @param c   the character to write
+     */
+    void setChar(byte row, byte col, char c);
+
+    /**
+     * Writes a character into the frame buffer and the back buffer at a specific position,
+     * so that it is shown without commit(), e.g., for animations.
+     * The cursor is not changed, positions outside of the display are ignored.
+     *
+     * @param row the row
+     * @param col the column
+     * @param c   the character to write
+     */
+    void showChar(byte row, byte col, char c);
+
+    /**
+     * Copies the back buffer into the frame buffer.
+     * Only the characters that differ from the frame buffer are marked as dirty,
+     * the refresh starts at the first of them if the LCD was up to date.
+     *
+     * @return <code>true</code> if the display has a back buffer,
+     *         <code>false</code> if not (nothing to do)
+     */
+    boolean commit();
+
+    /**
+     * Gets the number of characters that have changed but are not shown on the LCD yet.
+     *
+     * @return the number of dirty characters
+     */
+    byte getDirtyCount();
+
+    /**
+     * Writes the next changed character to the LCD
+     * or executes the next step of the initialisation when it is due.
+     * This method needs to be called inside the main loop.
+     *
+     * @return <code>true</code> if the LCD has been accessed,
+     *         <code>false</code> if the LCD is up to date or the next initialisation step is not due yet
+     */
+    boolean refresh();
+
+  private:
+
+    boolean initialise();
+    void    put(byte pos, char c);
+    void    markDirty(byte pos);
+
+    Adafruit_RGBLCDShield lcd;
+    LCD_Backlight         backlight;
+
+    byte  address;    // address of the MCP23017
+    byte  columns;    // size of the display
+    byte  rows;
+    byte  cells;
+    char* text;       // frame buffer, row by row
+    char* back;       // back buffer that text is written into (NULL: text is written into the frame buffer)
+    boolean doubleBuffered; // back buffer selected by setDoubleBuffered()
+    byte* dirty;      // one bit per character: changed, but not written to the LCD yet
+    byte  dirtyCount; // number of set bits in dirty[]
+    byte  cursorPos;  // position where the next character is written
+    byte  refreshPos; // position where the next refresh() starts to look for changes
+    byte  lcdPos;     // position of the LCD address counter (0xFF: unknown)
+
+    const byte*   glyphs;       // custom characters in flash memory
+    byte          glyphCount;
+    byte          initGlyphRow; // next row of the custom characters to upload (8 per character)
+    unsigned long initTime;     // time in us of the last initialisation step
+    unsigned int  initWait;     // time in us to wait before the next initialisation step
+};
+
+#endif // LCD_DISPLAY_H_INCLUDED
@@ -0,0 +1,34 @@
+/**
+ * LED state table implementation.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Full tables are reported
+ */
+
+#include "LedTable.h"
+
+boolean LedTable::overflow = false;
+
+byte LedTable::add()
+{
+  byte idx = count;
+  if ( count < capacity )
+  {
+    count++;
+  }
+  else
+  {
+    idx = capacity - 1; // table full: share last entry
+    overflow = true;
+  }
+
+  // initialise entry
+  brightness[idx] = 0;
+  interval[idx]   = 0;
+  ratio[idx]      = 50;
+  onTime[idx]     = 0;
+  offTime[idx]    = 0;
+  state[idx]      = true;
+  return idx;
+}
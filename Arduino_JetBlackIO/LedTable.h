@@ -0,0 +1,103 @@
+/**
+ * Class declaration for the state tables of LEDs.
+ * The state of all LEDs of one type is stored in a structure of arrays
+ * so that the main loop can update each LED type in a tight loop without virtual calls.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Blinking keeps its phase and works across the millis() wraparound
+ * @version 1.2 - 2026.10.18: Full tables are reported (see overflow)
+ */
+
+#ifndef LED_TABLE_H_INCLUDED
+#define LED_TABLE_H_INCLUDED
+
+#include "Arduino.h"
+
+/**
+ * Common state of a group of LEDs of the same type.
+ * The table is a plain aggregate so that it is initialised statically,
+ * before any LED object constructor registers itself in it.
+ * Use DEFINE_LED_TABLE to create a table together with its arrays.
+ */
+struct LedTable
+{
+    /**
+     * Reserves the next free entry in the table and sets it to the default state.
+     * If the table is full, the last entry is shared and overflow is set.
+     *
+     * @return index of the entry
+     */
+    byte add();
+
+    /**
+     * Updates the blink state of an LED.
+     * The blink periods follow each other without gaps, so the blink phase does not drift
+     * with the loop timing. The times are compared by their difference, which works across
+     * the millis() wraparound after 49 days.
+     *
+     * @param idx  the index of the LED in the table
+     * @param time the current result of the millis() function
+     *
+     * @return <code>true</code> if the on/off state of the LED has changed,
+     *         <code>false</code> if not
+     */
+    inline boolean updateBlink(byte idx, unsigned long time)
+    {
+      if ( interval[idx] > 0 )
+      {
+        long late = (long) (time - onTime[idx]);
+        if ( late >= 0 )
+        {
+          // next period, or a new phase if the update is more than a period late
+          unsigned long start = (late < interval[idx]) ? onTime[idx] : time;
+          offTime[idx] = start + ((unsigned long) interval[idx] * ratio[idx] / 100);
+          onTime[idx]  = start + interval[idx];
+          state[idx]   = true;
+          return true;
+        }
+        else if ( state[idx] && ((long) (time - offTime[idx]) >= 0) )
+        {
+          state[idx] = false;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /**
+     * <code>true</code> if an LED did not get an entry or an output of its own,
+     * i.e., a table is too small for the LEDs of the sketch (checked in setup()).
+     */
+    static boolean overflow;
+
+    byte           count;
+    byte           capacity;
+    byte*          brightness;
+    unsigned int*  interval;
+    byte*          ratio;
+    boolean*       state;
+    unsigned long* onTime;
+    unsigned long* offTime;
+};
+
+
+/**
+ * Defines a static LED table with space for a fixed number of LEDs.
+ *
+ * @param name     the name of the table variable
+ * @param capacity the maximum number of LEDs in the table
+ */
+#define DEFINE_LED_TABLE(name, capacity) \
+  static byte          name##Brightness[capacity]; \
+  static unsigned int  name##Interval[capacity];   \
+  static byte          name##Ratio[capacity];      \
+  static boolean       name##State[capacity];      \
+  static unsigned long name##OnTime[capacity];     \
+  static unsigned long name##OffTime[capacity];    \
+  static LedTable      name = { 0, capacity,       \
+    name##Brightness, name##Interval, name##Ratio, \
+    name##State, name##OnTime, name##OffTime }
+
+
+#endif // LED_TABLE_H_INCLUDED
@@ -0,0 +1,94 @@
+
+using System;
+
+/// <summary>
+/// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+/// </summary>
+///
+public class LockFreeQueue<T>
+{
+	/// <summary>
+	/// Creates a new queue.
+	/// </summary>
+	/// <param name='capacity'>
+	/// the minimum number of items the queue can hold (rounded up to a power of two)
+	/// </param>
+	///
+	public LockFreeQueue(int capacity)
+	{
+		int size = 1;
+		while ( size < capacity ) size <<= 1;
+		items = new T[size];
+		mask  = size - 1;
+		head  = 0;
+		tail  = 0;
+	}
+
+
+	/// <summary>
+	/// Adds an item to the end of the queue.
+	/// Must only be called from the producer thread.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the item was added,
+	/// <code>false</code> if the queue is full
+	/// </returns>
+	/// <param name='item'>
+	/// the item to add
+	/// </param>
+	///
+	public bool Enqueue(T item)
+	{
+		int t = tail;
+		if ( t - head >= items.Length ) return false; // full
+		items[t & mask] = item;
+		tail = t + 1; // publish the item to the consumer
+		return true;
+	}
+
+
+	/// <summary>
+	/// Removes the item at the start of the queue.
+	/// Must only be called from the consumer thread.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if an item was removed,
+	/// <code>false</code> if the queue is empty
+	/// </returns>
+	/// <param name='item'>
+	/// receives the removed item
+	/// </param>
+	///
+	public bool TryDequeue(out T item)
+	{
+		int h = head;
+		if ( h == tail )
+		{
+			item = default(T);
+			return false; // empty
+		}
+		item = items[h & mask];
+		items[h & mask] = default(T); // don't keep references alive
+		head = h + 1; // release the slot to the producer
+		return true;
+	}
+
+
+	/// <summary>
+	/// Checks if the queue is empty.
+	/// </summary>
+	/// <returns>
+	/// <code>true</code> if the queue is empty, <code>false</code> if not
+	/// </returns>
+	///
+	public bool IsEmpty()
+	{
+		return head == tail;
+	}
+
+
+	private readonly T[]  items;
+	private readonly int  mask;
+	private volatile int  head; // next item to read  (only written by the consumer)
+	private volatile int  tail; // next slot to write (only written by the producer)
+}
@@ -0,0 +1,92 @@
+/**
+ * Class implementation for scrolling text regions on a LCD display.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Scrolling is shown straight away on displays with a back buffer
+ */
+
+#include "Marquee.h"
+
+
+Marquee::Marquee()
+{
+  pDisplay = NULL;
+  row      = 0;
+  col      = 0;
+  width    = 0;
+  interval = 0;
+  lastStep = 0;
+  length   = 0;
+  offset   = 0;
+}
+
+
+void Marquee::start(LcdDisplay* pDisplay, byte row, byte col, byte width, unsigned int interval, const char* text, byte length)
+{
+  this->pDisplay = pDisplay;
+  this->row      = row;
+  this->col      = col;
+  this->width    = width;
+  this->interval = interval;
+  this->length   = min(length, (byte) MARQUEE_LENGTH);
+  memcpy(this->text, text, this->length);
+  offset   = 0;
+  lastStep = millis();
+  draw();
+}
+
+
+void Marquee::stop()
+{
+  pDisplay = NULL;
+}
+
+
+LcdDisplay* Marquee::getDisplay()
+{
+  return pDisplay;
+}
+
+
+void Marquee::update(unsigned long time)
+{
+  if ( (pDisplay == NULL) || (length <= width) ) return;
+
+  if ( time - lastStep >= interval )
+  {
+    lastStep = time;
+    offset++;
+    if ( offset >= length + MARQUEE_GAP )
+    {
+      offset = 0;
+    }
+    draw();
+  }
+}
+
+
+void Marquee::draw()
+{
+  if ( length <= width )
+  {
+    // text fits: no scrolling, fill the rest of the region with spaces
+    for ( byte i = 0 ; i < width ; i++ )
+    {
+      pDisplay->showChar(row, col + i, (i < length) ? text[i] : ' ');
+    }
+    return;
+  }
+
+  // text followed by a gap, repeated
+  byte pos = offset;
+  for ( byte i = 0 ; i < width ; i++ )
+  {
+    pDisplay->showChar(row, col + i, (pos < length) ? text[pos] : ' ');
+    pos++;
+    if ( pos >= length + MARQUEE_GAP )
+    {
+      pos = 0;
+    }
+  }
+}
@@ -0,0 +1,84 @@
+/**
+ * Class declaration for scrolling text regions on a LCD display.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef MARQUEE_H_INCLUDED
+#define MARQUEE_H_INCLUDED
+
+#include "Arduino.h"
+#include "LcdDisplay.h"
+
+// maximum length of a scrolling text
+#define MARQUEE_LENGTH 40
+
+// number of spaces between the end and the start of the text while scrolling
+#define MARQUEE_GAP 3
+
+/**
+ * A region of a display row in which a text scrolls from right to left.
+ * The text is stored on the device, so the host only sends it once.
+ * Each step writes the visible part of the text into the frame buffer of the display,
+ * the display refresh then only writes the characters that have changed.
+ * Texts that fit into the region are shown without scrolling.
+ */
+class Marquee
+{
+  public:
+
+    /**
+     * Creates an inactive scrolling text region.
+     */
+    Marquee();
+
+    /**
+     * Starts scrolling a text.
+     *
+     * @param pDisplay the display to show the text on
+     * @param row      the row of the region
+     * @param col      the first column of the region
+     * @param width    the number of columns of the region
+     * @param interval the time in ms between two scroll steps
+     * @param text     the text (does not need to be null-terminated)
+     * @param length   the length of the text (longer texts are cut off at MARQUEE_LENGTH)
+     */
+    void start(LcdDisplay* pDisplay, byte row, byte col, byte width, unsigned int interval, const char* text, byte length);
+
+    /**
+     * Stops scrolling. The text stays on the display as it is.
+     */
+    void stop();
+
+    /**
+     * Gets the display that the text is shown on.
+     *
+     * @return the display or NULL if the region is not active
+     */
+    LcdDisplay* getDisplay();
+
+    /**
+     * Advances the text if the scroll interval has passed.
+     * This method needs to be called inside the main loop with the current millis() result.
+     *
+     * @param time the current result of the millis() function
+     */
+    void update(unsigned long time);
+
+  private:
+
+    void draw();
+
+    LcdDisplay*   pDisplay; // NULL: region not active
+    byte          row;
+    byte          col;
+    byte          width;
+    unsigned int  interval;
+    unsigned long lastStep; // time of the last scroll step in ms
+    char          text[MARQUEE_LENGTH];
+    byte          length;
+    byte          offset;   // position of the text at the left of the region
+};
+
+#endif // MARQUEE_H_INCLUDED
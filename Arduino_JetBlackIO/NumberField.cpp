@@ -0,0 +1,97 @@
+/**
+ * Class implementation for number fields on a LCD display.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Added getDisplay()
+ */
+
+#include "NumberField.h"
+
+
+NumberField::NumberField()
+{
+  pDisplay = NULL;
+  row      = 0;
+  col      = 0;
+  width    = 0;
+  decimals = 0;
+  flags    = 0;
+}
+
+
+void NumberField::define(LcdDisplay* pDisplay, byte row, byte col, byte width, byte decimals, byte flags)
+{
+  this->pDisplay = pDisplay;
+  this->row      = row;
+  this->col      = col;
+  this->width    = min(width, (byte) FIELD_MAX_WIDTH);
+  this->decimals = min(decimals, (byte) FIELD_MAX_DECIMALS);
+  this->flags    = flags;
+}
+
+
+void NumberField::remove()
+{
+  pDisplay = NULL;
+}
+
+
+boolean NumberField::isDefined()
+{
+  return pDisplay != NULL;
+}
+
+
+LcdDisplay* NumberField::getDisplay()
+{
+  return pDisplay;
+}
+
+
+void NumberField::show(unsigned long value)
+{
+  if ( pDisplay == NULL ) return;
+
+  // digits from right to left, at least one digit before the decimal point
+  char digits[FIELD_MAX_WIDTH + 1];
+  byte len   = 0;
+  byte count = 0;
+  do
+  {
+    if ( (decimals > 0) && (count == decimals) )
+    {
+      digits[len++] = '.';
+    }
+    digits[len++] = '0' + (value % 10);
+    value /= 10;
+    count++;
+  } while ( ((value > 0) || (count <= decimals)) && (len < FIELD_MAX_WIDTH) );
+
+  if ( (value > 0) || (len > width) )
+  {
+    // number does not fit
+    for ( byte i = 0 ; i < width ; i++ )
+    {
+      pDisplay->setChar(row, col + i, '#');
+    }
+    return;
+  }
+
+  if ( flags & FIELD_FLAG_LEFT )
+  {
+    for ( byte i = 0 ; i < width ; i++ )
+    {
+      pDisplay->setChar(row, col + i, (i < len) ? digits[len - 1 - i] : ' ');
+    }
+  }
+  else
+  {
+    char fill = (flags & FIELD_FLAG_ZEROS) ? '0' : ' ';
+    for ( byte i = 0 ; i < width ; i++ )
+    {
+      byte pos = width - 1 - i; // position from the right
+      pDisplay->setChar(row, col + i, (pos < len) ? digits[pos] : fill);
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/**
+ * Class declaration for number fields on a LCD display.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Added getDisplay()
+ */
+
+#ifndef NUMBER_FIELD_H_INCLUDED
+#define NUMBER_FIELD_H_INCLUDED
+
+#include "Arduino.h"
+#include "LcdDisplay.h"
+
+// maximum width of a number field (9 digits, decimal point and leading zero)
+#define FIELD_MAX_WIDTH 11
+
+// maximum number of decimal places
+#define FIELD_MAX_DECIMALS 4
+
+// field options
+#define FIELD_FLAG_ZEROS 0x01 // fill with leading zeros instead of spaces
+#define FIELD_FLAG_LEFT  0x02 // left aligned instead of right aligned
+
+/**
+ * A number field of a text template on a LCD display.
+ * The host only sends the raw number, the field formats it
+ * straight into the frame buffer of the display.
+ * Numbers are sent without a decimal point,
+ * e.g. 123 is shown as "1.23" in a field with 2 decimal places.
+ * Numbers that do not fit into the field are shown as "###".
+ */
+class NumberField
+{
+  public:
+
+    /**
+     * Creates an undefined field.
+     */
+    NumberField();
+
+    /**
+     * Defines the position and format of the field.
+     *
+     * @param pDisplay the display of the field
+     * @param row      the row of the field
+     * @param col      the first column of the field
+     * @param width    the number of columns of the field (1 - FIELD_MAX_WIDTH)
+     * @param decimals the number of decimal places (0 - FIELD_MAX_DECIMALS)
+     * @param flags    the options of the field (see FIELD_FLAG_...)
+     */
+    void define(LcdDisplay* pDisplay, byte row, byte col, byte width, byte decimals, byte flags);
+
+    /**
+     * Removes the definition of the field. The text on the display stays as it is.
+     */
+    void remove();
+
+    /**
+     * Checks if the field is defined.
+     *
+     * @return <code>true</code> if the field is defined,
+     *         <code>false</code> if not
+     */
+    boolean isDefined();
+
+    /**
+     * Gets the display of the field.
+     *
+     * @return the display or NULL if the field is not defined
+     */
+    LcdDisplay* getDisplay();
+
+    /**
+     * Writes a number into the field.
+     *
+     * @param value the number (including the decimal places)
+     */
+    void show(unsigned long value);
+
+  private:
+
+    LcdDisplay* pDisplay; // NULL: field not defined
+    byte        row;
+    byte        col;
+    byte        width;
+    byte        decimals;
+    byte        flags;
+};
+
+#endif // NUMBER_FIELD_H_INCLUDED
@@ -0,0 +1,220 @@
+/**
+ * Class implementation for screen pages stored in the EEPROM.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Changed bytes are written in the background
+ */
+
+#include "PageStore.h"
+#include <EEPROM.h>
+#include <avr/eeprom.h>
+
+// layout of a page in the EEPROM
+#define PAGE_LED_SIZE      8
+#define PAGE_OFS_DISPLAY   0  // display of the page, 0xFF: page not defined (erased EEPROM)
+#define PAGE_OFS_COLUMNS   1  // geometry of the page
+#define PAGE_OFS_ROWS      2
+#define PAGE_OFS_ROW_MASK  3  // one bit per row that has text
+#define PAGE_OFS_LED_COUNT 4  // number of LED states
+#define PAGE_OFS_LEDS      5  // LED states: LED, brightness, interval (low, high), ratio, red, green, blue
+#define PAGE_OFS_TEXT      (PAGE_OFS_LEDS + PAGE_MAX_LEDS * PAGE_LED_SIZE) // text, row by row
+
+#define PAGE_NOT_DEFINED   0xFF
+#define PAGE_NO_COLOUR     0xFF // red component of a LED state that does not change the colour
+
+#if PAGE_OFS_TEXT + LCD_MAX_CELLS > PAGE_SIZE
+#error A page does not fit into PAGE_SIZE bytes
+#endif
+
+
+PageStore::PageStore()
+{
+  queueCount = 0;
+}
+
+
+boolean PageStore::create(byte page, byte display, byte columns, byte rows)
+{
+  if ( page >= PAGE_COUNT ) return false;
+
+  write(page, PAGE_OFS_DISPLAY,   display);
+  write(page, PAGE_OFS_COLUMNS,   columns);
+  write(page, PAGE_OFS_ROWS,      rows);
+  write(page, PAGE_OFS_ROW_MASK,  0);
+  write(page, PAGE_OFS_LED_COUNT, 0);
+  return true;
+}
+
+
+boolean PageStore::setRow(byte page, byte row, const char* text, byte length)
+{
+  if ( !isDefined(page) || (row >= read(page, PAGE_OFS_ROWS)) ) return false;
+
+  byte columns = read(page, PAGE_OFS_COLUMNS);
+  byte offset  = PAGE_OFS_TEXT + row * columns;
+  for ( byte col = 0 ; col < columns ; col++ )
+  {
+    write(page, offset + col, (col < length) ? text[col] : ' ');
+  }
+  write(page, PAGE_OFS_ROW_MASK, read(page, PAGE_OFS_ROW_MASK) | (1 << row));
+  return true;
+}
+
+
+boolean PageStore::setLed(byte page, byte led, byte brightness, unsigned int interval, byte ratio, const byte* pColour)
+{
+  if ( !isDefined(page) ) return false;
+
+  // same LED: replace its state, otherwise append
+  byte count = read(page, PAGE_OFS_LED_COUNT);
+  byte idx   = 0;
+  while ( (idx < count) && (read(page, PAGE_OFS_LEDS + idx * PAGE_LED_SIZE) != led) )
+  {
+    idx++;
+  }
+  if ( idx >= PAGE_MAX_LEDS ) return false;
+
+  byte offset = PAGE_OFS_LEDS + idx * PAGE_LED_SIZE;
+  write(page, offset + 0, led);
+  write(page, offset + 1, brightness);
+  write(page, offset + 2, interval & 0xFF);
+  write(page, offset + 3, interval >> 8);
+  write(page, offset + 4, ratio);
+  write(page, offset + 5, (pColour != NULL) ? pColour[0] : PAGE_NO_COLOUR);
+  write(page, offset + 6, (pColour != NULL) ? pColour[1] : 0);
+  write(page, offset + 7, (pColour != NULL) ? pColour[2] : 0);
+  if ( idx == count )
+  {
+    write(page, PAGE_OFS_LED_COUNT, count + 1);
+  }
+  return true;
+}
+
+
+boolean PageStore::isDefined(byte page)
+{
+  return (page < PAGE_COUNT) && (read(page, PAGE_OFS_DISPLAY) != PAGE_NOT_DEFINED);
+}
+
+
+byte PageStore::getDisplay(byte page)
+{
+  return read(page, PAGE_OFS_DISPLAY);
+}
+
+
+void PageStore::showText(byte page, LcdDisplay* pDisplay)
+{
+  byte columns = read(page, PAGE_OFS_COLUMNS);
+  byte rows    = read(page, PAGE_OFS_ROWS);
+  byte rowMask = read(page, PAGE_OFS_ROW_MASK);
+  for ( byte row = 0 ; row < pDisplay->getRows() ; row++ )
+  {
+    boolean hasText = (row < rows) && (rowMask & (1 << row));
+    byte    offset  = PAGE_OFS_TEXT + row * columns;
+    for ( byte col = 0 ; col < pDisplay->getColumns() ; col++ )
+    {
+      // setChar() only marks characters that differ from the frame buffer
+      pDisplay->setChar(row, col, (hasText && (col < columns)) ? (char) read(page, offset + col) : ' ');
+    }
+  }
+}
+
+
+void PageStore::showLeds(byte page, LED* const* arrLEDs, byte ledCount)
+{
+  byte count = read(page, PAGE_OFS_LED_COUNT);
+  for ( byte idx = 0 ; (idx < count) && (idx < PAGE_MAX_LEDS) ; idx++ )
+  {
+    byte offset = PAGE_OFS_LEDS + idx * PAGE_LED_SIZE;
+    byte led    = read(page, offset);
+    LED* pLed   = (led < ledCount) ? arrLEDs[led] : NULL;
+    if ( pLed == NULL ) continue;
+
+    byte red = read(page, offset + 5);
+    if ( (red != PAGE_NO_COLOUR) && pLed->supportsColour() )
+    {
+      pLed->setColour(red, read(page, offset + 6), read(page, offset + 7));
+    }
+    pLed->setBrightness(read(page, offset + 1));
+    pLed->setBlinkInterval(read(page, offset + 2) | (read(page, offset + 3) << 8));
+    pLed->setBlinkRatio(read(page, offset + 4));
+  }
+}
+
+
+void PageStore::update()
+{
+  if ( (queueCount > 0) && eeprom_is_ready() )
+  {
+    programOldest();
+  }
+}
+
+
+boolean PageStore::isIdle()
+{
+  return (queueCount == 0) && eeprom_is_ready();
+}
+
+
+int PageStore::getAddress(byte page, byte offset)
+{
+  return page * PAGE_SIZE + offset;
+}
+
+
+byte PageStore::read(byte page, byte offset)
+{
+  // a queued byte is newer than the EEPROM
+  int address = getAddress(page, offset);
+  for ( byte idx = 0 ; idx < queueCount ; idx++ )
+  {
+    if ( queueAddress[idx] == address ) return queueValue[idx];
+  }
+  return EEPROM.read(address);
+}
+
+
+void PageStore::write(byte page, byte offset, byte value)
+{
+  // each write takes about 3.3ms and wears out the EEPROM: skip unchanged bytes
+  if ( read(page, offset) == value ) return;
+
+  // a byte that is already queued gets the new value
+  int address = getAddress(page, offset);
+  for ( byte idx = 0 ; idx < queueCount ; idx++ )
+  {
+    if ( queueAddress[idx] == address )
+    {
+      queueValue[idx] = value;
+      return;
+    }
+  }
+
+  // queue full: wait for the EEPROM
+  if ( queueCount >= PAGE_WRITE_QUEUE_SIZE )
+  {
+    programOldest();
+  }
+  queueAddress[queueCount] = address;
+  queueValue[queueCount]   = value;
+  queueCount++;
+}
+
+
+void PageStore::programOldest()
+{
+  // a byte that has been changed back does not need to be programmed
+  if ( EEPROM.read(queueAddress[0]) != queueValue[0] )
+  {
+    EEPROM.write(queueAddress[0], queueValue[0]);
+  }
+  queueCount--;
+  for ( byte idx = 0 ; idx < queueCount ; idx++ )
+  {
+    queueAddress[idx] = queueAddress[idx + 1];
+    queueValue[idx]   = queueValue[idx + 1];
+  }
+}
@@ -0,0 +1,148 @@
+/**
+ * Class declaration for screen pages stored in the EEPROM.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Changed bytes are written in the background
+ */
+
+#ifndef PAGE_STORE_H_INCLUDED
+#define PAGE_STORE_H_INCLUDED
+
+#include "Arduino.h"
+#include "LcdDisplay.h"
+#include "LED.h"
+
+// number of pages (each page uses PAGE_SIZE bytes of the EEPROM, starting at address 0)
+#define PAGE_COUNT 6
+#define PAGE_SIZE  128
+
+// maximum number of LED states of a page
+#define PAGE_MAX_LEDS 4
+
+// number of changed bytes that can wait for the EEPROM (3 bytes of RAM each)
+#define PAGE_WRITE_QUEUE_SIZE 24
+
+/**
+ * Screen pages with the text of a display and the states of some LEDs (e.g., the backlight).
+ * The pages are kept in the EEPROM, so they survive a reset.
+ * The host uploads them at the start of a session. Only bytes that differ are written,
+ * so uploading the same pages again is quick and does not wear out the EEPROM.
+ * Programming a changed byte takes about 3.3ms, so the changed bytes are queued
+ * and update() programs them one by one when the EEPROM is ready.
+ * Only when the queue is full, a write waits for the EEPROM.
+ * The sketch starts a page command only when the store is idle (see isIdle()),
+ * so the queue only fills up with rows of more than PAGE_WRITE_QUEUE_SIZE-1 characters.
+ * Queued bytes are read from the queue, they are lost if the module is reset before they are programmed.
+ */
+class PageStore
+{
+  public:
+
+    /**
+     * Creates the page store with an empty write queue.
+     */
+    PageStore();
+
+    /**
+     * Starts a page for a display: the page has the geometry of the display,
+     * all rows are empty and there are no LED states.
+     *
+     * @param page    the number of the page (0 - PAGE_COUNT-1)
+     * @param display the number of the display
+     * @param columns the number of columns of the display
+     * @param rows    the number of rows of the display
+     * @return <code>true</code> if the page has been started,
+     *         <code>false</code> if the page number is invalid
+     */
+    boolean create(byte page, byte display, byte columns, byte rows);
+
+    /**
+     * Sets the text of a row of a page. The rest of the row is filled with spaces.
+     *
+     * @param page   the number of the page
+     * @param row    the row
+     * @param text   the text (does not need to be terminated)
+     * @param length the number of characters of the text
+     * @return <code>true</code> if the row has been set,
+     *         <code>false</code> if the page is not defined or the row is not on the page
+     */
+    boolean setRow(byte page, byte row, const char* text, byte length);
+
+    /**
+     * Adds the state of a LED to a page. A LED that is already on the page gets the new state.
+     *
+     * @param page       the number of the page
+     * @param led        the number of the LED
+     * @param brightness the brightness (0-99)
+     * @param interval   the blink interval in ms (0: no blinking)
+     * @param ratio      the blink ratio (0-99)
+     * @param pColour    the red, green and blue components or NULL to keep the colour of the LED
+     * @return <code>true</code> if the LED state has been stored,
+     *         <code>false</code> if the page is not defined or has no space for another LED
+     */
+    boolean setLed(byte page, byte led, byte brightness, unsigned int interval, byte ratio, const byte* pColour);
+
+    /**
+     * Checks if a page is defined.
+     *
+     * @param page the number of the page
+     * @return <code>true</code> if the page is defined,
+     *         <code>false</code> if not
+     */
+    boolean isDefined(byte page);
+
+    /**
+     * Gets the display of a page.
+     *
+     * @param page the number of the page
+     * @return the number of the display given to create()
+     */
+    byte getDisplay(byte page);
+
+    /**
+     * Writes the text of a page into the frame buffer of a display.
+     * Only characters that differ from the frame buffer are marked as changed.
+     * Parts of the display that are not on the page are cleared.
+     *
+     * @param page     the number of the page
+     * @param pDisplay the display
+     */
+    void showText(byte page, LcdDisplay* pDisplay);
+
+    /**
+     * Sets the LEDs of a page. LEDs that do not exist are skipped.
+     *
+     * @param page     the number of the page
+     * @param arrLEDs  the LEDs of the module
+     * @param ledCount the number of entries of arrLEDs
+     */
+    void showLeds(byte page, LED* const* arrLEDs, byte ledCount);
+
+    /**
+     * Programs the next queued byte into the EEPROM, if the EEPROM is ready.
+     * Call this in each iteration of the main loop.
+     */
+    void update();
+
+    /**
+     * Checks if all changed bytes have been programmed into the EEPROM.
+     *
+     * @return <code>true</code> if the write queue is empty and the EEPROM is ready,
+     *         <code>false</code> if not
+     */
+    boolean isIdle();
+
+  private:
+
+    int  getAddress(byte page, byte offset);
+    byte read(byte page, byte offset);
+    void write(byte page, byte offset, byte value);
+    void programOldest();
+
+    int  queueAddress[PAGE_WRITE_QUEUE_SIZE]; // changed bytes, oldest first
+    byte queueValue[PAGE_WRITE_QUEUE_SIZE];
+    byte queueCount;
+};
+
+#endif // PAGE_STORE_H_INCLUDED
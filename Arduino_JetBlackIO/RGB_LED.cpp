@@ -3,19 +3,28 @@
  *
  * @author  Stefan Marks
  * @version 1.0 - 2012.11.23: Created
+ * @version 1.1 - 2026.10.18: State moved to the RGB LED table
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #include "RGB_LED.h"
 
-RGB_LED::RGB_LED(LED* pLEDred, LED* pLEDgreen, LED* pLEDblue) : LED()
+// state of all RGB LEDs
+DEFINE_LED_TABLE(rgbTable, RGB_LED_CAPACITY);
+static byte rgbRed[RGB_LED_CAPACITY];
+static byte rgbGreen[RGB_LED_CAPACITY];
+static byte rgbBlue[RGB_LED_CAPACITY];
+
+
+RGB_LED::RGB_LED(LED* pLEDred, LED* pLEDgreen, LED* pLEDblue) : LED(rgbTable)
 {
   this->pLEDred   = pLEDred;
   this->pLEDgreen = pLEDgreen;
   this->pLEDblue  = pLEDblue;
 
-  red   = 0;
-  green = 0;
-  blue  = 0;
+  rgbRed[idx]   = 0;
+  rgbGreen[idx] = 0;
+  rgbBlue[idx]  = 0;
   
   updateLedState();
 }
@@ -29,9 +38,9 @@ bool RGB_LED::supportsColour()
 
 void RGB_LED::setColour(byte red, byte green, byte blue)
 {
-  this->red   = constrain(red,   0, 99);
-  this->green = constrain(green, 0, 99);
-  this->blue  = constrain(blue,  0, 99);
+  rgbRed[idx]   = constrain(red,   0, 99);
+  rgbGreen[idx] = constrain(green, 0, 99);
+  rgbBlue[idx]  = constrain(blue,  0, 99);
   updateLedState();
 }
 
@@ -56,16 +65,16 @@ void RGB_LED::setBlinkRatio(byte ratio)
 }
 
 
-void RGB_LED::update(unsigned long /* time */)
+char RGB_LED::getType()
 {
-  // do nothing here, LED's are updated by themselves
+  return LED_TYPE_MULTICOLOUR;
 }
 
 
 void RGB_LED::updateLedState()
 {
-  if ( pLEDred   != NULL ) pLEDred->setBrightness(  (int) red   * brightness / 99);
-  if ( pLEDgreen != NULL ) pLEDgreen->setBrightness((int) green * brightness / 99);
-  if ( pLEDblue  != NULL ) pLEDblue->setBrightness( (int) blue  * brightness / 99);
+  byte brightness = rgbTable.brightness[idx];
+  if ( pLEDred   != NULL ) pLEDred->setBrightness(  (int) rgbRed[idx]   * brightness / 99);
+  if ( pLEDgreen != NULL ) pLEDgreen->setBrightness((int) rgbGreen[idx] * brightness / 99);
+  if ( pLEDblue  != NULL ) pLEDblue->setBrightness( (int) rgbBlue[idx]  * brightness / 99);
 }
-
@@ -3,6 +3,8 @@
  * 
  * @author  Stefan Marks
  * @version 1.0 - 2012.12.05: Created
+ * @version 1.1 - 2026.10.18: State moved to the RGB LED table, removed empty update()
+ * @version 1.2 - 2026.10.18: Added getType()
  */
  
 #ifndef RGB_LED_H_INCLUDED
@@ -10,6 +12,14 @@
 
 #include "LED.h"
 
+// maximum number of RGB LEDs
+#define RGB_LED_CAPACITY 2
+
+/**
+ * Multicolour LED composed of three LEDs.
+ * There is no updateAll() method for this type,
+ * the component LEDs are updated by their own type.
+ */
 class RGB_LED : public LED
 {
   public:
@@ -32,8 +42,8 @@ class RGB_LED : public LED
     virtual void setBlinkInterval(unsigned int interval);
     
     virtual void setBlinkRatio(byte ratio);
-    
-    virtual void update(unsigned long time);
+
+    virtual char getType();
 
   private:
   
@@ -44,9 +54,7 @@ class RGB_LED : public LED
     LED* pLEDred;
     LED* pLEDgreen;
     LED* pLEDblue;
-    byte red, green, blue;
 };
 
 
 #endif // RGB_LED_H_INCLUDED
-
@@ -0,0 +1,180 @@
+/**
+ * Software PWM LED class implementation.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Late interrupts no longer extend a time slot by a full timer round
+ * @version 1.2 - 2026.10.18: Timer 2 overflow interrupt, so pins 3 and 11 keep their hardware PWM
+ * @version 1.3 - 2026.10.18: Full port table is reported
+ */
+
+#include "SoftPwmLED.h"
+#include <avr/interrupt.h>
+
+// number of BAM time slots (bits of the brightness), the shortest slot is one timer overflow (128us)
+#define SOFT_PWM_SLOTS 5
+// brightness with all slots on
+#define SOFT_PWM_MAX   ((1 << SOFT_PWM_SLOTS) - 1)
+
+// state of all software PWM LEDs
+DEFINE_LED_TABLE(softPwmTable, SOFT_PWM_LED_CAPACITY);
+static byte softPwmDuty[SOFT_PWM_LED_CAPACITY]; // current brightness 0-SOFT_PWM_MAX including blinking
+static byte softPwmPort[SOFT_PWM_LED_CAPACITY]; // index in pwmPorts
+static byte softPwmMask[SOFT_PWM_LED_CAPACITY]; // bit of the pin in its port
+
+// output ports with software PWM LEDs
+static volatile uint8_t* pwmPorts[SOFT_PWM_PORT_CAPACITY];
+static byte              pwmPortMask[SOFT_PWM_PORT_CAPACITY]; // all software PWM pins of the port
+static byte              pwmPortCount = 0;
+
+// port values of each time slot, double buffered:
+// the interrupt shows one set, the main loop prepares the other one
+static byte             bamMasks[2][SOFT_PWM_SLOTS][SOFT_PWM_PORT_CAPACITY];
+static volatile byte    bamActive  = 0;     // set shown by the interrupt
+static volatile byte    bamSlot    = 0;     // next time slot
+static volatile byte    bamTicks   = 1;     // timer overflows until the next time slot
+static volatile boolean bamPending = false; // true: other set is ready, switch at the start of the next period
+static boolean          bamChanged = false; // true: a brightness has changed since the last preparation
+
+
+/**
+ * Timer 2 overflow interrupt (every 128us): starts the next BAM time slot when the current one has ended.
+ * The overflows come at fixed times, so a late interrupt only shortens the current slot a little
+ * and the latency does not add up.
+ */
+ISR(TIMER2_OVF_vect)
+{
+  if ( --bamTicks != 0 ) return;
+
+  byte slot = bamSlot;
+  if ( (slot == 0) && bamPending )
+  {
+    bamActive ^= 1;
+    bamPending = false;
+  }
+  const byte* masks = bamMasks[bamActive][slot];
+  for ( byte p = 0 ; p < pwmPortCount ; p++ )
+  {
+    *pwmPorts[p] = (*pwmPorts[p] & ~pwmPortMask[p]) | masks[p];
+  }
+  bamTicks = 1 << slot;
+  bamSlot  = (slot + 1 < SOFT_PWM_SLOTS) ? slot + 1 : 0;
+}
+
+
+/**
+ * Sets the brightness of a software PWM LED that the interrupt shows from the next period on.
+ *
+ * @param idx the index of the LED in the table
+ */
+static inline void writeSoftPwmOutput(byte idx)
+{
+  // rounded up, so that the lowest brightness values are not off
+  softPwmDuty[idx] = softPwmTable.state[idx] ? ((int) softPwmTable.brightness[idx] * SOFT_PWM_MAX + 98) / 99 : 0;
+  bamChanged = true;
+}
+
+
+/**
+ * Calculates the port values of all time slots from the brightness of the LEDs
+ * into the set that is not shown by the interrupt.
+ */
+static void prepareSlots()
+{
+  byte (*masks)[SOFT_PWM_PORT_CAPACITY] = bamMasks[bamActive ^ 1];
+  for ( byte slot = 0 ; slot < SOFT_PWM_SLOTS ; slot++ )
+  {
+    for ( byte p = 0 ; p < pwmPortCount ; p++ )
+    {
+      masks[slot][p] = 0;
+    }
+  }
+  for ( byte i = 0 ; i < softPwmTable.count ; i++ )
+  {
+    byte duty = softPwmDuty[i];
+    for ( byte slot = 0 ; duty != 0 ; slot++, duty >>= 1 )
+    {
+      if ( duty & 1 )
+      {
+        masks[slot][softPwmPort[i]] |= softPwmMask[i];
+      }
+    }
+  }
+  bamPending = true;
+}
+
+
+SoftPwmLED::SoftPwmLED(byte pinNo) : LED(softPwmTable)
+{
+  // find the port of the pin, or add it
+  volatile uint8_t* port = portOutputRegister(digitalPinToPort(pinNo));
+  byte p = 0;
+  while ( (p < pwmPortCount) && (pwmPorts[p] != port) )
+  {
+    p++;
+  }
+  if ( p == pwmPortCount )
+  {
+    if ( pwmPortCount < SOFT_PWM_PORT_CAPACITY ) pwmPortCount++;
+    else
+    {
+      // no space: replaces the pins of the last port
+      p = pwmPortCount - 1;
+      LedTable::overflow = true;
+    }
+    pwmPorts[p]    = port;
+    pwmPortMask[p] = 0;
+  }
+  softPwmPort[idx] = p;
+  softPwmMask[idx] = digitalPinToBitMask(pinNo);
+  pwmPortMask[p]  |= softPwmMask[idx];
+
+  // prepare pin to output signal
+  digitalWrite(pinNo, LOW);
+  pinMode(pinNo, OUTPUT);
+
+  updateLedState();
+}
+
+
+void SoftPwmLED::begin()
+{
+  // timer 2 in fast PWM mode at 16MHz/8: overflow every 128us, 7.8kHz hardware PWM on pins 3 and 11.
+  // analogWrite() only sets the compare registers and outputs, so it keeps working on these pins
+  cli();
+  TCCR2A |= _BV(WGM21) | _BV(WGM20);
+  TCCR2B  = _BV(CS21);
+  TIMSK2  = _BV(TOIE2);
+  sei();
+}
+
+
+void SoftPwmLED::updateAll(unsigned long time)
+{
+  for ( byte i = 0 ; i < softPwmTable.count ; i++ )
+  {
+    if ( softPwmTable.updateBlink(i, time) )
+    {
+      writeSoftPwmOutput(i);
+    }
+  }
+
+  // the interrupt switches to a new set only at the start of a period (31 overflows, about 4ms)
+  if ( bamChanged && !bamPending )
+  {
+    prepareSlots();
+    bamChanged = false;
+  }
+}
+
+
+char SoftPwmLED::getType()
+{
+  return LED_TYPE_ANALOG; // dimmable like an analog LED
+}
+
+
+void SoftPwmLED::updateLedState()
+{
+  writeSoftPwmOutput(idx);
+}
@@ -0,0 +1,72 @@
+/**
+ * Class declaration for dimmable LEDs on any digital pin of the board,
+ * driven by a timer interrupt with bit angle modulation.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Capacity 8
+ * @version 1.2 - 2026.10.18: Timer 2 overflow interrupt, pins 3 and 11 keep their hardware PWM
+ */
+
+#ifndef SOFT_PWM_LED_H_INCLUDED
+#define SOFT_PWM_LED_H_INCLUDED
+
+#include "LED.h"
+
+// maximum number of software PWM LEDs (each one uses 16 bytes of RAM).
+// Enough for the free pins of an Arduino Uno without hardware PWM, more LEDs can be added with ExpanderLED
+#define SOFT_PWM_LED_CAPACITY 8
+
+// maximum number of I/O ports with software PWM LEDs (ATmega328: B, C, D)
+#define SOFT_PWM_PORT_CAPACITY 3
+
+/**
+ * Dimmable LED on a pin without hardware PWM.
+ * The overflow interrupt of timer 2 is used for bit angle modulation (BAM) of all software PWM LEDs:
+ * a 5 bit brightness (32 steps) is shown as 5 time slots of 1, 2, 4, 8 and 16 timer overflows (128us each),
+ * the LED is on during the slots of the bits that are set.
+ * Only 5 of the 31 interrupts per period change the outputs, independent of the number of LEDs.
+ * The period is about 4ms (252Hz), so there is no visible flicker.
+ * The interrupt writes precomputed masks to the output ports,
+ * the masks are computed in the main loop by updateAll() when a brightness changes.
+ * Timer 2 runs faster afterwards: the hardware PWM of pins 3 and 11 (analogWrite()) keeps working at 7.8kHz,
+ * but tone() is not available.
+ */
+class SoftPwmLED : public LED
+{
+  public:
+
+    /**
+     * Creates a software PWM LED class for a specific I/O pin.
+     *
+     * @param pinNo the number of the Arduino pin to use for this LED
+     */
+    SoftPwmLED(byte pinNo);
+
+    /**
+     * Starts the timer interrupt. This needs to be called in setup(),
+     * because the Arduino initialisation changes the timer settings after the constructors have run.
+     */
+    static void begin();
+
+    /**
+     * Updates all software PWM LEDs.
+     * This method needs to be called inside the main loop with the current millis() result
+     * to allow for time-controlled events and control to function properly.
+     *
+     * @param time the current result of the millis() function
+     */
+    static void updateAll(unsigned long time);
+
+  // overridden methods
+
+    virtual char getType();
+
+  private:
+
+    virtual void updateLedState();
+
+};
+
+
+#endif // SOFT_PWM_LED_H_INCLUDED
@@ -0,0 +1,72 @@
+/**
+ * Check of the LCD back buffer in the emulator (G with back buffer parameter, X command):
+ * text stays off the display until X, and X only sends the cells that differ from the display.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+
+static int lastWrites = 0;
+
+
+/**
+ * Prints what the LCD shows and how many characters have been written since the last call.
+ */
+static void show(const char* what)
+{
+  printf("%-22s [%s] [%s] %d characters sent\n", what,
+         lcdRow(0, 0, 16).c_str(), lcdRow(0, 1, 16).c_str(), lcdWrites(0) - lastWrites);
+  lastWrites = lcdWrites(0);
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+  lastWrites = lcdWrites(0);
+
+  printf("G16,2,0,1 : %s", command("G16,2,0,1", 500).c_str());
+  show("back buffer on");
+
+  command("P0,0");
+  command("T\"Speed\"");
+  command("P1,0");
+  command("T\"12 km/h\"", 300);
+  show("text before X");
+  command("X", 300);
+  show("after X");
+
+  // three rewrites of the same cell: one character
+  command("P1,0");
+  command("T\"99 km/h\"");
+  command("P1,0");
+  command("T\"13 km/h\"");
+  command("P1,0");
+  command("T\"14 km/h\"");
+  command("X", 300);
+  show("3 rewrites + X");
+
+  // changed and changed back: nothing
+  command("P1,0");
+  command("T\"99\"");
+  command("P1,0");
+  command("T\"14\"");
+  command("X", 300);
+  show("changed back + X");
+
+  command("C", 300);
+  show("C before X");
+  command("X", 300);
+  show("C after X");
+
+  // back to direct output
+  printf("G16,2,0,0 : %s", command("G16,2,0,0", 500).c_str());
+  lastWrites = lcdWrites(0);
+  command("T\"direct\"", 300);
+  show("without back buffer");
+  return 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * Check of the command order in the emulator: big numbers (N) are queued and executed in the main loop,
+ * LCD commands that follow them must not overtake them.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+
+/**
+ * Sends commands in one go, like the host does when it has a batch of changes.
+ */
+static void send(const char* commands)
+{
+  serialOut.clear();
+  for ( const char* c = commands ; *c != '\0' ; c++ )
+  {
+    serialIn.push_back((*c == '|') ? '\n' : *c);
+  }
+  serialIn.push_back('\n');
+  run(500);
+}
+
+
+/**
+ * Prints the answers and what the LCD shows.
+ */
+static void show(const char* what)
+{
+  std::string answers;
+  for ( std::string::size_type i = 0 ; i < serialOut.size() ; i++ )
+  {
+    if ( serialOut[i] != '\r' ) answers += (serialOut[i] == '\n') ? ' ' : serialOut[i];
+  }
+  // custom characters (big number segments) are shown as #
+  std::string rows[2];
+  for ( int row = 0 ; row < 2 ; row++ )
+  {
+    rows[row] = lcdRow(0, row, 16);
+    for ( int i = 0 ; i < 16 ; i++ )
+    {
+      if ( (unsigned char) rows[row][i] < 8 ) rows[row][i] = '#';
+    }
+  }
+  printf("%-20s answers %-8s LCD [%s] [%s]\n", what, answers.c_str(), rows[0].c_str(), rows[1].c_str());
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+
+  send("N12|C");
+  show("N12, C");
+  send("N34|P0,0|T\"AB\"");
+  show("N34, P0,0, T\"AB\"");
+  send("N56|G16,2");
+  show("N56, G16,2");
+  return 0;
+}
@@ -0,0 +1,85 @@
+/**
+ * Display benchmark in the emulator, like ArduinoIO_TraceReplay.RunDisplayBenchmark():
+ * time until the LCD shows a full screen of new text and a change of two characters,
+ * for several display geometries.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+
+/**
+ * Gets a value of a comma separated answer.
+ */
+static int getValue(const std::string& answer, int index)
+{
+  size_t pos = 0;
+  for ( int i = 0 ; i < index ; i++ )
+  {
+    pos = answer.find(',', pos) + 1;
+  }
+  return atoi(answer.c_str() + pos);
+}
+
+
+/**
+ * Polls the statistics until no characters are waiting for the LCD refresh.
+ *
+ * @return the time in ms
+ */
+static double waitForLcd()
+{
+  unsigned long long start = emuMicros;
+  while ( getValue(command("S", 2), 3) != 0 ) {}
+  return (emuMicros - start) / 1000.0;
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1000);
+
+  const int geometries[][2] = { { 16, 2 }, { 20, 4 }, { 40, 2 } };
+  for ( int g = 0 ; g < 3 ; g++ )
+  {
+    int  columns = geometries[g][0];
+    int  rows    = geometries[g][1];
+    char cmd[64];
+    sprintf(cmd, "G%d,%d", columns, rows);
+    if ( command(cmd) != "+\r\n" )
+    {
+      printf("%dx%d : not supported\n", columns, rows);
+      continue;
+    }
+    run(500);
+
+    // full screen
+    unsigned long long start = emuMicros;
+    for ( int row = 0 ; row < rows ; row++ )
+    {
+      std::string text = "T\"";
+      for ( int col = 0 ; col < columns ; col++ )
+      {
+        text += (char) ('A' + (row * 7 + col) % 26);
+      }
+      sprintf(cmd, "P%d,0", row);
+      command(cmd, 0);
+      command(text + "\"", 0);
+    }
+    waitForLcd();
+    double fullTime = (emuMicros - start) / 1000.0;
+
+    // small change
+    start = emuMicros;
+    command("P0,3", 0);
+    command("T\"xy\"", 0);
+    waitForLcd();
+    double smallTime = (emuMicros - start) / 1000.0;
+
+    printf("%dx%d : full screen %.1f ms, 2 characters %.1f ms\n", columns, rows, fullTime, smallTime);
+  }
+  return 0;
+}
@@ -0,0 +1,356 @@
+/**
+ * Desktop emulator for the JetBlack IO firmware, see Emulator.h.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Time of the last change of each pin
+ * @version 1.2 - 2026.10.18: EEPROM write time
+ * @version 1.3 - 2026.10.18: Pin access counters
+ * @version 1.4 - 2026.10.18: Compiles without warnings
+ */
+
+#include "Emulator.h"
+#include "Wire.h"
+#include "EEPROM.h"
+#include "avr/eeprom.h"
+
+unsigned long long emuMicros = 0;
+std::deque<char>   serialIn;
+std::string        serialOut;
+unsigned long      serialBaud = 0;
+std::map<int, int> pinValues;
+std::map<int, unsigned long long> pinTimes;
+int                i2cTransactions = 0;
+long               pinReads  = 0;
+long               pinWrites = 0;
+
+
+/********************************************************************************
+ * Time and pins
+ ********************************************************************************/
+
+unsigned long millis()                { return (unsigned long) (emuMicros / 1000); }
+unsigned long micros()                { return (unsigned long) emuMicros; }
+void delay(unsigned long ms)          { emuMicros += ms * 1000ULL; }
+void delayMicroseconds(unsigned int us) { emuMicros += us; }
+
+static std::map<int, int> pinModes;
+void pinMode(uint8_t pin, uint8_t mode)       { pinModes[pin] = mode; }
+int  digitalRead(uint8_t pin)                 { pinReads++; return pinValues[pin]; }
+void digitalWrite(uint8_t pin, uint8_t value) { analogWrite(pin, value); }
+
+void analogWrite(uint8_t pin, int value)
+{
+  pinWrites++;
+  if ( pinValues[pin] != value ) pinTimes[pin] = emuMicros;
+  pinValues[pin] = value;
+}
+
+static volatile uint8_t ports[8];
+uint8_t digitalPinToPort(uint8_t pin)    { return 1 + pin / 8; }
+uint8_t digitalPinToBitMask(uint8_t pin) { return 1 << (pin % 8); }
+uint8_t digitalPinToTimer(uint8_t pin)   { return ((pin == 3) || (pin == 5) || (pin == 6) || (pin == 9) || (pin == 10) || (pin == 11)) ? 1 : 0; }
+volatile uint8_t* portOutputRegister(uint8_t port) { return &ports[port]; }
+
+void noInterrupts() {}
+void interrupts()   {}
+
+volatile uint8_t TCCR2A, TCCR2B, TIMSK2, OCR2A, TCNT2;
+
+// free RAM measurement (see build.sh)
+uint8_t  emuHeapStart[4096];
+uint8_t* emuBrkval = NULL;
+
+
+/********************************************************************************
+ * Print and Serial
+ ********************************************************************************/
+
+static size_t printNumber(Print* p, unsigned long value, int base)
+{
+  char   digits[40];
+  size_t count = 0;
+  do
+  {
+    int d = value % base;
+    digits[count++] = (d < 10) ? ('0' + d) : ('A' + d - 10);
+    value /= base;
+  } while ( value != 0 );
+  for ( size_t i = count ; i > 0 ; i-- )
+  {
+    p->write((uint8_t) digits[i - 1]);
+  }
+  return count;
+}
+
+size_t Print::write(const char* str)
+{
+  size_t n = 0;
+  while ( *str != '\0' ) n += write((uint8_t) *str++);
+  return n;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size)
+{
+  for ( size_t i = 0 ; i < size ; i++ ) write(buffer[i]);
+  return size;
+}
+
+size_t Print::print(const char* str)                 { return write(str); }
+size_t Print::print(char c)                          { return write((uint8_t) c); }
+size_t Print::print(long value, int base)            { return (value < 0) ? write('-') + printNumber(this, -value, base) : printNumber(this, value, base); }
+size_t Print::print(int value, int base)             { return print((long) value, base); }
+size_t Print::print(unsigned long value, int base)   { return printNumber(this, value, base); }
+size_t Print::print(unsigned int value, int base)    { return printNumber(this, value, base); }
+size_t Print::print(unsigned char value, int base)   { return printNumber(this, value, base); }
+size_t Print::print(const __FlashStringHelper* str)  { return print((const char*) str); }
+size_t Print::println()                              { return write("\r\n"); }
+size_t Print::println(const char* str)               { return print(str) + println(); }
+size_t Print::println(char c)                        { return print(c) + println(); }
+size_t Print::println(int value, int base)           { return print(value, base) + println(); }
+size_t Print::println(unsigned int value, int base)  { return print(value, base) + println(); }
+size_t Print::println(long value, int base)          { return print(value, base) + println(); }
+size_t Print::println(unsigned long value, int base) { return print(value, base) + println(); }
+size_t Print::println(unsigned char value, int base) { return print(value, base) + println(); }
+size_t Print::println(const __FlashStringHelper* str) { return print(str) + println(); }
+
+void   HardwareSerial::begin(unsigned long baud) { serialBaud = baud; }
+void   HardwareSerial::end()                     {}
+int    HardwareSerial::available()               { return serialIn.size(); }
+int    HardwareSerial::peek()                    { return serialIn.empty() ? -1 : (uint8_t) serialIn.front(); }
+void   HardwareSerial::flush()                   {}
+size_t HardwareSerial::write(uint8_t c)          { serialOut += (char) c; return 1; }
+
+int HardwareSerial::read()
+{
+  if ( serialIn.empty() ) return -1;
+  char c = serialIn.front();
+  serialIn.pop_front();
+  return (uint8_t) c;
+}
+
+HardwareSerial Serial;
+
+
+/********************************************************************************
+ * EEPROM
+ ********************************************************************************/
+
+static uint8_t eepromData[1024];
+static unsigned long long eepromReadyTime = 0; // end of the last write
+
+// like the AVR: each access waits until the last write has finished
+static void eepromWait()
+{
+  if ( emuMicros < eepromReadyTime ) emuMicros = eepromReadyTime;
+}
+
+uint8_t EEPROMClass::read(int addr)
+{
+  eepromWait();
+  return eepromData[addr];
+}
+
+void EEPROMClass::write(int addr, uint8_t value)
+{
+  eepromWait();
+  eepromData[addr] = value;
+  eepromReadyTime  = emuMicros + EMU_EEPROM_WRITE_TIME;
+}
+
+void EEPROMClass::update(int addr, uint8_t value)
+{
+  if ( read(addr) != value ) write(addr, value);
+}
+
+int eeprom_is_ready()
+{
+  return emuMicros >= eepromReadyTime;
+}
+
+EEPROMClass EEPROM;
+
+
+/********************************************************************************
+ * HD44780 LCD in 4 bit mode, MCP23017 and I2C bus
+ ********************************************************************************/
+
+/**
+ * HD44780 controller: display memory and address counter.
+ */
+struct Lcd
+{
+  char    ddram[128];
+  uint8_t address;
+  bool    cgram;       // true: address counter is in the custom character memory
+  bool    initialised; // true: 4 bit mode has been selected
+  bool    lowNibble;   // true: the next nibble is the low half of a byte
+  uint8_t highNibble;
+  int     writes;      // number of characters written
+
+  Lcd() : address(0), cgram(false), initialised(false), lowNibble(false), highNibble(0), writes(0)
+  {
+    memset(ddram, ' ', sizeof(ddram));
+  }
+
+  void nibble(uint8_t value, bool rs)
+  {
+    if ( !initialised )
+    {
+      // initialisation sequence 3, 3, 3, 2 in 8 bit mode selects the 4 bit mode
+      if ( value == 2 ) initialised = true;
+      return;
+    }
+    if ( !lowNibble )
+    {
+      highNibble = value;
+      lowNibble  = true;
+      return;
+    }
+    lowNibble = false;
+    byteIn((highNibble << 4) | value, rs);
+  }
+
+  void byteIn(uint8_t value, bool rs)
+  {
+    if ( rs )
+    {
+      if ( cgram ) return;
+      ddram[address & 127] = value;
+      address = (address + 1) & 127;
+      writes++;
+    }
+    else if ( value & 0x80 ) { address = value & 0x7F; cgram = false; } // set DDRAM address
+    else if ( value & 0x40 ) { cgram = true; }                          // set CGRAM address
+    else if ( value == 0x01 ) { memset(ddram, ' ', sizeof(ddram)); address = 0; } // clear
+  }
+
+  std::string row(int r, int width)
+  {
+    int base = (r == 0) ? 0 : (r == 1) ? 0x40 : (r == 2) ? width : 0x40 + width;
+    std::string s;
+    for ( int i = 0 ; i < width ; i++ ) s += ddram[(base + i) & 127];
+    return s;
+  }
+};
+
+
+/**
+ * MCP23017 with the LCD and the backlight of the Adafruit RGB LCD shield
+ * (GPA6-GPB0: backlight red, green, blue, active low; GPB1-GPB7: LCD).
+ */
+struct Mcp
+{
+  uint8_t  reg[32];
+  uint8_t  pointer;
+  uint16_t previous; // output pins before the last write
+  Lcd      lcd;
+
+  Mcp() : pointer(0), previous(0)
+  {
+    memset(reg, 0, sizeof(reg));
+    reg[0] = reg[1] = 0xFF; // all pins are inputs after power up
+  }
+
+  void write(uint8_t r, uint8_t value)
+  {
+    r &= 31;
+    // GPIO and OLAT are treated as the same register
+    if ( (r == 0x12) || (r == 0x14) )      { reg[0x12] = reg[0x14] = value; outputsChanged(); }
+    else if ( (r == 0x13) || (r == 0x15) ) { reg[0x13] = reg[0x15] = value; outputsChanged(); }
+    else reg[r] = value;
+  }
+
+  void outputsChanged()
+  {
+    uint16_t pins = reg[0x12] | (reg[0x13] << 8);
+    // falling edge of the enable pin: the LCD reads a nibble
+    if ( (previous & (1 << 13)) && !(pins & (1 << 13)) )
+    {
+      uint8_t value = ((pins >> 12) & 1) | (((pins >> 11) & 1) << 1) | (((pins >> 10) & 1) << 2) | (((pins >> 9) & 1) << 3);
+      lcd.nibble(value, pins & (1 << 15));
+    }
+    previous = pins;
+  }
+
+  int backlight()
+  {
+    uint16_t pins = reg[0x12] | (reg[0x13] << 8);
+    return (((pins >> 6) & 1) ? 0 : 4) | (((pins >> 7) & 1) ? 0 : 2) | (((pins >> 8) & 1) ? 0 : 1);
+  }
+};
+
+static std::map<int, Mcp>  chips; // key: 7 bit I2C address
+static int                 txAddress;
+static bool                txFirst; // true: next byte is the register pointer
+static std::deque<uint8_t> rxBytes;
+
+void TwoWire::begin()                          {}
+void TwoWire::setClock(unsigned long)          {}
+void TwoWire::beginTransmission(uint8_t addr)  { txAddress = addr; txFirst = true; }
+int  TwoWire::available()                      { return rxBytes.size(); }
+
+size_t TwoWire::write(uint8_t value)
+{
+  std::map<int, Mcp>::iterator it = chips.find(txAddress);
+  if ( it == chips.end() ) return 1;
+  if ( txFirst )
+  {
+    it->second.pointer = value;
+    txFirst = false;
+  }
+  else
+  {
+    it->second.write(it->second.pointer++, value);
+  }
+  return 1;
+}
+
+uint8_t TwoWire::endTransmission()
+{
+  i2cTransactions++;
+  emuMicros += EMU_I2C_TRANSFER_TIME;
+  return chips.count(txAddress) ? 0 : 2; // 2: no acknowledge of the address
+}
+
+uint8_t TwoWire::requestFrom(uint8_t addr, uint8_t count)
+{
+  i2cTransactions++;
+  emuMicros += EMU_I2C_TRANSFER_TIME;
+  std::map<int, Mcp>::iterator it = chips.find(addr);
+  if ( it == chips.end() ) return 0;
+  for ( int i = 0 ; i < count ; i++ )
+  {
+    rxBytes.push_back(it->second.reg[it->second.pointer++ & 31]);
+  }
+  return count;
+}
+
+uint8_t TwoWire::requestFrom(int addr, int count)
+{
+  return requestFrom((uint8_t) addr, (uint8_t) count);
+}
+
+int TwoWire::read()
+{
+  if ( rxBytes.empty() ) return -1;
+  int value = rxBytes.front();
+  rxBytes.pop_front();
+  return value;
+}
+
+TwoWire Wire;
+
+
+/********************************************************************************
+ * Access for the test programs
+ ********************************************************************************/
+
+// MCP23017 base address (see Adafruit_MCP23017.h)
+#define MCP_BASE 0x20
+
+void        addLcdShield(int addr)                    { chips[MCP_BASE | addr]; }
+std::string lcdRow(int addr, int row, int width)      { return chips[MCP_BASE | addr].lcd.row(row, width); }
+int         lcdBacklight(int addr)                    { return chips[MCP_BASE | addr].backlight(); }
+int         lcdWrites(int addr)                       { return chips[MCP_BASE | addr].lcd.writes; }
+int         mcpRegister(int addr, int reg)            { return chips[MCP_BASE | addr].reg[reg & 31]; }
@@ -0,0 +1,121 @@
+/**
+ * Desktop emulator for the JetBlack IO firmware.
+ * The sketch is compiled together with this emulator and a test program (see build.sh).
+ * Time only advances when the test program says so, or when the firmware waits or accesses the I2C bus or the EEPROM,
+ * so the results do not depend on the speed of the desktop computer.
+ * The emulated hardware: serial port, digital pins, EEPROM and MCP23017 port expanders
+ * with the HD44780 LCD and the RGB backlight of the Adafruit RGB LCD shield.
+ * Interrupts are not emulated (the software PWM LEDs do not change their pins).
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Time of the last change of each pin
+ * @version 1.2 - 2026.10.18: EEPROM write time
+ * @version 1.3 - 2026.10.18: Pin access counters
+ */
+
+#ifndef EMULATOR_H_INCLUDED
+#define EMULATOR_H_INCLUDED
+
+#include <string>
+#include <deque>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "Arduino.h"
+
+// time in us that one I2C transfer takes (about 4 bytes at 100kHz)
+#define EMU_I2C_TRANSFER_TIME 200
+// time in us that one iteration of the main loop takes without I/O
+#define EMU_LOOP_TIME 20
+// time in us that the EEPROM needs to program one byte (the next access waits for it)
+#define EMU_EEPROM_WRITE_TIME 3300
+
+// state of the emulation
+extern unsigned long long emuMicros;       // current time in us (does not wrap around)
+extern std::deque<char>   serialIn;        // bytes sent by the host, not read by the firmware yet
+extern std::string        serialOut;       // bytes sent by the firmware
+extern unsigned long      serialBaud;      // current serial speed
+extern std::map<int, int> pinValues;       // last value written to each digital pin
+extern std::map<int, unsigned long long> pinTimes; // time in us of the last change of each digital pin
+extern int                i2cTransactions; // number of I2C transfers since the start
+extern long               pinReads;        // number of digitalRead() calls since the start
+extern long               pinWrites;       // number of digitalWrite() and analogWrite() calls since the start
+
+// functions of the sketch
+void setup();
+void loop();
+void serialEvent();
+
+/**
+ * Connects an LCD shield to the I2C bus.
+ *
+ * @param addr the address of the MCP23017 of the shield (0-7)
+ */
+void addLcdShield(int addr);
+
+/**
+ * Gets the text that an LCD shows in a row.
+ *
+ * @param addr  the address of the shield (0-7)
+ * @param row   the row (0-3)
+ * @param width the number of columns of the display
+ *
+ * @return the characters of the row
+ */
+std::string lcdRow(int addr, int row, int width);
+
+/**
+ * Gets the colour of the backlight of an LCD shield.
+ *
+ * @return bit 0: blue, bit 1: green, bit 2: red
+ */
+int lcdBacklight(int addr);
+
+/**
+ * Gets the number of characters that have been written to an LCD.
+ */
+int lcdWrites(int addr);
+
+/**
+ * Gets the value of a register of an MCP23017 (e.g., 0x12: GPIOA, 0x13: GPIOB).
+ */
+int mcpRegister(int addr, int reg);
+
+
+/**
+ * Runs the main loop of the firmware for some time, feeding received bytes to serialEvent().
+ *
+ * @param ms the time to run in ms
+ */
+inline void run(unsigned long ms)
+{
+  unsigned long long end = emuMicros + ms * 1000ULL;
+  do
+  {
+    loop();
+    if ( !serialIn.empty() ) serialEvent();
+    emuMicros += EMU_LOOP_TIME;
+  } while ( emuMicros < end );
+}
+
+
+/**
+ * Sends a command to the firmware and runs the main loop for some time.
+ *
+ * @param command the command without the line terminator
+ * @param ms      the time to run in ms
+ *
+ * @return everything the firmware has sent in that time
+ */
+inline std::string command(const std::string& command, unsigned long ms = 5)
+{
+  serialOut.clear();
+  serialIn.insert(serialIn.end(), command.begin(), command.end());
+  serialIn.push_back('\n');
+  run(ms);
+  return serialOut;
+}
+
+#endif // EMULATOR_H_INCLUDED
@@ -0,0 +1,80 @@
+/**
+ * Expander LED check in the emulator: an LED on a spare MCP23017 pin (LED 13)
+ * and the backlight of the same LCD shield blink together for one second.
+ * The changes of both are written by the shadow word flush, so the number of I2C transfers
+ * should be about the number of changes, and the LCD text must not be affected.
+ * Then LED 13 is dimmed to several brightness values and its average on time is measured.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Dimmed expander LED
+ */
+
+#include "Emulator.h"
+
+// GPIOA register of the MCP23017 and the pin of LED 13 (GPA5)
+#define GPIOA    0x12
+#define LED13    0x20
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+
+  printf("L13,99     : %s", command("L13,99").c_str());
+  printf("  pin      : %s\n", (mcpRegister(0, GPIOA) & LED13) ? "on" : "off");
+  printf("L13,0      : %s", command("L13,0").c_str());
+  printf("  pin      : %s\n", (mcpRegister(0, GPIOA) & LED13) ? "on" : "off");
+
+  // blink the LED and the backlight with 100 ms interval
+  command("L13,99,100,50");
+  command("M9,99,99,0,100,50");
+  int transfers = i2cTransactions;
+  int ledChanges = 0, backlightChanges = 0;
+  int led = mcpRegister(0, GPIOA) & LED13;
+  int backlight = lcdBacklight(0);
+  for ( int ms = 0 ; ms < 1000 ; ms++ )
+  {
+    run(1);
+    if ( (mcpRegister(0, GPIOA) & LED13) != led ) { led ^= LED13; ledChanges++; }
+    if ( lcdBacklight(0) != backlight ) { backlight = lcdBacklight(0); backlightChanges++; }
+  }
+  printf("1 s blinking: %d LED changes, %d backlight changes, %d I2C transfers\n",
+         ledChanges, backlightChanges, i2cTransactions - transfers);
+
+  command("L13,0");
+  command("M9,99,99,99");
+
+  // dimmed without blinking: average on time and the number of switch-ons in one second
+  const int levels[] = { 1, 10, 25, 50, 75, 99 };
+  for ( int l = 0 ; l < 6 ; l++ )
+  {
+    char cmd[16];
+    sprintf(cmd, "L13,%d,0", levels[l]);
+    command(cmd, 100);
+    unsigned long long start = emuMicros, onTime = 0;
+    int switchOns = 0;
+    transfers = i2cTransactions;
+    led = mcpRegister(0, GPIOA) & LED13;
+    while ( emuMicros < start + 1000000 )
+    {
+      unsigned long long before = emuMicros;
+      run(0);
+      if ( led ) onTime += emuMicros - before;
+      if ( (mcpRegister(0, GPIOA) & LED13) != led )
+      {
+        led ^= LED13;
+        if ( led ) switchOns++;
+      }
+    }
+    printf("L13,%-2d : on %5.1f%%, %4d switch-ons/s, %5d I2C transfers/s\n",
+           levels[l], onTime * 100.0 / (emuMicros - start), switchOns, i2cTransactions - transfers);
+  }
+  command("L13,0");
+  command("C");
+  command("T\"Hello\"");
+  run(300);
+  printf("LCD text   : [%s]\n", lcdRow(0, 0, 16).c_str());
+  return 0;
+}
@@ -0,0 +1,65 @@
+/**
+ * LED and button update benchmark in the emulator: the main loop runs for one second
+ * with all LEDs off and then with all LEDs blinking, without serial traffic.
+ * The emulator does not know how long the firmware takes on the ATmega,
+ * so the benchmark counts the pin accesses and I2C transfers of the loop
+ * and measures the time of loop() on the desktop computer (only comparable between builds on the same computer).
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+#include <ctime>
+
+// loop iterations in one second
+#define LOOPS (1000000 / EMU_LOOP_TIME)
+// repetitions of the desktop time measurement
+#define REPEAT 20
+
+
+/**
+ * Runs the main loop for one emulated second and prints the counters.
+ *
+ * @param title the name of the measurement
+ */
+static void measure(const char* title)
+{
+  long reads     = pinReads;
+  long writes    = pinWrites;
+  int  transfers = i2cTransactions;
+  run(1000);
+  printf("%-8s: %6ld pin reads, %5ld pin writes, %4d I2C transfers per second",
+         title, pinReads - reads, pinWrites - writes, i2cTransactions - transfers);
+
+  // desktop time, emulated time still advances
+  clock_t start = clock();
+  for ( int r = 0 ; r < REPEAT ; r++ )
+  {
+    for ( int i = 0 ; i < LOOPS ; i++ )
+    {
+      loop();
+      emuMicros += EMU_LOOP_TIME;
+    }
+  }
+  printf(", %.0f ns per loop() on the desktop\n",
+         (clock() - start) * 1e9 / CLOCKS_PER_SEC / ((double) REPEAT * LOOPS));
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+
+  measure("off");
+  for ( int led = 0 ; led < 9 ; led++ )
+  {
+    char cmd[32];
+    sprintf(cmd, "L%d,99,500,50", led);
+    command(cmd);
+  }
+  measure("blinking");
+  return 0;
+}
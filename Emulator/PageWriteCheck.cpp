@@ -0,0 +1,86 @@
+/**
+ * Check of the screen page upload in the emulator: the host uploads four 16x2 pages
+ * (U, W and K commands, like ArduinoIO_Module, each command waits for the reply of the last one),
+ * the first time into an empty EEPROM and then the same pages again. Each changed byte takes 3.3ms to program.
+ * The longest iteration of the main loop shows how long the firmware stops
+ * updating LEDs, buttons and the LCD during the upload.
+ * Finally, a page is shown and compared with the uploaded text.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+
+static const char* PAGES[][2] =
+{
+  { "Speed: 0000 km/h", "       0.00 mach" },
+  { "Thrust E1: 000% ", "       E2: 000% " },
+  { "Fuel E1: 000%   ", "     E2: 000%   " },
+  { "!!!! ABORT !!!! ", "!!!! ABORT !!!! " },
+};
+
+
+/**
+ * Sends a command like the host: the next command is sent when the reply has arrived.
+ *
+ * @param cmd     the command without the line terminator
+ * @param longest the longest iteration of the main loop in us so far
+ * @return <code>true</code> if the command has been acknowledged
+ */
+static bool send(const char* cmd, unsigned long long& longest)
+{
+  serialOut.clear();
+  serialIn.insert(serialIn.end(), cmd, cmd + strlen(cmd));
+  serialIn.push_back('\n');
+  while ( serialOut.find('\n') == std::string::npos )
+  {
+    unsigned long long start = emuMicros;
+    loop();
+    if ( !serialIn.empty() ) serialEvent();
+    emuMicros += EMU_LOOP_TIME;
+    if ( emuMicros - start > longest ) longest = emuMicros - start;
+  }
+  return serialOut[0] == '+';
+}
+
+
+static void upload(const char* title)
+{
+  unsigned long long start   = emuMicros;
+  unsigned long long longest = 0;
+  int acks = 0;
+  for ( int page = 0 ; page < 4 ; page++ )
+  {
+    char cmd[64];
+    sprintf(cmd, "U%d", page);
+    if ( send(cmd, longest) ) acks++;
+    for ( int row = 0 ; row < 2 ; row++ )
+    {
+      sprintf(cmd, "W%d,%d,\"%s\"", page, row, PAGES[page][row]);
+      if ( send(cmd, longest) ) acks++;
+    }
+    sprintf(cmd, "K%d,9,99,%d,50", page, (page == 3) ? 500 : 0);
+    if ( send(cmd, longest) ) acks++;
+  }
+  unsigned long long uploaded = emuMicros;
+  // the EEPROM writes that are still queued
+  run(2000);
+  printf("%s: %d of 16 commands acknowledged after %.1f ms, longest loop %.2f ms\n",
+         title, acks, (uploaded - start) / 1000.0, longest / 1000.0);
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+
+  upload("first upload ");
+  upload("second upload");
+
+  command("D1", 200);
+  printf("page 1       : \"%s\" \"%s\"\n", lcdRow(0, 0, 16).c_str(), lcdRow(0, 1, 16).c_str());
+  return 0;
+}
@@ -0,0 +1,86 @@
+/**
+ * Check of the scheduled commands in the emulator: how late commands with an @<micros> prefix
+ * are executed, whether they are executed in time order, and whether pending LCD text delays them.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Scheduled commands that can not be queued
+ */
+
+#include "Emulator.h"
+
+// pin of LED 1 (see LedTable.cpp)
+#define LED1_PIN  5
+
+
+/**
+ * Sends a scheduled command.
+ *
+ * @param time    the time of execution (micros() of the firmware)
+ * @param command the command
+ *
+ * @return the answer of the firmware
+ */
+static std::string schedule(unsigned long time, const char* cmd)
+{
+  char text[64];
+  sprintf(text, "@%lu%s", time, cmd);
+  std::string answer = command(text, 0);
+  printf("%-24s -> %s", text, answer.c_str());
+  return answer;
+}
+
+
+/**
+ * Runs the main loop until LED 1 changes.
+ *
+ * @param timeout the maximum time to wait in us
+ *
+ * @return the time of the change (micros() of the firmware when the pin was written)
+ */
+static unsigned long waitForLed(unsigned long timeout)
+{
+  int value = pinValues[LED1_PIN];
+  unsigned long long end = emuMicros + timeout;
+  while ( (pinValues[LED1_PIN] == value) && (emuMicros < end) )
+  {
+    run(0);
+  }
+  return (unsigned long) pinTimes[LED1_PIN];
+}
+
+
+int main()
+{
+  addLcdShield(0);
+  setup();
+  run(1500);
+
+  // out of order: the later command is sent first
+  unsigned long base = micros() + 20000;
+  schedule(base + 10000, "L1,0");
+  schedule(base, "L1,99");
+  printf("not deferrable:          -> %s", command("@123E", 0).c_str());
+  printf("Q: %s", command("Q", 0).c_str());
+  unsigned long on  = waitForLed(50000);
+  unsigned long off = waitForLed(50000);
+  printf("L1,99 executed %ld us late, L1,0 executed %ld us late\n", (long) (on - base), (long) (off - (base + 10000)));
+
+  // while the LCD has a lot of text to write
+  base = micros() + 20000;
+  schedule(base, "L1,99");
+  command("P0,0", 0);
+  command("T\"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdef\"", 0);
+  on = waitForLed(100000);
+  printf("L1,99 executed %ld us late, LCD text still pending: %s\n", (long) (on - base),
+         (lcdRow(0, 1, 16) != "QRSTUVWXYZabcdef") ? "yes" : "no");
+  run(500);
+  printf("LCD text: [%s] [%s]\n", lcdRow(0, 0, 16).c_str(), lcdRow(0, 1, 16).c_str());
+  printf("Q: %s", command("Q", 0).c_str());
+
+  // text of a command that can not be scheduled must not reach the LCD
+  command("P0,0", 0);
+  printf("not deferrable:          -> %s", command("@5T\"xyz\"", 300).c_str());
+  printf("LCD text: [%s] [%s]\n", lcdRow(0, 0, 16).c_str(), lcdRow(0, 1, 16).c_str());
+  return 0;
+}
@@ -0,0 +1,88 @@
+/**
+ * Check of the software PWM interrupt in the emulator.
+ * The emulator has no interrupts, so this program runs timer 2 itself (16MHz/8: overflow every 128us)
+ * and calls the overflow interrupt handler, and the main loop every ms.
+ * Some interrupts are delayed, like behind a serial or I2C interrupt.
+ * LED 8 (pin 13) is dimmed to 1%, so it is only on during the 128us of BAM slot 0 in each 4ms period.
+ * A late interrupt must not keep the LED on for much longer (a visible flash).
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ * @version 1.1 - 2026.10.18: Overflow interrupt
+ */
+
+#include "Emulator.h"
+
+extern "C" void TIMER2_OVF_vect(void);
+
+// time of one simulation step in us
+#define STEP_TIME     8
+// timer overflow every 128us
+#define OVERFLOW_STEPS 16
+
+
+/**
+ * Runs timer 2 for one second.
+ *
+ * @param lateEvery every n-th interrupt is delayed (0: none)
+ * @param lateSteps the delay in simulation steps
+ */
+static void runTimer(int lateEvery, int lateSteps)
+{
+  volatile uint8_t* port = portOutputRegister(digitalPinToPort(13));
+  uint8_t           mask = digitalPinToBitMask(13);
+
+  bool pending      = false;
+  int  pendingSince = 0;
+  int  interrupts   = 0;
+  int  onSteps      = 0;
+  int  onPhase      = 0;
+  int  longestOn    = 0;
+  for ( int step = 0 ; step < 1000000 / STEP_TIME ; step++ )
+  {
+    // overflow flag, a second overflow while the flag is set is lost
+    if ( step % OVERFLOW_STEPS == 0 )
+    {
+      if ( !pending ) pendingSince = step;
+      pending = true;
+    }
+    int latency = ((lateEvery > 0) && (interrupts % lateEvery == lateEvery - 1)) ? lateSteps : 0;
+    if ( pending && (step - pendingSince >= latency) )
+    {
+      pending = false;
+      interrupts++;
+      TIMER2_OVF_vect();
+    }
+
+    // the main loop prepares the BAM slots
+    if ( step % 125 == 0 ) loop();
+
+    if ( *port & mask )
+    {
+      onSteps++;
+      onPhase++;
+      if ( onPhase > longestOn ) longestOn = onPhase;
+    }
+    else
+    {
+      onPhase = 0;
+    }
+  }
+  printf("every %2d. interrupt %3d us late: %d interrupts, on %.2f%%, longest on phase %d us\n",
+         lateEvery, lateSteps * STEP_TIME, interrupts, onSteps * 100.0 / (1000000 / STEP_TIME), longestOn * STEP_TIME);
+}
+
+
+int main()
+{
+  setup();
+  run(100);
+  command("L8,1,0");
+
+  runTimer(0, 0);
+  runTimer(13, 3);
+  runTimer(13, 5);
+  runTimer(5, 10);
+  runTimer(7, 20);
+  return 0;
+}
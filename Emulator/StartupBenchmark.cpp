@@ -0,0 +1,42 @@
+/**
+ * Startup benchmark in the emulator: time from power on until the host gets the answer
+ * to its first command, with 1 to 4 LCD shields.
+ * The host sends E right after power on and waits for the answer.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#include "Emulator.h"
+
+int main(int argc, char** argv)
+{
+  int displays = (argc > 1) ? atoi(argv[1]) : 1;
+  for ( int i = 0 ; i < displays ; i++ )
+  {
+    addLcdShield(i);
+  }
+
+  setup();
+  double setupTime = emuMicros / 1000.0;
+
+  serialIn.push_back('E');
+  serialIn.push_back('\n');
+  while ( serialOut.find('\n') == std::string::npos )
+  {
+    loop();
+    if ( !serialIn.empty() ) serialEvent();
+    emuMicros += EMU_LOOP_TIME;
+  }
+  printf("%d display(s): setup() %.1f ms, first answer after %.1f ms: %s",
+         displays, setupTime, emuMicros / 1000.0, serialOut.c_str());
+
+  // the LCDs show the start text once their initialisation and the custom characters
+  // have been sent in the main loop (the displays take turns, so this takes longer with more displays)
+  run(2000);
+  for ( int i = 0 ; i < displays ; i++ )
+  {
+    printf("  LCD %d: [%s] [%s]\n", i, lcdRow(i, 0, 16).c_str(), lcdRow(i, 1, 16).c_str());
+  }
+  return 0;
+}
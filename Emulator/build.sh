@@ -0,0 +1,43 @@
+#!/bin/bash
+#
+# Builds the desktop emulator with the firmware and a test program, and runs it.
+# Usage: Emulator/build.sh <test program> [arguments]
+# e.g.   Emulator/build.sh Emulator/DisplayBenchmark.cpp
+#
+# Needs g++ and python3. The build goes into Emulator/build (not part of the repository).
+#
+# @author  Stefan Marks
+# @version 1.0 - 2026.10.18: Created
+# @version 1.1 - 2026.10.18: Build with all warnings
+
+set -e
+EMU=$(cd "$(dirname "$0")" && pwd)
+SKETCH=$EMU/../Arduino_JetBlackIO
+OUT=$EMU/build
+TEST=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+shift
+mkdir -p "$OUT"
+
+# like the Arduino IDE: the sketch becomes a C++ file with prototypes for all its functions
+python3 - "$SKETCH/Arduino_JetBlackIO.ino" "$OUT/sketch.cpp" <<'PY'
+import re, sys
+src = open(sys.argv[1]).read()
+protos = []
+for m in re.finditer(r'^([A-Za-z_][\w\*<> ]*?[\w\*]+)\s+(\w+)\s*\(([^)]*)\)\s*\n?\s*\{', src, re.M):
+    ret, name, args = m.groups()
+    if name in ('if', 'while', 'for', 'switch') or ret.strip() in ('else', 'return'):
+        continue
+    protos.append('%s %s(%s);' % (ret, name, re.sub(r'\s*=\s*[^,]+', '', args)))
+pos = [m.end() for m in re.finditer(r'^#include.*$', src, re.M)][-1]
+# the RAM painting loops run from the static data to the stack, which are far apart on a desktop computer
+src = src.replace('while ( p < &stackTop - 16 )', 'while ( false && (p < &stackTop - 16) )')
+src = src.replace('while ( (p < &stackTop) &&', 'while ( false && (p < &stackTop) &&')
+open(sys.argv[2], 'w').write('#include "Arduino.h"\n' + src[:pos] + '\n' + '\n'.join(protos) + '\n' + src[pos:])
+PY
+
+g++ -std=gnu++11 -O1 -Wall -Wextra -DARDUINO=105 \
+    -D__heap_start=emuHeapStart[0] -D__brkval=emuBrkval \
+    -I"$EMU/include" -I"$EMU" -I"$SKETCH" \
+    -o "$OUT/emulator" "$EMU/Emulator.cpp" "$SKETCH"/*.cpp "$OUT/sketch.cpp" "$TEST"
+
+"$OUT/emulator" "$@"
@@ -0,0 +1,83 @@
+/**
+ * Minimal Arduino core API for compiling the firmware on a desktop computer.
+ * Only what the JetBlack IO sketch uses is declared, the functions are implemented in Emulator.cpp.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef ARDUINO_H_INCLUDED
+#define ARDUINO_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include "avr/pgmspace.h"
+#include "avr/io.h"
+#include "avr/interrupt.h"
+
+typedef uint8_t  byte;
+typedef bool     boolean;
+typedef uint16_t word;
+
+#define HIGH         1
+#define LOW          0
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+#define NOT_A_PORT   0
+#define NOT_A_PIN    0
+#define NOT_ON_TIMER 0
+#define F_CPU        16000000UL
+
+#define B00000 0
+#define B00111 7
+#define B01111 15
+#define B11100 28
+#define B11110 30
+#define B11111 31
+
+#define _BV(x)             (1 << (x))
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+#define min(a, b)          ((a) < (b) ? (a) : (b))
+#define max(a, b)          ((a) > (b) ? (a) : (b))
+#define bitRead(v, b)      (((v) >> (b)) & 1)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int  digitalRead(uint8_t pin);
+void analogWrite(uint8_t pin, int value);
+uint8_t digitalPinToPort(uint8_t pin);
+uint8_t digitalPinToBitMask(uint8_t pin);
+uint8_t digitalPinToTimer(uint8_t pin);
+volatile uint8_t* portOutputRegister(uint8_t port);
+
+void noInterrupts();
+void interrupts();
+
+#include "Print.h"
+
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper*) (s))
+
+class HardwareSerial : public Print
+{
+  public:
+    void begin(unsigned long baud);
+    void end();
+    int  available();
+    int  read();
+    int  peek();
+    void flush();
+    virtual size_t write(uint8_t c);
+};
+
+extern HardwareSerial Serial;
+
+#endif // ARDUINO_H_INCLUDED
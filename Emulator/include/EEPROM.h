@@ -0,0 +1,23 @@
+/**
+ * Minimal EEPROM library of the Arduino core, see Arduino.h.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef EEPROM_H_INCLUDED
+#define EEPROM_H_INCLUDED
+
+#include <stdint.h>
+
+class EEPROMClass
+{
+  public:
+    uint8_t read(int addr);
+    void    write(int addr, uint8_t value);
+    void    update(int addr, uint8_t value);
+};
+
+extern EEPROMClass EEPROM;
+
+#endif // EEPROM_H_INCLUDED
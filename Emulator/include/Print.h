@@ -0,0 +1,46 @@
+/**
+ * Minimal Print class of the Arduino core, see Arduino.h.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef PRINT_H_INCLUDED
+#define PRINT_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+
+class __FlashStringHelper;
+
+#define DEC 10
+#define HEX 16
+
+class Print
+{
+  public:
+    virtual size_t write(uint8_t c) = 0;
+    size_t write(const char* str);
+    size_t write(const uint8_t* buffer, size_t size);
+
+    size_t print(const char* str);
+    size_t print(char c);
+    size_t print(int value, int base = DEC);
+    size_t print(unsigned int value, int base = DEC);
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(unsigned char value, int base = DEC);
+    size_t print(const __FlashStringHelper* str);
+
+    size_t println();
+    size_t println(const char* str);
+    size_t println(char c);
+    size_t println(int value, int base = DEC);
+    size_t println(unsigned int value, int base = DEC);
+    size_t println(long value, int base = DEC);
+    size_t println(unsigned long value, int base = DEC);
+    size_t println(unsigned char value, int base = DEC);
+    size_t println(const __FlashStringHelper* str);
+};
+
+#endif // PRINT_H_INCLUDED
@@ -0,0 +1,31 @@
+/**
+ * Minimal I2C library of the Arduino core, see Arduino.h.
+ * The emulator connects it to the emulated MCP23017 chips.
+ *
+ * @author  Stefan Marks
+ * @version 1.0 - 2026.10.18: Created
+ */
+
+#ifndef WIRE_H_INCLUDED
+#define WIRE_H_INCLUDED
+
+#include <stdint.h>
+#include <stddef.h>
+
+class TwoWire
+{
+  public:
+    void    begin();
+    void    setClock(unsigned long clock);
+    void    beginTransmission(uint8_t addr);
+    uint8_t endTransmission();
+    uint8_t requestFrom(uint8_t addr, uint8_t count);
+    uint8_t requestFrom(int addr, int count);
+    size_t  write(uint8_t value);
+    int     read();
+    int     available();
+};
+
+extern TwoWire Wire;
+
+#endif // WIRE_H_INCLUDED
@@ -0,0 +1,8 @@
+// EEPROM functions of the AVR library that the sketch uses, see Emulator.cpp
+#ifndef AVR_EEPROM_H_INCLUDED
+#define AVR_EEPROM_H_INCLUDED
+
+// nonzero if the EEPROM can be accessed without waiting for a write to finish
+int eeprom_is_ready();
+
+#endif // AVR_EEPROM_H_INCLUDED
@@ -0,0 +1,9 @@
+// interrupts do not exist in the emulator: interrupt handlers are compiled, but never called
+#ifndef AVR_INTERRUPT_H_INCLUDED
+#define AVR_INTERRUPT_H_INCLUDED
+
+#define ISR(vector) extern "C" void vector(void)
+#define cli()
+#define sei()
+
+#endif // AVR_INTERRUPT_H_INCLUDED
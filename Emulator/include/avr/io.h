@@ -0,0 +1,17 @@
+// registers that the firmware accesses directly (plain variables in the emulator)
+#ifndef AVR_IO_H_INCLUDED
+#define AVR_IO_H_INCLUDED
+
+#include <stdint.h>
+
+extern volatile uint8_t TCCR2A, TCCR2B, TIMSK2, OCR2A, TCNT2;
+
+#define CS20   0
+#define CS21   1
+#define CS22   2
+#define OCIE2A 1
+#define TOIE2  0
+#define WGM20  0
+#define WGM21  1
+
+#endif // AVR_IO_H_INCLUDED
@@ -0,0 +1,25 @@
+// flash memory is ordinary memory in the emulator
+#ifndef AVR_PGMSPACE_H_INCLUDED
+#define AVR_PGMSPACE_H_INCLUDED
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PSTR(s)            (s)
+#define pgm_read_byte(a)   emuReadFlash<uint8_t>(a)
+#define pgm_read_word(a)   emuReadFlash<uint16_t>(a)
+#define pgm_read_dword(a)  emuReadFlash<uint32_t>(a)
+#define pgm_read_ptr(a)    emuReadFlash<void*>(a)
+#define strlen_P           strlen
+#define memcpy_P           memcpy
+
+// copies instead of casting the pointer, e.g., pgm_read_dword() of a long (strict aliasing)
+template <typename T> inline T emuReadFlash(const void* address)
+{
+  T value;
+  memcpy(&value, address, sizeof(value));
+  return value;
+}
+
+#endif // AVR_PGMSPACE_H_INCLUDED